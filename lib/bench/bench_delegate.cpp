@@ -0,0 +1,72 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "catch.hpp"
+#include "delegate.hpp"
+#include "inplace_delegate.hpp"
+#include <array>
+#include <cstdint>
+#include <functional>
+
+namespace
+{
+    struct MultiplyAdd
+    {
+        std::uint32_t operator()(std::uint32_t x) const { return a * b + x; }
+
+        std::uint32_t a;
+        std::uint32_t b;
+    };
+
+    constexpr std::size_t delegateCount = 64;
+}
+
+TEST_CASE("Delegate call benchmarks")
+{
+    // Calls go through arrays of delegates, so that they are not inlined.
+    // Delegate refers to function objects that have to be stored elsewhere.
+    std::array<MultiplyAdd, delegateCount> functionObjects;
+    for (std::size_t i = 0; i < delegateCount; ++i)
+    {
+        functionObjects[i] = MultiplyAdd{static_cast<std::uint32_t>(i), 2};
+    }
+
+    std::array<std::function<std::uint32_t(std::uint32_t)>, delegateCount> stdFunctions;
+    std::array<Delegate<std::uint32_t(std::uint32_t)>, delegateCount> delegates;
+    std::array<InplaceDelegate<std::uint32_t(std::uint32_t), 16>, delegateCount> inplaceDelegates;
+
+    for (std::size_t i = 0; i < delegateCount; ++i)
+    {
+        stdFunctions[i] = functionObjects[i];
+        delegates[i] = {&functionObjects[i]};
+        inplaceDelegates[i] = functionObjects[i];
+    }
+
+    BENCHMARK("std::function")
+    {
+        std::uint32_t sum = 0;
+        for (std::uint32_t i = 0; i < delegateCount; ++i)
+        {
+            sum += stdFunctions[i](i);
+        }
+        return sum;
+    };
+
+    BENCHMARK("Delegate (state stored elsewhere)")
+    {
+        std::uint32_t sum = 0;
+        for (std::uint32_t i = 0; i < delegateCount; ++i)
+        {
+            sum += delegates[i](i);
+        }
+        return sum;
+    };
+
+    BENCHMARK("InplaceDelegate (state stored in place)")
+    {
+        std::uint32_t sum = 0;
+        for (std::uint32_t i = 0; i < delegateCount; ++i)
+        {
+            sum += inplaceDelegates[i](i);
+        }
+        return sum;
+    };
+}
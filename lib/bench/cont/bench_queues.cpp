@@ -0,0 +1,94 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "catch.hpp"
+#include "cont/circular_queue.hpp"
+#include "cont/spsc_queue.hpp"
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace
+{
+    // Bytes moved through the queue per benchmark run, in chunks
+    // that would e.g. be received by a UART
+    constexpr std::uint32_t bytesPerRun = 4096;
+    constexpr std::uint32_t chunkSize = 64;
+}
+
+TEST_CASE("Byte queue throughput benchmarks")
+{
+    std::uint8_t input[chunkSize];
+    std::uint8_t output[chunkSize];
+    for (std::uint32_t i = 0; i < chunkSize; ++i)
+    {
+        input[i] = static_cast<std::uint8_t>(i);
+    }
+
+    BENCHMARK("CircularQueue, push/pop")
+    {
+        auto queue = std::make_unique<cont::CircularQueue<std::uint8_t, 256>>();
+        std::uint32_t checksum = 0;
+        for (std::uint32_t i = 0; i < bytesPerRun; i += chunkSize)
+        {
+            for (auto value : input)
+            {
+                queue->push(value);
+            }
+            for (auto & value : output)
+            {
+                queue->pop(value);
+                checksum += value;
+            }
+        }
+        return checksum;
+    };
+
+    BENCHMARK("SpscQueue, push/pop")
+    {
+        auto queue = std::make_unique<cont::SpscQueue<std::uint8_t, 256>>();
+        std::uint32_t checksum = 0;
+        for (std::uint32_t i = 0; i < bytesPerRun; i += chunkSize)
+        {
+            for (auto value : input)
+            {
+                queue->push(value);
+            }
+            for (auto & value : output)
+            {
+                queue->pop(value);
+                checksum += value;
+            }
+        }
+        return checksum;
+    };
+
+    BENCHMARK("SpscQueue, pushN/popN")
+    {
+        auto queue = std::make_unique<cont::SpscQueue<std::uint8_t, 256>>();
+        std::uint32_t checksum = 0;
+        for (std::uint32_t i = 0; i < bytesPerRun; i += chunkSize)
+        {
+            queue->pushN(input, chunkSize);
+            queue->popN(output, chunkSize);
+            checksum += output[chunkSize - 1];
+        }
+        return checksum;
+    };
+
+    BENCHMARK("SpscQueue, acquireWrite/acquireRead")
+    {
+        auto queue = std::make_unique<cont::SpscQueue<std::uint8_t, 256>>();
+        std::uint32_t checksum = 0;
+        for (std::uint32_t i = 0; i < bytesPerRun; i += chunkSize)
+        {
+            // Stands in for a DMA transfer into the queue
+            auto writeRegion = queue->acquireWrite();
+            std::memcpy(writeRegion.data(), input, chunkSize);
+            queue->commitWrite(chunkSize);
+
+            auto readRegion = queue->acquireRead();
+            checksum += readRegion[chunkSize - 1];
+            queue->release(chunkSize);
+        }
+        return checksum;
+    };
+}
@@ -0,0 +1,50 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "catch.hpp"
+#include "drivers/adc/decimator.hpp"
+#include <array>
+#include <cstdint>
+#include <span>
+
+namespace
+{
+    // Samples decimated per benchmark run, divide the time of a run by
+    // this (and multiply by the clock) for the cost per sample
+    constexpr std::uint32_t samplesPerRun = 65536;
+    constexpr std::uint8_t channels = 4;
+    constexpr std::uint16_t ratio = 16;
+
+    template<class Decimator>
+    std::uint32_t decimate(Decimator & decimator, const std::array<std::uint16_t, channels * ratio> & frame)
+    {
+        std::uint32_t checksum = 0;
+        for (std::uint32_t i = 0; i < samplesPerRun; i += frame.size())
+        {
+            for (auto value : decimator(std::span<const std::uint16_t, channels * ratio>(frame)))
+            {
+                checksum += value;
+            }
+        }
+        return checksum;
+    }
+}
+
+TEST_CASE("ADC decimation benchmarks")
+{
+    std::array<std::uint16_t, channels * ratio> frame;
+    for (std::size_t i = 0; i < frame.size(); ++i)
+    {
+        frame[i] = static_cast<std::uint16_t>((i * 2654435761U) & 0xFFFU);
+    }
+
+    BENCHMARK("Average, 4 channels, ratio 16")
+    {
+        drivers::adc::Decimator<channels, ratio> decimator;
+        return decimate(decimator, frame);
+    };
+
+    BENCHMARK("CIC order 3, 4 channels, ratio 16")
+    {
+        drivers::adc::Decimator<channels, ratio, 3> decimator;
+        return decimate(decimator, frame);
+    };
+}
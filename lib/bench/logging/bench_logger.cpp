@@ -0,0 +1,62 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "catch.hpp"
+#include "logging/logger.hpp"
+#include "async/just.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+
+namespace
+{
+    // Scheduler that drops the posted tasks, so that only the append is measured
+    struct NullScheduler
+    {
+        bool post(Delegate<void(void)>) { return true; }
+        bool postFromISR(Delegate<void(void)>) { return true; }
+        void poll() { }
+    };
+
+    struct NullWriter
+    {
+        auto operator()(const std::uint8_t *, std::uint16_t) const
+        {
+            return async::just();
+        }
+    };
+
+    constexpr std::uint32_t recordsPerRun = 64;
+    using BenchLogger = logging::Logger<NullScheduler, NullWriter, recordsPerRun>;
+}
+
+TEST_CASE("Logger benchmarks")
+{
+    NullScheduler scheduler;
+
+    BENCHMARK("Construct a logger (baseline)")
+    {
+        auto logger = std::make_unique<BenchLogger>(scheduler, NullWriter{});
+        return logger->getWriteErrors();
+    };
+
+    BENCHMARK("Construct a logger and append 64 records")
+    {
+        auto logger = std::make_unique<BenchLogger>(scheduler, NullWriter{});
+        bool ok = true;
+        for (std::uint32_t i = 0; i < recordsPerRun; ++i)
+        {
+            ok &= logger->log<"sample %u, level %d">(i, -static_cast<std::int32_t>(i));
+        }
+        return ok;
+    };
+
+    BENCHMARK("Format 64 records with snprintf (eager formatting)")
+    {
+        char buffer[64];
+        int length = 0;
+        for (std::uint32_t i = 0; i < recordsPerRun; ++i)
+        {
+            length += std::snprintf(buffer, sizeof(buffer), "sample %u, level %d\n", i, -static_cast<int>(i));
+        }
+        return length;
+    };
+}
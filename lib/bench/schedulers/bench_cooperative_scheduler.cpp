@@ -0,0 +1,65 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "catch.hpp"
+#include "schedulers/cooperative_scheduler.hpp"
+#include "schedulers/steady_clock_cycle_counter.hpp"
+#include "mocks/mock_board.hpp"
+
+namespace
+{
+    async::Event tickEvent;
+
+    struct Peripherals
+    {
+        async::EventEmitter getInterruptEvent(decltype(board::Interrupts::SysTick)) { return {&tickEvent}; }
+    };
+}
+
+TEST_CASE("Cooperative scheduler benchmarks")
+{
+    auto mockBoard = MockBoard<Peripherals>();
+    auto scheduler = schedulers::makeCooperativeScheduler<32, 4>(mockBoard);
+    std::uint32_t callCount = 0;
+    auto act = [&]() { ++callCount; };
+
+    BENCHMARK("Drain a burst of 16 tasks with poll")
+    {
+        for (int i = 0; i < 16; ++i)
+        {
+            scheduler.postFromISR({&act});
+        }
+
+        // One poll (including a timer check) per task
+        for (int i = 0; i < 16; ++i)
+        {
+            scheduler.poll();
+        }
+        return callCount;
+    };
+
+    BENCHMARK("Drain a burst of 16 tasks with runUntilIdle")
+    {
+        for (int i = 0; i < 16; ++i)
+        {
+            scheduler.postFromISR({&act});
+        }
+        return scheduler.runUntilIdle();
+    };
+}
+
+TEST_CASE("Cooperative scheduler instrumentation benchmarks")
+{
+    using Instrumentation = schedulers::SchedulerInstrumentation<schedulers::SteadyClockCycleCounter>;
+    auto mockBoard = MockBoard<Peripherals>();
+    auto scheduler = schedulers::makeCooperativeScheduler<32, 4, schedulers::ArrayTimerQueue, 1, Instrumentation>(mockBoard);
+    std::uint32_t callCount = 0;
+    auto act = [&]() { ++callCount; };
+
+    BENCHMARK("Drain a burst of 16 tasks with runUntilIdle, instrumented")
+    {
+        for (int i = 0; i < 16; ++i)
+        {
+            scheduler.postFromISR({&act});
+        }
+        return scheduler.runUntilIdle();
+    };
+}
@@ -0,0 +1,76 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "catch.hpp"
+#include "schedulers/array_timer_queue.hpp"
+#include "schedulers/timer_wheel.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct PeriodicTimer
+    {
+        int operator()() { return period; }
+
+        int period;
+    };
+
+    /**
+     * Polls a timer queue where all NTimers timers are periodic with
+     * different periods, so that most polls find nothing due.
+     */
+    template<class TimerQueue, std::uint32_t NTimers>
+    void benchmarkTimerQueue(const char * name)
+    {
+        auto timers = std::make_unique<TimerQueue>();
+        PeriodicTimer periodicTimers[NTimers];
+        for (std::uint32_t i = 0; i < NTimers; ++i)
+        {
+            periodicTimers[i].period = 5 + static_cast<int>(i % 97U);
+            timers->insert(periodicTimers[i].period, {&periodicTimers[i]});
+        }
+
+        std::uint32_t tick = 0;
+        BENCHMARK(std::string(name) + ": idle poll")
+        {
+            timers->runDue(tick, 1);
+            return tick;
+        };
+
+        BENCHMARK(std::string(name) + ": tick poll")
+        {
+            timers->runDue(++tick, 1);
+            return tick;
+        };
+
+        BENCHMARK_ADVANCED(std::string(name) + ": insert")(Catch::Benchmark::Chronometer meter)
+        {
+            PeriodicTimer timer{1};
+            std::vector<std::unique_ptr<TimerQueue>> queues(static_cast<std::size_t>(meter.runs()));
+            for (auto & queue : queues)
+            {
+                queue = std::make_unique<TimerQueue>();
+                for (std::uint32_t i = 0; i + 1U < NTimers; ++i)
+                {
+                    queue->insert(1000U + i, {&timer});
+                }
+            }
+
+            meter.measure([&](int i) {
+                return queues[static_cast<std::size_t>(i)]->insert(500U, {&timer});
+            });
+        };
+    }
+}
+
+TEST_CASE("Timer queue benchmarks")
+{
+    using namespace schedulers;
+
+    benchmarkTimerQueue<ArrayTimerQueue<4>, 4>("Array<4>");
+    benchmarkTimerQueue<TimerWheel<4>, 4>("Wheel<4>");
+    benchmarkTimerQueue<ArrayTimerQueue<32>, 32>("Array<32>");
+    benchmarkTimerQueue<TimerWheel<32>, 32>("Wheel<32>");
+    benchmarkTimerQueue<ArrayTimerQueue<256>, 256>("Array<256>");
+    benchmarkTimerQueue<TimerWheel<256>, 256>("Wheel<256>");
+}
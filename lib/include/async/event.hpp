@@ -1,22 +1,104 @@
 #pragma once
+#include <atomic>
 #include <concepts>
+#include <type_traits>
 
 namespace async
 {
-    class EventEmitter;
+    // Subscriber policies of BasicEvent
+    struct SingleSubscriber {};
+    struct MultipleSubscribers {};
+
+    template<class SubscriberPolicy> class BasicEvent;
+    template<class SubscriberPolicy> class BasicEventEmitter;
+
+    /**
+     * Event with a single subscriber, raising it is a single indirect call.
+     */
+    using Event = BasicEvent<SingleSubscriber>;
+    using EventEmitter = BasicEventEmitter<SingleSubscriber>;
+
+    /**
+     * Event with any number of subscribers, stored in an intrusive list.
+     * The handlers must be subscribed with the MultipleSubscribers policy.
+     */
+    using MulticastEvent = BasicEvent<MultipleSubscribers>;
+    using MulticastEventEmitter = BasicEventEmitter<MultipleSubscribers>;
+
+    /**
+     * Link of a handler in the subscriber list of a MulticastEvent. 
+     * A copy of a hook is never linked. A hook that is destroyed while
+     * linked (with its handler) unlinks itself.
+     */
+    class EventListHook
+    {
+    public:
+        EventListHook() = default;
+        EventListHook(const EventListHook &) { }
+        EventListHook & operator=(const EventListHook &) { return *this; }
+
+        ~EventListHook()
+        {
+            unlink();
+        }
+
+        bool isLinked() const
+        {
+            return prevNext_ != nullptr;
+        }
+
+    private:
+        friend class BasicEvent<MultipleSubscribers>;
+        friend class BasicEventEmitter<MultipleSubscribers>;
+
+        bool unlink()
+        {
+            if (!isLinked())
+            {
+                return false;
+            }
+
+            *prevNext_ = next_;
+            if (next_ != nullptr)
+            {
+                next_->prevNext_ = prevNext_;
+            }
+            prevNext_ = nullptr;
+            return true;
+        }
+
+        void (* callback_)(void *) = nullptr;
+        void * context_ = nullptr;
+        EventListHook * next_ = nullptr;
+        // Points to the next_ of the previous hook, or the head of the list
+        EventListHook ** prevNext_ = nullptr;
+    };
+
+    namespace detail
+    {
+        struct NoEventListHook {};
 
-    template<class Derived>
+        template<class SubscriberPolicy>
+        using EventListHookType = std::conditional_t<
+            std::is_same_v<SubscriberPolicy, MultipleSubscribers>, 
+            EventListHook, 
+            NoEventListHook>;
+    }
+
+    template<class Derived, class SubscriberPolicy = SingleSubscriber>
     class EventHandlerImpl
     {
-        friend class EventEmitter;
+        template<class> friend class BasicEventEmitter;
 
         static void OnEvent(void * object)
         {
             static_cast<Derived *>(object)->handleEvent();
         }
+
+        [[no_unique_address]] detail::EventListHookType<SubscriberPolicy> hook_;
     };
 
-    template<std::invocable F>
+    template<std::invocable F, class SubscriberPolicy = SingleSubscriber>
     class EventHandler final
     {
     public:
@@ -28,15 +110,16 @@ namespace async
         }
 
     private:
-        friend class EventEmitter;
+        template<class> friend class BasicEventEmitter;
 
         static void OnEvent(void * handlerBase)
         {
-            auto * self = static_cast<EventHandler<F> *>(handlerBase);
+            auto * self = static_cast<EventHandler *>(handlerBase);
             self->callback_();
         }
 
         F callback_;
+        [[no_unique_address]] detail::EventListHookType<SubscriberPolicy> hook_;
     };
 
     template<std::invocable F>
@@ -45,14 +128,21 @@ namespace async
         return {static_cast<F&&>(f)};
     }
 
-    class Event final
+    template<std::invocable F>
+    auto makeMulticastEventHandler(F && f) -> EventHandler<std::remove_cvref_t<F>, MultipleSubscribers>
+    {
+        return {static_cast<F&&>(f)};
+    }
+
+    template<>
+    class BasicEvent<SingleSubscriber> final
     {
     public:
-        Event() : callback_(nullptr), context_(nullptr) { }
-        Event(const Event &) = delete;
-        Event(Event &&) = delete;
-        Event & operator=(const Event &) = delete;
-        Event & operator=(Event &&) = delete;
+        BasicEvent() : callback_(nullptr), context_(nullptr) { }
+        BasicEvent(const BasicEvent &) = delete;
+        BasicEvent(BasicEvent &&) = delete;
+        BasicEvent & operator=(const BasicEvent &) = delete;
+        BasicEvent & operator=(BasicEvent &&) = delete;
 
         void raise()
         {
@@ -71,17 +161,57 @@ namespace async
         void (* callback_)(void *);
         void * context_;
 
-        friend class EventEmitter;
+        friend class BasicEventEmitter<SingleSubscriber>;
+    };
+
+    template<>
+    class BasicEvent<MultipleSubscribers> final
+    {
+    public:
+        BasicEvent() = default;
+        BasicEvent(const BasicEvent &) = delete;
+        BasicEvent(BasicEvent &&) = delete;
+        BasicEvent & operator=(const BasicEvent &) = delete;
+        BasicEvent & operator=(BasicEvent &&) = delete;
+
+        /**
+         * Call all subscribed handlers. Handlers may unsubscribe themselves 
+         * and subscribe new handlers (which are called from the next raise 
+         * on), but must not unsubscribe other handlers.
+         */
+        void raise()
+        {
+            EventListHook * hook = head_;
+            while (hook != nullptr)
+            {
+                EventListHook * next = hook->next_;
+                hook->callback_(hook->context_);
+                hook = next;
+            }
+        }
+
+        operator bool() const
+        {
+            return head_ != nullptr;
+        }
+
+    private:
+        EventListHook * head_ = nullptr;
+
+        friend class BasicEventEmitter<MultipleSubscribers>;
     };
 
-    class EventEmitter
+    template<>
+    class BasicEventEmitter<SingleSubscriber>
     {
     public:
-        EventEmitter(Event * event) : event_(event) { }
-        EventEmitter(const EventEmitter & rhs) { event_ = rhs.event_; }
-        EventEmitter(EventEmitter && rhs) { event_ = rhs.event_; }
-        EventEmitter & operator=(const EventEmitter & rhs) { event_ = rhs.event_; return *this; }
-        EventEmitter & operator=(EventEmitter && rhs) { event_ = rhs.event_; return *this; }
+        using SubscriberPolicy = SingleSubscriber;
+
+        BasicEventEmitter(Event * event) : event_(event) { }
+        BasicEventEmitter(const BasicEventEmitter & rhs) { event_ = rhs.event_; }
+        BasicEventEmitter(BasicEventEmitter && rhs) { event_ = rhs.event_; }
+        BasicEventEmitter & operator=(const BasicEventEmitter & rhs) { event_ = rhs.event_; return *this; }
+        BasicEventEmitter & operator=(BasicEventEmitter && rhs) { event_ = rhs.event_; return *this; }
 
         template<class Derived>
         bool subscribe(EventHandlerImpl<Derived> * handler)
@@ -118,10 +248,107 @@ namespace async
             return true;
         }
 
+        /**
+         * Unsubscribe handler, if it is the subscribed one. Same interface 
+         * as a MulticastEventEmitter.
+         */
+        template<class Derived>
+        bool unsubscribe(EventHandlerImpl<Derived> * handler)
+        {
+            return unsubscribeIfSubscribed(handler);
+        }
+
+        template<std::invocable F>
+        bool unsubscribe(EventHandler<F> * handler)
+        {
+            return unsubscribeIfSubscribed(handler);
+        }
+
     private:
+        bool unsubscribeIfSubscribed(void * handler)
+        {
+            if (event_->context_ != handler)
+            {
+                return false;
+            }
+
+            return unsubscribe();
+        }
+
         Event * event_;
     };
 
+    /**
+     * Subscribing and unsubscribing are O(1). A handler is linked into 
+     * the list with a single store, so an interrupt raising the event 
+     * either sees the handler or not.
+     */
+    template<>
+    class BasicEventEmitter<MultipleSubscribers>
+    {
+    public:
+        using SubscriberPolicy = MultipleSubscribers;
+
+        BasicEventEmitter(MulticastEvent * event) : event_(event) { }
+        BasicEventEmitter(const BasicEventEmitter & rhs) { event_ = rhs.event_; }
+        BasicEventEmitter(BasicEventEmitter && rhs) { event_ = rhs.event_; }
+        BasicEventEmitter & operator=(const BasicEventEmitter & rhs) { event_ = rhs.event_; return *this; }
+        BasicEventEmitter & operator=(BasicEventEmitter && rhs) { event_ = rhs.event_; return *this; }
+
+        /**
+         * @return false if the handler is already subscribed (to this or another event)
+         */
+        template<class Derived>
+        bool subscribe(EventHandlerImpl<Derived, MultipleSubscribers> * handler)
+        {
+            return link(handler->hook_, &EventHandlerImpl<Derived, MultipleSubscribers>::OnEvent, handler);
+        }
+
+        template<std::invocable F>
+        bool subscribe(EventHandler<F, MultipleSubscribers> * handler)
+        {
+            return link(handler->hook_, &EventHandler<F, MultipleSubscribers>::OnEvent, handler);
+        }
+
+        template<class Derived>
+        bool unsubscribe(EventHandlerImpl<Derived, MultipleSubscribers> * handler)
+        {
+            return handler->hook_.unlink();
+        }
+
+        template<std::invocable F>
+        bool unsubscribe(EventHandler<F, MultipleSubscribers> * handler)
+        {
+            return handler->hook_.unlink();
+        }
+
+    private:
+        bool link(EventListHook & hook, void (* callback)(void *), void * context)
+        {
+            if (hook.isLinked())
+            {
+                return false;
+            }
+
+            hook.callback_ = callback;
+            hook.context_ = context;
+            hook.next_ = event_->head_;
+            hook.prevNext_ = &event_->head_;
+            if (hook.next_ != nullptr)
+            {
+                hook.next_->prevNext_ = &hook.next_;
+            }
+
+            // Publish the handler. raise walks the list from interrupts, the
+            // fence keeps the writes of the hook from being moved behind it.
+            std::atomic_signal_fence(std::memory_order_release);
+            event_->head_ = &hook;
+            return true;
+        }
+
+        MulticastEvent * event_;
+    };
+
     /*namespace detail
     {
         template<class R>
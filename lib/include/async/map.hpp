@@ -206,7 +206,7 @@ namespace async
             friend auto tag_invoke(subscribe_t, S && sender, R && receiver)
             {
                 return async::subscribe(
-                    static_cast<S&&>(sender).parentSender_, 
+                    static_cast<S&&>(sender).parentStream_, 
                     MapStreamReceiver<std::remove_cvref_t<R>, FValue, FError>{
                         static_cast<R &&>(receiver), 
                         static_cast<S&&>(sender).fValue_,
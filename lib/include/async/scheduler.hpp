@@ -3,6 +3,7 @@
 #include "receiver.hpp"
 #include "tmp/tag_invoke.hpp"
 #include <concepts>
+#include <cstdint>
 
 namespace async
 {
@@ -22,6 +23,42 @@ namespace async
         { scheduler.poll() };
     };
 
+    /**
+     * Priority of a posted task. Schedulers with priorities run the 
+     * tasks with the lowest value first.
+     */
+    using Priority = std::uint8_t;
+
+    inline constexpr Priority highestPriority = 0U;
+
+    template<class T>
+    concept PriorityScheduler = 
+        Scheduler<T> &&
+        requires(T & scheduler, Delegate<void()> delegate, Priority priority) {
+            { scheduler.post(delegate, priority) } -> std::same_as<bool>;
+            { scheduler.postFromISR(delegate, priority) } -> std::same_as<bool>;
+        };
+
+    /**
+     * Post a delegate from an interrupt with a given priority. Schedulers 
+     * without priorities ignore the priority and post as usual.
+     */
+    inline constexpr struct postFromISRWithPriority_t final
+    {
+        template<Scheduler S>
+        bool operator()(S & scheduler, Delegate<void()> delegate, Priority priority) const
+        {
+            if constexpr (PriorityScheduler<S>)
+            {
+                return scheduler.postFromISR(delegate, priority);
+            }
+            else
+            {
+                return scheduler.postFromISR(delegate);
+            }
+        }
+    } postFromISRWithPriority{};
+
     template<class T>
     concept TimedScheduler = 
         Scheduler<T> &&
@@ -5,7 +5,9 @@
 #include "regmap/flash.hpp"
 #include "regmap/nvic.hpp"
 #include "regmap/stk.hpp"
+#include "regmap/dwt.hpp"
 #include "interrupts.hpp"
+#include "static_interrupts.hpp"
 #include "peripheral_types.hpp"
 #include "reg/apply.hpp"
 #include "rational.hpp"
@@ -18,6 +20,10 @@ namespace board
         DeviceMemory<std::uint32_t, 0xE000E100, 0xE000E4EF>>;
     using Stk = Peripheral<stk::tag,
         DeviceMemory<std::uint32_t, 0xE000E010, 0xE000E020>>;
+    using Dwt = Peripheral<dwt::tag,
+        DeviceMemory<std::uint32_t, 0xE0001000, 0xE0001007>>;
+    using Dcb = Peripheral<dcb::tag,
+        DeviceMemory<std::uint32_t, 0xE000EDF0, 0xE000EDFF>>;
 
     template<class ClockConfig>
     class Board
@@ -123,11 +129,26 @@ namespace board
         constexpr Adc1 getPeripheral(PeripheralTypes::tags::Adc<0>) const { return {}; }
         constexpr Adc2 getPeripheral(PeripheralTypes::tags::Adc<1>) const { return {}; }
         constexpr Adc3 getPeripheral(PeripheralTypes::tags::Adc<2>) const { return {}; }
+        constexpr AdcCommon getPeripheral(PeripheralTypes::tags::AdcCommon) const { return {}; }
 
+        /**
+         * @return async::MulticastEventEmitter for a multicast interrupt,
+         *         async::EventEmitter otherwise
+         */
         template<int irqNo>
-        async::EventEmitter getInterruptEvent(Interrupt<irqNo>)
+        auto getInterruptEvent(Interrupt<irqNo>)
         {
-            return detail::getInterruptEvent(irqNo);
+            static_assert(!StaticallyBoundInterrupt<Interrupt<irqNo>{}>, 
+                "The event of a statically bound interrupt is never raised");
+
+            if constexpr (isMulticastInterrupt<Interrupt<irqNo>{}>)
+            {
+                return async::MulticastEventEmitter{&detail::multicastInterruptEvent<irqNo>};
+            }
+            else
+            {
+                return detail::getInterruptEvent(irqNo);
+            }
         }
     };
 
@@ -108,4 +108,22 @@ namespace board
         constexpr auto RNG                    = Interrupt<80>{ };     /*!< RNG global Interrupt                                              */
         constexpr auto FPU                    = Interrupt<81>{ };     /*!< FPU global interrupt                                               */
     }
+
+    /**
+     * Interrupts with an async::MulticastEvent, which any number of handlers
+     * can subscribe to (with the MultipleSubscribers policy). A vector 
+     * shared by several peripherals is made multicast by adding it here.
+     */
+    template<auto interrupt>
+    inline constexpr bool isMulticastInterrupt = false;
+
+    // ADC1, ADC2 and ADC3
+    template<>
+    inline constexpr bool isMulticastInterrupt<Interrupts::ADC> = true;
+
+    namespace detail
+    {
+        template<int irqNo>
+        inline async::MulticastEvent multicastInterruptEvent;
+    }
 }
@@ -2,6 +2,7 @@
 #include "peripheral.hpp"
 #include "regmap/gpio.hpp"
 #include "regmap/adc.hpp"
+#include "regmap/c_adc.hpp"
 #include "regmap/spi.hpp"
 #include "regmap/exti.hpp"
 #include "regmap/syscfg.hpp"
@@ -169,6 +170,10 @@ namespace board
 			detail::PeriphCtrl<
 				decltype(rcc::APB2ENR::ADC3EN),
 				decltype(rcc::APB2RSTR::ADCRST)>>;
+	// Registers shared by the ADCs, clocked with ADC1
+	using AdcCommon = Peripheral<
+			c_adc::tag,
+			DeviceMemory<std::uint32_t, 0x40012300, 0x4001230B>>;
 	
     using SysCfg = Peripheral<
             syscfg::tag,
@@ -58,14 +58,41 @@ namespace board
 			constexpr auto VBATE = reg::RWField<_Offset, reg::BitMask32<22, 1>>{ };
 			/** ADC prescaler */
 			constexpr auto ADCPRE = reg::RWField<_Offset, reg::BitMask32<16, 2>>{ };
+
+			enum class DmaVal : std::uint32_t
+			{
+				DISABLED = 0x00,
+				MODE1 = 0x01,
+				MODE2 = 0x02,
+				MODE3 = 0x03
+			};
+
 			/** Direct memory access mode for multi ADC              mode */
-			constexpr auto DMA = reg::RWField<_Offset, reg::BitMask32<14, 2>>{ };
+			constexpr auto DMA = reg::RWField<_Offset, reg::BitMask32<14, 2>, DmaVal>{ };
 			/** DMA disable selection for multi-ADC              mode */
 			constexpr auto DDS = reg::RWField<_Offset, reg::BitMask32<13, 1>>{ };
 			/** Delay between 2 sampling              phases */
 			constexpr auto DELAY = reg::RWField<_Offset, reg::BitMask32<8, 4>>{ };
+
+			enum class MultVal : std::uint32_t
+			{
+				INDEPENDENT = 0x00,
+				DUAL_REGULAR_INJECTED_SIMULTANEOUS = 0x01,
+				DUAL_REGULAR_SIMULTANEOUS_ALTERNATE_TRIGGER = 0x02,
+				DUAL_INJECTED_SIMULTANEOUS = 0x05,
+				DUAL_REGULAR_SIMULTANEOUS = 0x06,
+				DUAL_INTERLEAVED = 0x07,
+				DUAL_ALTERNATE_TRIGGER = 0x09,
+				TRIPLE_REGULAR_INJECTED_SIMULTANEOUS = 0x11,
+				TRIPLE_REGULAR_SIMULTANEOUS_ALTERNATE_TRIGGER = 0x12,
+				TRIPLE_INJECTED_SIMULTANEOUS = 0x15,
+				TRIPLE_REGULAR_SIMULTANEOUS = 0x16,
+				TRIPLE_INTERLEAVED = 0x17,
+				TRIPLE_ALTERNATE_TRIGGER = 0x19
+			};
+
 			/** Multi ADC mode selection */
-			constexpr auto MULT = reg::RWField<_Offset, reg::BitMask32<0, 5>>{ };
+			constexpr auto MULT = reg::RWField<_Offset, reg::BitMask32<0, 5>, MultVal>{ };
 		};
 
 		/** ADC common regular data register for dual          and triple modes */
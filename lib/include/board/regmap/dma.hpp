@@ -146,7 +146,6 @@ namespace board
 			};
 
 			constexpr auto CHSEL = reg::RWMultiField<_Offset, reg::BitMask32<25, 3>, reg::RepMask<1, 1>, reg::RepLocation<8, 0x18>, ChselVal>{ };
-			constexpr auto MBURST = reg::RWMultiField<_Offset, reg::BitMask32<23, 2>, reg::RepMask<1, 1>, reg::RepLocation<8, 0x18>>{ };
 
 			enum class MburstVal : std::uint32_t
 			{
@@ -156,7 +155,7 @@ namespace board
 				INCR16 = 0x03
 			};
 
-			constexpr auto PBURST = reg::RWMultiField<_Offset, reg::BitMask32<21, 2>, reg::RepMask<1, 1>, reg::RepLocation<8, 0x18>>{ };
+			constexpr auto MBURST = reg::RWMultiField<_Offset, reg::BitMask32<23, 2>, reg::RepMask<1, 1>, reg::RepLocation<8, 0x18>, MburstVal>{ };
 
 			enum class PburstVal : std::uint32_t
 			{
@@ -166,6 +165,8 @@ namespace board
 				INCR16 = 0x03
 			};
 
+			constexpr auto PBURST = reg::RWMultiField<_Offset, reg::BitMask32<21, 2>, reg::RepMask<1, 1>, reg::RepLocation<8, 0x18>, PburstVal>{ };
+
 			constexpr auto CT = reg::RWMultiField<_Offset, reg::BitMask32<19, 1>, reg::RepMask<1, 1>, reg::RepLocation<8, 0x18>>{ };
 			constexpr auto DBM = reg::RWMultiField<_Offset, reg::BitMask32<18, 1>, reg::RepMask<1, 1>, reg::RepLocation<8, 0x18>>{ };
 			
@@ -180,7 +181,6 @@ namespace board
 			constexpr auto PL = reg::RWMultiField<_Offset, reg::BitMask32<16, 2>, reg::RepMask<1, 1>, reg::RepLocation<8, 0x18>, PlVal>{ };
 
 			constexpr auto PINCOS = reg::RWMultiField<_Offset, reg::BitMask32<15, 1>, reg::RepMask<1, 1>, reg::RepLocation<8, 0x18>>{ };
-			constexpr auto MSIZE = reg::RWMultiField<_Offset, reg::BitMask32<13, 2>, reg::RepMask<1, 1>, reg::RepLocation<8, 0x18>>{ };
 
 			enum class MsizeVal : std::uint32_t
 			{
@@ -189,6 +189,8 @@ namespace board
 				WORD = 0x02
 			};
 
+			constexpr auto MSIZE = reg::RWMultiField<_Offset, reg::BitMask32<13, 2>, reg::RepMask<1, 1>, reg::RepLocation<8, 0x18>, MsizeVal>{ };
+
 			enum class PsizeVal : std::uint32_t
 			{
 				BYTE = 0x00,
@@ -249,7 +251,16 @@ namespace board
 			constexpr auto FEIE = reg::RWMultiField<_Offset, reg::BitMask32<7, 1>, reg::RepMask<1, 1>, reg::RepLocation<8, 0x18>>{ };
 			constexpr auto FS = reg::RWMultiField<_Offset, reg::BitMask32<3, 3>, reg::RepMask<1, 1>, reg::RepLocation<8, 0x18>>{ };
 			constexpr auto DMDIS = reg::RWMultiField<_Offset, reg::BitMask32<2, 1>, reg::RepMask<1, 1>, reg::RepLocation<8, 0x18>>{ };
-			constexpr auto FTH = reg::RWMultiField<_Offset, reg::BitMask32<0, 2>, reg::RepMask<1, 1>, reg::RepLocation<8, 0x18>>{ };
+
+			enum class FthVal : std::uint32_t
+			{
+				QUARTER = 0x00,
+				HALF = 0x01,
+				THREE_QUARTERS = 0x02,
+				FULL = 0x03
+			};
+
+			constexpr auto FTH = reg::RWMultiField<_Offset, reg::BitMask32<0, 2>, reg::RepMask<1, 1>, reg::RepLocation<8, 0x18>, FthVal>{ };
 		};
 	};
 }
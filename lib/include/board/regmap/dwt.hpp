@@ -0,0 +1,37 @@
+#pragma once
+#include "reg/field.hpp"
+
+namespace board
+{
+	namespace dwt
+	{
+		struct tag { };
+		/** Control register */
+		namespace CTRL
+		{
+			using _Offset = reg::FieldLocation<std::uint32_t, tag, reg::FieldOffset<std::uint32_t, 0x0000>>;
+			/** Enable the cycle counter */
+			constexpr auto CYCCNTENA = reg::RWField<_Offset, reg::BitMask32<0, 1>>{ };
+		};
+
+		/** Cycle count register */
+		namespace CYCCNT
+		{
+			using _Offset = reg::FieldLocation<std::uint32_t, tag, reg::FieldOffset<std::uint32_t, 0x0004>>;
+			/** Cycle counter value */
+			constexpr auto CYCCNT = reg::RWField<_Offset, reg::BitMask32<0, 32>>{ };
+		};
+	};
+
+	namespace dcb
+	{
+		struct tag { };
+		/** Debug exception and monitor control register */
+		namespace DEMCR
+		{
+			using _Offset = reg::FieldLocation<std::uint32_t, tag, reg::FieldOffset<std::uint32_t, 0x000c>>;
+			/** Global enable for the DWT and ITM units */
+			constexpr auto TRCENA = reg::RWField<_Offset, reg::BitMask32<24, 1>>{ };
+		};
+	};
+}
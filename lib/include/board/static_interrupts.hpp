@@ -0,0 +1,84 @@
+#pragma once
+#include "types.hpp"
+#include "interrupts.hpp"
+
+namespace board
+{
+    /**
+     * Compile-time binding of an interrupt handler.
+     *
+     * By default, an interrupt raises its async::Event, which calls the
+     * subscribed handler indirectly. Specializing StaticInterruptHandler for
+     * an interrupt makes its vector call handle() directly instead:
+     *
+     *   template<>
+     *   struct board::StaticInterruptHandler<board::Interrupts::DMA1_Stream5>
+     *   {
+     *       static void handle() { ... }
+     *   };
+     *
+     * The specializations must be visible where the vectors are defined 
+     * (stm32/interrupts.cpp includes "interrupt_bindings.hpp" if it is on 
+     * the include path). The event of a statically bound interrupt is 
+     * never raised, subscribing to it fails (see reserveStaticallyBoundEvent).
+     */
+    template<auto interrupt>
+    struct StaticInterruptHandler { };
+
+    template<auto interrupt>
+    concept StaticallyBoundInterrupt = requires {
+        StaticInterruptHandler<interrupt>::handle();
+    };
+
+    namespace detail
+    {
+        struct StaticallyBoundEventHandler : async::EventHandlerImpl<StaticallyBoundEventHandler>
+        {
+            void handleEvent() { }
+        };
+
+        inline StaticallyBoundEventHandler staticallyBoundEventHandler;
+    }
+
+    /**
+     * Keep the event of a statically bound interrupt subscribed, so that a
+     * driver subscribing to it fails (with BUSY) instead of waiting forever.
+     *
+     * @return true if the interrupt is statically bound
+     */
+    template<int irqNo>
+    inline bool reserveStaticallyBoundEvent(Interrupt<irqNo>, async::Event & event)
+    {
+        if constexpr (StaticallyBoundInterrupt<Interrupt<irqNo>{}>)
+        {
+            async::EventEmitter{&event}.subscribe(&detail::staticallyBoundEventHandler);
+            return true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    /**
+     * Call the statically bound handler of an interrupt, raise its
+     * multicast event if it is a multicast interrupt,
+     * or raise fallbackEvent otherwise.
+     */
+    template<int irqNo, class Event>
+    inline void dispatchInterrupt(Interrupt<irqNo>, Event & fallbackEvent)
+    {
+        if constexpr (StaticallyBoundInterrupt<Interrupt<irqNo>{}>)
+        {
+            StaticInterruptHandler<Interrupt<irqNo>{}>::handle();
+        }
+        else if constexpr (isMulticastInterrupt<Interrupt<irqNo>{}>)
+        {
+            detail::multicastInterruptEvent<irqNo>.raise();
+        }
+        else
+        {
+            fallbackEvent.raise();
+        }
+    }
+}
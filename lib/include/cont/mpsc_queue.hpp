@@ -0,0 +1,137 @@
+#pragma once
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+namespace cont
+{
+    /**
+     * Bounded, lock-free multi-producer/single-consumer queue.
+     *
+     * Producers may be interrupt handlers of differing priorities (i.e. a
+     * push may be preempted by another push), while pop must only be called
+     * from a single context. Each cell carries a sequence number which tells
+     * whether it is free for the producer claiming it, or holds a value that
+     * is ready for the consumer. Producers claim cells with a CAS on the
+     * enqueue position, so no interrupts need to be disabled.
+     *
+     * A producer that is preempted between claiming a cell and publishing
+     * it makes the consumer see the queue as empty until the value has been
+     * published. No values are lost.
+     *
+     * @tparam T Value type
+     * @tparam N Capacity, must be a power of two
+     */
+    template<class T, std::uint32_t N>
+    class MpscQueue
+    {
+        static_assert(std::has_single_bit(N), "The capacity must be a power of two");
+        static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "Lock-free atomics are required");
+
+        static constexpr std::uint32_t mask = N - 1U;
+
+        struct Cell
+        {
+            std::atomic<std::uint32_t> sequence;
+            T value;
+        };
+
+    public:
+        MpscQueue()
+        {
+            for (std::uint32_t i = 0; i < N; ++i)
+            {
+                cells_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        MpscQueue(const MpscQueue &) = delete;
+        MpscQueue(MpscQueue &&) = delete;
+        MpscQueue & operator=(const MpscQueue &) = delete;
+        MpscQueue & operator=(MpscQueue &&) = delete;
+
+        /**
+         * Push a value to the queue. Safe to call from any context.
+         *
+         * @return false if the queue is full
+         */
+        bool push(const T & value)
+        {
+            std::uint32_t position = enqueuePosition_.load(std::memory_order_relaxed);
+            Cell * cell;
+            for (;;)
+            {
+                cell = &cells_[position & mask];
+                std::uint32_t sequence = cell->sequence.load(std::memory_order_acquire);
+                std::int32_t difference = static_cast<std::int32_t>(sequence - position);
+                if (difference == 0)
+                {
+                    // The cell is free, try to claim it
+                    if (enqueuePosition_.compare_exchange_weak(position, position + 1U, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (difference < 0)
+                {
+                    // The cell has not been consumed yet, the queue is full
+                    return false;
+                }
+                else
+                {
+                    // Another producer claimed the cell
+                    position = enqueuePosition_.load(std::memory_order_relaxed);
+                }
+            }
+
+            cell->value = value;
+            cell->sequence.store(position + 1U, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Pop a value from the queue. Must only be called from the consumer.
+         *
+         * @return false if the queue is empty
+         */
+        bool pop(T & value)
+        {
+            Cell & cell = cells_[dequeuePosition_ & mask];
+            std::uint32_t sequence = cell.sequence.load(std::memory_order_acquire);
+            if (static_cast<std::int32_t>(sequence - (dequeuePosition_ + 1U)) < 0)
+            {
+                return false;
+            }
+
+            value = cell.value;
+            cell.sequence.store(dequeuePosition_ + N, std::memory_order_release);
+            dequeuePosition_ = dequeuePosition_ + 1U;
+            return true;
+        }
+
+        bool isEmpty() const
+        {
+            const Cell & cell = cells_[dequeuePosition_ & mask];
+            return static_cast<std::int32_t>(
+                cell.sequence.load(std::memory_order_acquire) - (dequeuePosition_ + 1U)) < 0;
+        }
+
+        /**
+         * Number of values that have been claimed by producers but not yet 
+         * popped. Must only be called from the consumer. Includes values that 
+         * are still being published, so it may be larger than the number of 
+         * values that pop can return right now.
+         */
+        std::uint32_t size() const
+        {
+            return enqueuePosition_.load(std::memory_order_relaxed) - dequeuePosition_;
+        }
+
+        static constexpr std::uint32_t capacity() { return N; }
+
+    private:
+        Cell cells_[N];
+        std::atomic<std::uint32_t> enqueuePosition_ = 0;
+        std::uint32_t dequeuePosition_ = 0;
+    };
+}
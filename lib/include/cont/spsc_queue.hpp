@@ -0,0 +1,172 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <span>
+
+namespace cont
+{
+    /**
+     * Bounded, lock-free single-producer/single-consumer queue.
+     *
+     * The producer and the consumer may run in different contexts (e.g. an
+     * interrupt handler and the main loop). Each side owns one of the free
+     * running positions, and publishes it with release semantics after the
+     * elements have been written or read.
+     *
+     * Besides copying single elements, the queue exposes its free and filled
+     * regions as contiguous spans (acquireWrite/acquireRead), so that e.g. a
+     * DMA transfer can read or write the storage directly. A region ends at
+     * the end of the storage, so a wrapped region takes two acquires.
+     *
+     * @tparam T Value type
+     * @tparam N Capacity, must be a power of two
+     */
+    template<class T, std::uint32_t N>
+    class SpscQueue
+    {
+        static_assert(std::has_single_bit(N), "The capacity must be a power of two");
+        static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "Lock-free atomics are required");
+
+        static constexpr std::uint32_t mask = N - 1U;
+
+    public:
+        SpscQueue() = default;
+        SpscQueue(const SpscQueue &) = delete;
+        SpscQueue(SpscQueue &&) = delete;
+        SpscQueue & operator=(const SpscQueue &) = delete;
+        SpscQueue & operator=(SpscQueue &&) = delete;
+
+        // Producer side
+
+        /**
+         * @return false if the queue is full
+         */
+        bool push(const T & value)
+        {
+            std::uint32_t head = head_.load(std::memory_order_relaxed);
+            if (head - tail_.load(std::memory_order_acquire) == N)
+            {
+                return false;
+            }
+
+            storage_[head & mask] = value;
+            head_.store(head + 1U, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Push up to count values.
+         *
+         * @return The number of values pushed
+         */
+        std::uint32_t pushN(const T * values, std::uint32_t count)
+        {
+            std::uint32_t head = head_.load(std::memory_order_relaxed);
+            count = std::min(count, N - (head - tail_.load(std::memory_order_acquire)));
+
+            std::uint32_t index = head & mask;
+            std::uint32_t firstPart = std::min(count, N - index);
+            std::copy_n(values, firstPart, &storage_[index]);
+            std::copy_n(values + firstPart, count - firstPart, &storage_[0]);
+
+            head_.store(head + count, std::memory_order_release);
+            return count;
+        }
+
+        /**
+         * Get the contiguous free region starting at the write position.
+         * The values are published with commitWrite.
+         */
+        std::span<T> acquireWrite()
+        {
+            std::uint32_t head = head_.load(std::memory_order_relaxed);
+            std::uint32_t free = N - (head - tail_.load(std::memory_order_acquire));
+            std::uint32_t index = head & mask;
+            return {&storage_[index], std::min(free, N - index)};
+        }
+
+        /**
+         * Publish count values written to the region returned by acquireWrite.
+         */
+        void commitWrite(std::uint32_t count)
+        {
+            head_.store(head_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+        }
+
+        // Consumer side
+
+        /**
+         * @return false if the queue is empty
+         */
+        bool pop(T & value)
+        {
+            std::uint32_t tail = tail_.load(std::memory_order_relaxed);
+            if (head_.load(std::memory_order_acquire) == tail)
+            {
+                return false;
+            }
+
+            value = storage_[tail & mask];
+            tail_.store(tail + 1U, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Pop up to count values.
+         *
+         * @return The number of values popped
+         */
+        std::uint32_t popN(T * values, std::uint32_t count)
+        {
+            std::uint32_t tail = tail_.load(std::memory_order_relaxed);
+            count = std::min(count, head_.load(std::memory_order_acquire) - tail);
+
+            std::uint32_t index = tail & mask;
+            std::uint32_t firstPart = std::min(count, N - index);
+            std::copy_n(&storage_[index], firstPart, values);
+            std::copy_n(&storage_[0], count - firstPart, values + firstPart);
+
+            tail_.store(tail + count, std::memory_order_release);
+            return count;
+        }
+
+        /**
+         * Get the contiguous filled region starting at the read position.
+         * The values are handed back to the producer with release.
+         */
+        std::span<const T> acquireRead() const
+        {
+            std::uint32_t tail = tail_.load(std::memory_order_relaxed);
+            std::uint32_t filled = head_.load(std::memory_order_acquire) - tail;
+            std::uint32_t index = tail & mask;
+            return {&storage_[index], std::min(filled, N - index)};
+        }
+
+        /**
+         * Free count values of the region returned by acquireRead.
+         */
+        void release(std::uint32_t count)
+        {
+            tail_.store(tail_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+        }
+
+        bool isEmpty() const
+        {
+            return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+        }
+
+        std::uint32_t size() const
+        {
+            return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+        }
+
+        static constexpr std::uint32_t capacity() { return N; }
+
+    private:
+        T storage_[N];
+        std::atomic<std::uint32_t> head_ = 0;
+        std::atomic<std::uint32_t> tail_ = 0;
+    };
+}
@@ -1,4 +1,5 @@
 #pragma once
+#include <concepts>
 #include <new>
 #include <type_traits>
 
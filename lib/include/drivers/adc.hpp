@@ -1,2 +1,3 @@
 #pragma once
-#include "adc/make.hpp"
\ No newline at end of file
+#include "adc/make.hpp"
+#include "adc/decimator.hpp"
\ No newline at end of file
@@ -2,10 +2,20 @@
 #include "async/future.hpp"
 #include "async/make_future.hpp"
 #include "async/receiver.hpp"
+#include "async/stream.hpp"
+#include "async/make_stream.hpp"
 #include "adc_error.hpp"
+#include "detail/read_continuous.hpp"
+#include "detail/read_injected.hpp"
 #include "async/scheduler.hpp"
 #include "async/event.hpp"
+#include "drivers/dma/address.hpp"
 #include "drivers/dma/dma_concepts.hpp"
+#include "board/regmap/adc.hpp"
+#include "board/pinout/adc.hpp"
+#include "types.hpp"
+#include <array>
+#include <span>
 
 #include "reg/apply.hpp"
 #include "reg/set.hpp"
@@ -13,7 +23,12 @@
 
 namespace drivers::adc
 {
-    template<class AdcX, std::uint8_t NChannels, std::uint16_t _maxValue>
+    // Timer or EXTI event that starts a scan
+    using ExternalTrigger = board::adc::CR2::ExtSelVal;
+
+    using TriggerEdge = board::adc::CR2::ExtEnVal;
+
+    template<class AdcX, std::uint8_t NChannels, std::uint16_t _maxValue, class EventEmitter = async::EventEmitter>
     class Adc
     {
         template<class TransferFactory, class R>
@@ -86,7 +101,7 @@ namespace drivers::adc
         };
 
     public:
-        explicit Adc(const async::EventEmitter & eventEmitter)
+        explicit Adc(const EventEmitter & eventEmitter)
         : eventEmitter_(eventEmitter)
         {
             
@@ -111,7 +126,82 @@ namespace drivers::adc
                     return {std::move(transferFactory), static_cast<R&&>(receiver)};
                 });
         }
+
+        /**
+         * Scan the channels on every trigger event (e.g. the update event of
+         * a timer), and emit the scans in frames of scansPerFrame scans
+         * (of NChannels samples each, in scan order). The ADC and DMA are
+         * set up once, so the sampling rate is that of the trigger and a
+         * frame costs a single DMA interrupt.
+         *
+         * The DMA stream must be on the channel of the ADC's request, and
+         * configured for half-word transfers. A frame points into the
+         * buffer and may be used until the following frame is complete.
+         *
+         * @tparam scansPerFrame Number of scans in a frame, e.g. the 
+         *         decimation ratio of a Decimator
+         * @param dmaDevice DMA stream to use for the transfer
+         * @param buffer Buffer for two frames (2 * scansPerFrame * NChannels 
+         *        samples), must be kept alive while the stream is running
+         * @param trigger Event that starts a scan
+         * @param edge Edge of the trigger event that starts a scan
+         * @return stream of std::span<const std::uint16_t, scansPerFrame * NChannels>
+         */
+        template<std::uint16_t scansPerFrame = 1, dma::DmaLike Dma>
+        async::Stream<std::span<const std::uint16_t, scansPerFrame * NChannels>, AdcError> auto readContinuous(
+            Dma & dmaDevice, 
+            std::uint16_t * buffer, 
+            ExternalTrigger trigger, 
+            TriggerEdge edge = TriggerEdge::RISING_EDGE)
+        {
+            constexpr std::size_t frameSize = scansPerFrame * NChannels;
+            static_assert(scansPerFrame > 0 && 2U * frameSize <= 0xFFFFU, "Both frames must fit in one DMA transfer");
+
+            auto transferFactory = dmaDevice.transferCircular(
+                dma::PeripheralAddress(AdcX{}.getAddress(board::adc::DR::_Offset{})),
+                dma::MemoryAddress(buffer),
+                static_cast<std::uint16_t>(2U * frameSize));
+            using TransferFactoryType = decltype(transferFactory);
+
+            return async::makeStream<std::span<const std::uint16_t, frameSize>, AdcError>(
+                [transferFactory, buffer, trigger, edge]<typename R>(R && receiver) mutable
+                    -> detail::ReadContinuousOperation<detail::SingleAdcControl<AdcX>, frameSize, TransferFactoryType, std::remove_cvref_t<R>>
+                {
+                    return {std::move(transferFactory), static_cast<R&&>(receiver), buffer, trigger, edge};
+                });
+        }
+
+        /**
+         * Convert the injected group once. The conversions take priority
+         * over the regular group: a running scan (e.g. readContinuous) is
+         * interrupted and resumed, so it keeps its sampling rate.
+         *
+         * Completes from the ADC interrupt. Only one injected read per ADC
+         * can be waiting at a time, and with an async::EventEmitter only one
+         * of all ADCs, as they share the interrupt (the board has a 
+         * multicast event for it). The pins must be configured as analog
+         * inputs, e.g. by being in the regular group as well.
+         *
+         * @tparam pins Pins of the group in order of conversion, up to 4
+         * @param values Buffer for one result per pin
+         * @return void future
+         */
+        template<Pin ... pins>
+        async::Future<void, AdcError> auto readInjected(std::uint16_t * values)
+        {
+            constexpr std::array<std::uint8_t, sizeof...(pins)> channels = {
+                board::adc::AdcChannel<pins.port, pins.pin>::value...
+            };
+
+            return async::makeFuture<void, AdcError>(
+                [this, values, channels]<typename R>(R && receiver)
+                    -> detail::ReadInjectedOperation<AdcX, sizeof...(pins), EventEmitter, std::remove_cvref_t<R>>
+                {
+                    return {static_cast<R&&>(receiver), eventEmitter_, channels, values};
+                });
+        }
+
     private:
-        async::EventEmitter eventEmitter_;
+        EventEmitter eventEmitter_;
     };
 }
\ No newline at end of file
@@ -4,6 +4,8 @@ namespace drivers::adc
 {
     enum class AdcError
     {
-        BUSY
+        BUSY,
+        DMA_ERROR,
+        OVERRUN
     };
-}
\ No newline at end of file
+}
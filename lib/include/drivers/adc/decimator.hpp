@@ -0,0 +1,125 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace drivers::adc
+{
+    /**
+     * Decimates the frames of an ADC stream of ratio scans per frame (see
+     * Adc::readContinuous) to one sample per channel, e.g.
+     *
+     *     adc.readContinuous<16>(dma, buffer, trigger) | async::map(adc::Decimator<2, 16, 3>{})
+     *
+     * A filter of order 1 is the average of the frame. Higher orders are
+     * CIC filters (order integrators at the input rate, order combs at the
+     * output rate), which attenuate aliases much better, at the cost of a
+     * delay of (order - 1) frames. Every fourfold increase of the ratio
+     * (two doublings) adds one bit of resolution, the result has
+     * inputBits + log2(ratio) / 2 bits.
+     *
+     * The frame is read where the DMA left it, and the result is stored in
+     * the decimator, so nothing is copied or allocated. The result is valid
+     * until the next frame.
+     *
+     * @tparam NChannels Number of channels in a scan
+     * @tparam ratio Number of scans per frame, a power of 2
+     * @tparam order Order of the filter
+     * @tparam inputBits Resolution of the ADC
+     */
+    template<std::uint8_t NChannels, std::uint16_t ratio, std::uint8_t order = 1, std::uint8_t inputBits = 12>
+    class Decimator
+    {
+        static_assert(std::has_single_bit(ratio), "The decimation ratio must be a power of 2");
+        static_assert(order > 0);
+
+        static constexpr std::uint8_t ratioBits = std::countr_zero(ratio);
+        static constexpr std::uint8_t gainBits = order * ratioBits;
+
+        static_assert(inputBits + gainBits <= 32, "The filter state must fit in 32 bits");
+
+    public:
+        static constexpr std::size_t frameSize = ratio * NChannels;
+        static constexpr std::uint8_t outputBits = inputBits + ratioBits / 2;
+
+        static_assert(outputBits <= 16, "The result must fit in 16 bits");
+
+        std::span<const std::uint16_t, NChannels> operator()(std::span<const std::uint16_t, frameSize> frame)
+        {
+            if constexpr (order == 1)
+            {
+                std::array<std::uint32_t, NChannels> sums = {};
+                for (std::size_t scan = 0; scan < frameSize; scan += NChannels)
+                {
+                    for (std::size_t c = 0; c < NChannels; ++c)
+                    {
+                        sums[c] += frame[scan + c];
+                    }
+                }
+
+                for (std::size_t c = 0; c < NChannels; ++c)
+                {
+                    output_[c] = scale(sums[c]);
+                }
+            }
+            else
+            {
+                // Unsigned arithmetic wraps, which the combs undo, as long as
+                // the result fits in the state. The integrators are kept in a
+                // local copy, which the compiler can keep in registers.
+                State integrators = integrators_;
+                for (std::size_t scan = 0; scan < frameSize; scan += NChannels)
+                {
+                    for (std::size_t c = 0; c < NChannels; ++c)
+                    {
+                        std::uint32_t value = frame[scan + c];
+                        for (std::uint32_t & integrator : integrators[c])
+                        {
+                            integrator += value;
+                            value = integrator;
+                        }
+                    }
+                }
+                integrators_ = integrators;
+
+                for (std::size_t c = 0; c < NChannels; ++c)
+                {
+                    std::uint32_t value = integrators_[c][order - 1];
+                    for (std::uint32_t & delayed : combs_[c])
+                    {
+                        const std::uint32_t previous = delayed;
+                        delayed = value;
+                        value -= previous;
+                    }
+                    output_[c] = scale(value);
+                }
+            }
+
+            return output_;
+        }
+
+        /**
+         * Clear the filter state, e.g. when the stream is restarted
+         */
+        void reset()
+        {
+            integrators_ = {};
+            combs_ = {};
+            output_ = {};
+        }
+
+    private:
+        static constexpr std::uint16_t scale(std::uint32_t value)
+        {
+            return static_cast<std::uint16_t>(value >> (gainBits - (outputBits - inputBits)));
+        }
+
+        using State = std::array<std::array<std::uint32_t, order>, (order > 1) ? NChannels : 0>;
+
+        State integrators_ = {};
+        State combs_ = {};
+        std::array<std::uint16_t, NChannels> output_ = {};
+    };
+}
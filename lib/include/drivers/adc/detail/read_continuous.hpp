@@ -0,0 +1,267 @@
+#pragma once
+#include "../adc_error.hpp"
+#include "async/receiver.hpp"
+#include "async/scheduler.hpp"
+#include "drivers/dma/dma_concepts.hpp"
+#include "drivers/dma/dma_signal.hpp"
+#include "board/regmap/adc.hpp"
+#include "board/regmap/c_adc.hpp"
+#include "delegate.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "reg/set.hpp"
+#include "reg/clear.hpp"
+#include "reg/apply.hpp"
+#include "reg/write.hpp"
+
+namespace drivers::adc::detail
+{
+    /**
+     * Registers of a continuous read from a single ADC, which requests a
+     * DMA transfer of a half-word for every conversion.
+     */
+    template<class AdcX>
+    struct SingleAdcControl
+    {
+        static void enable(board::adc::CR2::ExtSelVal trigger, board::adc::CR2::ExtEnVal triggerEdge)
+        {
+            reg::apply(AdcX{},
+                reg::clear(board::adc::SR::EOC),
+                reg::clear(board::adc::SR::OVR));
+
+            // DDS keeps the DMA requests going after the last transfer of the buffer
+            reg::apply(AdcX{},
+                reg::clear(board::adc::CR2::CONT),
+                reg::set(board::adc::CR2::DMA),
+                reg::set(board::adc::CR2::DDS),
+                reg::write(board::adc::CR2::EXTSEL, trigger));
+
+            // Conversions start with the next trigger event
+            reg::write(AdcX{}, board::adc::CR2::EXTEN, triggerEdge);
+        }
+
+        static void disable()
+        {
+            reg::write(AdcX{}, board::adc::CR2::EXTEN, board::adc::CR2::ExtEnVal::DISABLED);
+            reg::apply(AdcX{},
+                reg::clear(board::adc::CR2::DMA),
+                reg::clear(board::adc::CR2::DDS));
+        }
+    };
+
+    /**
+     * Registers of a continuous read from ADCs in a multi ADC mode. The
+     * master (ADC1) is triggered and starts the slaves, the common data
+     * register requests a DMA transfer of a word (two conversions) at a
+     * time (DMA mode 2).
+     */
+    template<class CommonX, class MasterX>
+    struct MultiAdcControl
+    {
+        static void enable(board::adc::CR2::ExtSelVal trigger, board::adc::CR2::ExtEnVal triggerEdge)
+        {
+            reg::apply(MasterX{},
+                reg::clear(board::adc::SR::EOC),
+                reg::clear(board::adc::SR::OVR));
+
+            reg::apply(MasterX{},
+                reg::clear(board::adc::CR2::CONT),
+                reg::write(board::adc::CR2::EXTSEL, trigger));
+
+            reg::apply(CommonX{},
+                reg::write(board::c_adc::CCR::DMA, board::c_adc::CCR::DmaVal::MODE2),
+                reg::set(board::c_adc::CCR::DDS));
+
+            reg::write(MasterX{}, board::adc::CR2::EXTEN, triggerEdge);
+        }
+
+        static void disable()
+        {
+            reg::write(MasterX{}, board::adc::CR2::EXTEN, board::adc::CR2::ExtEnVal::DISABLED);
+            reg::apply(CommonX{},
+                reg::write(board::c_adc::CCR::DMA, board::c_adc::CCR::DmaVal::DISABLED),
+                reg::clear(board::c_adc::CCR::DDS));
+        }
+    };
+
+    /**
+     * Scans the channels on every external trigger event, into the two
+     * halves of a circular DMA transfer, and emits each completed half as
+     * a frame (of one or more scans) that points into the buffer.
+     *
+     * The ADC and the DMA stream are configured once, a frame only takes
+     * the DMA half transfer or transfer complete interrupt. A frame stays
+     * valid until the following frame is complete, and the next frame must
+     * be requested (with next) by then. If a frame is lapped before it
+     * has been emitted, the stream fails with AdcError::OVERRUN.
+     *
+     * @tparam Control SingleAdcControl or MultiAdcControl
+     */
+    template<class Control, std::size_t frameSize, class TransferFactory, class R>
+    class ReadContinuousOperation
+    {
+        struct DmaEventHandler
+        {
+            void operator()(dma::DmaSignal signal)
+            {
+                switch (signal)
+                {
+                    case dma::DmaSignal::TRANSFER_HALF_COMPLETE:
+                    case dma::DmaSignal::TRANSFER_COMPLETE:
+                        op_.frameCompleted();
+                        break;
+                    case dma::DmaSignal::TRANSFER_ERROR:
+                        op_.dmaError_.store(true, std::memory_order_relaxed);
+                        op_.postFrameCompleted();
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            ReadContinuousOperation & op_;
+        };
+
+        using DmaTransfer = dma::DmaTransferType<TransferFactory, DmaEventHandler>;
+    public:
+        template<class TransferFactory2, class R2>
+        ReadContinuousOperation(
+            TransferFactory2 && transferFactory,
+            R2 && receiver,
+            std::uint16_t * buffer,
+            board::adc::CR2::ExtSelVal trigger,
+            board::adc::CR2::ExtEnVal triggerEdge)
+        : transfer_(static_cast<TransferFactory2&&>(transferFactory)(DmaEventHandler{*this}))
+        , receiver_(static_cast<R2&&>(receiver))
+        , buffer_(buffer)
+        , trigger_(trigger)
+        , triggerEdge_(triggerEdge)
+        {
+
+        }
+
+        ReadContinuousOperation(const ReadContinuousOperation &) = delete;
+        ReadContinuousOperation & operator=(const ReadContinuousOperation &) = delete;
+
+        void start()
+        {
+            if (!transfer_.start())
+            {
+                async::setError(std::move(receiver_), AdcError::BUSY);
+                return;
+            }
+
+            Control::enable(trigger_, triggerEdge_);
+        }
+
+        void next()
+        {
+            ready_ = true;
+            emitPending();
+        }
+
+        void stop()
+        {
+            // The stream may have already failed
+            if (stopped_)
+            {
+                return;
+            }
+
+            disable();
+            async::setDone(std::move(receiver_));
+        }
+
+    private:
+        // Called from the DMA interrupt
+        void frameCompleted()
+        {
+            frames_.fetch_add(1, std::memory_order_release);
+            postFrameCompleted();
+        }
+
+        void postFrameCompleted()
+        {
+            if (!posted_.exchange(true, std::memory_order_acq_rel))
+            {
+                // When the queue of the scheduler is full, the next frame
+                // posts again
+                auto & s = async::getScheduler(receiver_);
+                if (!s.postFromISR({memFn<&ReadContinuousOperation::onFrameCompleted>, *this}))
+                {
+                    posted_.store(false, std::memory_order_release);
+                }
+            }
+        }
+
+        // Called from the scheduler
+        void onFrameCompleted()
+        {
+            posted_.store(false, std::memory_order_release);
+            emitPending();
+        }
+
+        void emitPending()
+        {
+            if (stopped_)
+            {
+                return;
+            }
+
+            if (dmaError_.load(std::memory_order_relaxed))
+            {
+                fail(AdcError::DMA_ERROR);
+                return;
+            }
+
+            std::uint32_t pending = frames_.load(std::memory_order_acquire) - delivered_;
+            if (pending > 1)
+            {
+                fail(AdcError::OVERRUN);
+                return;
+            }
+
+            if (!ready_ || pending == 0)
+            {
+                return;
+            }
+
+            std::uint16_t * frame = buffer_ + (delivered_ % 2U) * frameSize;
+            ready_ = false;
+            ++delivered_;
+            async::setNext(receiver_, std::span<const std::uint16_t, frameSize>(frame, frameSize));
+        }
+
+        void fail(AdcError error)
+        {
+            disable();
+            async::setError(std::move(receiver_), error);
+        }
+
+        void disable()
+        {
+            stopped_ = true;
+            Control::disable();
+            transfer_.stop();
+        }
+
+        DmaTransfer transfer_;
+        R receiver_;
+        std::uint16_t * buffer_;
+        board::adc::CR2::ExtSelVal trigger_;
+        board::adc::CR2::ExtEnVal triggerEdge_;
+
+        // Written by the interrupt
+        std::atomic<std::uint32_t> frames_ = 0;
+        std::atomic<bool> dmaError_ = false;
+        std::atomic<bool> posted_ = false;
+
+        // Written by the scheduler
+        std::uint32_t delivered_ = 0;
+        bool ready_ = true;
+        bool stopped_ = false;
+    };
+}
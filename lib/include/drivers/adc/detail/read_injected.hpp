@@ -0,0 +1,124 @@
+#pragma once
+#include "../adc_error.hpp"
+#include "async/event.hpp"
+#include "async/receiver.hpp"
+#include "async/scheduler.hpp"
+#include "board/regmap/adc.hpp"
+#include "delegate.hpp"
+#include "types.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "reg/apply.hpp"
+#include "reg/bit_is_set.hpp"
+#include "reg/clear.hpp"
+#include "reg/read.hpp"
+#include "reg/set.hpp"
+#include "reg/write.hpp"
+
+namespace drivers::adc::detail
+{
+    /**
+     * Converts the injected group once. The conversions preempt a running
+     * regular scan, which continues where it was interrupted, so a
+     * continuous read keeps its sampling rate.
+     *
+     * The group is written at the end of the injected sequence (JSQ4 is
+     * always the last conversion), the results are in JDR1 .. JDRn in
+     * order of conversion.
+     *
+     * On a multicast interrupt event, the operations of the other ADCs are
+     * subscribed at the same time, an operation only handles the interrupts
+     * of its own ADC.
+     */
+    template<class AdcX, std::size_t NInjected, class EventEmitter, class R>
+    class ReadInjectedOperation : async::EventHandlerImpl<
+        ReadInjectedOperation<AdcX, NInjected, EventEmitter, R>, 
+        typename EventEmitter::SubscriberPolicy>
+    {
+        static_assert(NInjected > 0 && NInjected <= 4, "The injected group has up to 4 channels");
+
+    public:
+        template<class R2>
+        ReadInjectedOperation(
+            R2 && receiver,
+            const EventEmitter & interruptEvent,
+            const std::array<std::uint8_t, NInjected> & channels,
+            std::uint16_t * values)
+        : receiver_(static_cast<R2&&>(receiver))
+        , interruptEvent_(interruptEvent)
+        , channels_(channels)
+        , values_(values)
+        {
+
+        }
+
+        ReadInjectedOperation(const ReadInjectedOperation &) = delete;
+        ReadInjectedOperation & operator=(const ReadInjectedOperation &) = delete;
+
+        void start()
+        {
+            // The interrupt of the injected group is enabled while a read is waiting
+            if (reg::bitIsSet(AdcX{}, board::adc::CR1::JEOCIE) || !interruptEvent_.subscribe(this))
+            {
+                async::setError(std::move(receiver_), AdcError::BUSY);
+                return;
+            }
+
+            writeSequence(std::make_index_sequence<NInjected>{});
+            reg::write(AdcX{}, board::adc::JSQR::JL, static_cast<std::uint32_t>(NInjected - 1));
+
+            reg::clear(AdcX{}, board::adc::SR::JEOC);
+            reg::set(AdcX{}, board::adc::CR1::JEOCIE);
+            reg::set(AdcX{}, board::adc::CR2::JSWSTART);
+        }
+
+        void handleEvent()
+        {
+            if (!reg::bitIsSet(AdcX{}, board::adc::SR::JEOC))
+            {
+                return;
+            }
+
+            reg::clear(AdcX{}, board::adc::SR::JEOC);
+            readResults(std::make_index_sequence<NInjected>{});
+            stop();
+
+            auto & s = async::getScheduler(receiver_);
+            s.postFromISR({memFn<&ReadInjectedOperation::setValueImpl>, *this});
+        }
+
+        void stop()
+        {
+            reg::clear(AdcX{}, board::adc::CR1::JEOCIE);
+            interruptEvent_.unsubscribe(this);
+        }
+
+    private:
+        template<std::size_t ... Is>
+        void writeSequence(std::index_sequence<Is...>)
+        {
+            (reg::write(AdcX{},
+                board::adc::JSQR::JSQ[uint8_c<4 - NInjected + Is>],
+                static_cast<std::uint32_t>(channels_[Is])), ...);
+        }
+
+        template<std::size_t ... Is>
+        void readResults(std::index_sequence<Is...>)
+        {
+            ((values_[Is] = static_cast<std::uint16_t>(reg::read(AdcX{}, board::adc::JDR::JDATA[uint8_c<Is>]))), ...);
+        }
+
+        void setValueImpl()
+        {
+            async::setValue(std::move(receiver_));
+        }
+
+        R receiver_;
+        EventEmitter interruptEvent_;
+        std::array<std::uint8_t, NInjected> channels_;
+        std::uint16_t * values_;
+    };
+}
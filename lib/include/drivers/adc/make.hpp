@@ -3,9 +3,11 @@
 #include "types.hpp"
 #include "peripheral_types.hpp"
 #include "board/regmap/adc.hpp"
+#include "board/regmap/c_adc.hpp"
 #include "board/pinout/adc.hpp"
 #include "board/interrupts.hpp"
 #include "adc.hpp"
+#include "multi_adc.hpp"
 #include "drivers/gpio/make.hpp"
 
 #include "reg/set.hpp"
@@ -45,6 +47,13 @@ namespace drivers::adc
     template<std::uint8_t NPins>
     AdcConfig(std::uint8_t, AdcPins<NPins>, ...) -> AdcConfig<NPins>;
 
+    struct MultiAdcConfig
+    {
+        MultiMode mode;
+        // Delay between the sampling phases of the ADCs in an interleaved mode, 5 to 20 ADC clock cycles
+        std::uint8_t delay = 5;
+    };
+
     namespace detail
     {
         template<class AdcX, std::uint8_t I, Pin pin>
@@ -79,6 +88,22 @@ namespace drivers::adc
                 return 1U << 12U;
             }
         }
+
+        constexpr std::uint8_t getNumberOfAdcs(MultiMode mode)
+        {
+            switch (mode)
+            {
+                case MultiMode::DUAL_REGULAR_SIMULTANEOUS:
+                case MultiMode::DUAL_INTERLEAVED:
+                    return 2;
+                case MultiMode::TRIPLE_REGULAR_SIMULTANEOUS:
+                case MultiMode::TRIPLE_INTERLEAVED:
+                    return 3;
+                default:
+                    // Injected and alternate trigger modes are not supported
+                    return 0;
+            }
+        }
     }
 
     template<std::uint8_t channelCount, AdcConfig<channelCount> config>
@@ -115,7 +140,7 @@ namespace drivers::adc
             boardDescriptor.enableIRQ(board::Interrupts::ADC);
             auto interruptEvent = boardDescriptor.getInterruptEvent(board::Interrupts::ADC);
 
-            return Adc<decltype(adcX), channelCount, detail::getMaxValue<config.resolution>()>{
+            return Adc<decltype(adcX), channelCount, detail::getMaxValue<config.resolution>(), decltype(interruptEvent)>{
                 interruptEvent
             };
         }
@@ -123,4 +148,36 @@ namespace drivers::adc
 
     template<auto config>
     inline constexpr makeAdc_t<decltype(config)::numberOfPins, config> makeAdc {};
+
+    template<MultiAdcConfig config>
+    struct makeMultiAdc_t
+    {
+        /**
+         * @param master ADC1
+         * @param slaves ADC2 (and ADC3), with the same number of channels
+         */
+        template<class Board, class MasterX, std::uint8_t NChannels, std::uint16_t maxValue, class MasterEvent, class ... SlaveXs, class ... SlaveEvents>
+        constexpr auto operator()(
+            Board boardDescriptor, 
+            const Adc<MasterX, NChannels, maxValue, MasterEvent> & /* master */, 
+            const Adc<SlaveXs, NChannels, maxValue, SlaveEvents> & ... /* slaves */) const
+        {
+            constexpr std::uint8_t numberOfAdcs = detail::getNumberOfAdcs(config.mode);
+            static_assert(numberOfAdcs != 0, "Only regular simultaneous and interleaved modes are supported");
+            static_assert(sizeof...(SlaveXs) + 1 == numberOfAdcs, "The number of ADCs does not match the mode");
+            static_assert(config.delay >= 5 && config.delay <= 20, "The delay must be 5 to 20 cycles");
+
+            constexpr auto commonX = boardDescriptor
+                .getPeripheral(PeripheralTypes::ADC_COMMON);
+
+            reg::apply(commonX,
+                reg::write(board::c_adc::CCR::DELAY, uint32_c<config.delay - 5U>),
+                reg::write(board::c_adc::CCR::MULT, constant_c<config.mode>));
+
+            return MultiAdc<decltype(commonX), MasterX, numberOfAdcs, NChannels, maxValue>{};
+        }
+    };
+
+    template<MultiAdcConfig config>
+    inline constexpr makeMultiAdc_t<config> makeMultiAdc {};
 }
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+#include "async/make_stream.hpp"
+#include "async/stream.hpp"
+#include "adc_error.hpp"
+#include "adc.hpp"
+#include "detail/read_continuous.hpp"
+#include "drivers/dma/address.hpp"
+#include "drivers/dma/dma_concepts.hpp"
+#include "board/regmap/c_adc.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+namespace drivers::adc
+{
+    using MultiMode = board::c_adc::CCR::MultVal;
+
+    /**
+     * Two or three ADCs that convert together, started by the trigger of
+     * the master (ADC1), see makeMultiAdc.
+     *
+     * In a simultaneous mode the ADCs scan their own channels at the same
+     * time, in an interleaved mode they take turns converting the same
+     * channel, which multiplies the sampling rate of that channel by the
+     * number of ADCs.
+     *
+     * @tparam CommonX Common registers of the ADCs
+     * @tparam MasterX The master ADC
+     * @tparam NAdcs Number of ADCs, 2 or 3
+     * @tparam NChannels Number of channels in the scan of each ADC
+     */
+    template<class CommonX, class MasterX, std::uint8_t NAdcs, std::uint8_t NChannels, std::uint16_t _maxValue>
+    class MultiAdc
+    {
+    public:
+        inline static constexpr std::uint8_t numberOfAdcs = NAdcs;
+        inline static constexpr std::uint8_t numberOfChannels = NChannels;
+        inline static constexpr std::uint16_t maxValue = _maxValue;
+
+        /**
+         * Convert on every trigger event, and emit the conversions in frames
+         * of scansPerFrame scans. For every channel of a scan, a frame holds
+         * the conversions of all ADCs, in order ADC1, ADC2 (, ADC3), which is
+         * the order of conversion in an interleaved mode.
+         *
+         * The conversions are read from the common data register, two at a
+         * time, so the DMA stream must be on the channel of ADC1's request,
+         * and configured for word transfers from the peripheral (to
+         * half-words in memory).
+         *
+         * @tparam scansPerFrame Number of scans in a frame
+         * @param dmaDevice DMA stream to use for the transfer
+         * @param buffer Buffer for two frames (2 * scansPerFrame * NChannels
+         *        * NAdcs samples), must be kept alive while the stream is running
+         * @param trigger Event that starts a scan
+         * @param edge Edge of the trigger event that starts a scan
+         * @return stream of std::span<const std::uint16_t, scansPerFrame * NChannels * NAdcs>
+         */
+        template<std::uint16_t scansPerFrame = 1, dma::DmaLike Dma>
+        async::Stream<std::span<const std::uint16_t, scansPerFrame * NChannels * NAdcs>, AdcError> auto readContinuous(
+            Dma & dmaDevice,
+            std::uint16_t * buffer,
+            ExternalTrigger trigger,
+            TriggerEdge edge = TriggerEdge::RISING_EDGE)
+        {
+            constexpr std::size_t frameSize = scansPerFrame * NChannels * NAdcs;
+            static_assert(frameSize % 2 == 0, "A frame must be a whole number of words (pairs of conversions)");
+            static_assert(frameSize <= 0xFFFFU, "Both frames must fit in one DMA transfer");
+
+            // Counted in words, a word per pair of conversions
+            auto transferFactory = dmaDevice.transferCircular(
+                dma::PeripheralAddress(CommonX{}.getAddress(board::c_adc::CDR::_Offset{})),
+                dma::MemoryAddress(buffer),
+                static_cast<std::uint16_t>(frameSize));
+            using TransferFactoryType = decltype(transferFactory);
+
+            return async::makeStream<std::span<const std::uint16_t, frameSize>, AdcError>(
+                [transferFactory, buffer, trigger, edge]<typename R>(R && receiver) mutable
+                    -> detail::ReadContinuousOperation<detail::MultiAdcControl<CommonX, MasterX>, frameSize, TransferFactoryType, std::remove_cvref_t<R>>
+                {
+                    return {std::move(transferFactory), static_cast<R&&>(receiver), buffer, trigger, edge};
+                });
+        }
+    };
+}
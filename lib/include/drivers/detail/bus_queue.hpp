@@ -0,0 +1,342 @@
+#pragma once
+#include "async/future.hpp"
+#include "async/operation.hpp"
+#include "async/receiver.hpp"
+#include "async/scheduler.hpp"
+#include "cont/box.hpp"
+#include <cstdint>
+#include <utility>
+
+namespace drivers::detail
+{
+    /**
+     * Intrusive queue of the requests that wait for a shared peripheral
+     * (e.g. a bus or DMA streams). The nodes are the operations of the
+     * requests, so the queue does not allocate. Node must have a
+     * Node * next member.
+     *
+     * The queue must only be used from the scheduler, the context the
+     * requests complete on.
+     */
+    template<class Node>
+    class IntrusiveQueue
+    {
+    public:
+        bool isEmpty() const
+        {
+            return head_ == nullptr;
+        }
+
+        void pushBack(Node & node)
+        {
+            node.next = nullptr;
+            (tail_ == nullptr ? head_ : tail_->next) = &node;
+            tail_ = &node;
+        }
+
+        /**
+         * Insert the node in front of the first queued node it for which
+         * before(it) is true, or at the back.
+         */
+        template<class Before>
+        void insert(Node & node, Before before)
+        {
+            Node * previous = nullptr;
+            auto * it = head_;
+            for (; it != nullptr && !before(*it); previous = it, it = it->next) { }
+
+            node.next = it;
+            (previous == nullptr ? head_ : previous->next) = &node;
+            if (it == nullptr)
+            {
+                tail_ = &node;
+            }
+        }
+
+        // Removes a node that has not been run yet
+        bool remove(Node & node)
+        {
+            Node * previous = nullptr;
+            for (auto * it = head_; it != nullptr; previous = it, it = it->next)
+            {
+                if (it == &node)
+                {
+                    (previous == nullptr ? head_ : previous->next) = it->next;
+                    if (tail_ == it)
+                    {
+                        tail_ = previous;
+                    }
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        /**
+         * Run the queued nodes in order, as long as canRun() is true. A
+         * request that completes synchronously dispatches again from its
+         * completion; that does not recurse, the loop runs the next node.
+         */
+        template<class CanRun, class Run>
+        void dispatch(CanRun canRun, Run run)
+        {
+            if (dispatching_)
+            {
+                return;
+            }
+
+            dispatching_ = true;
+            while (head_ != nullptr && canRun())
+            {
+                auto & node = *head_;
+                head_ = node.next;
+                if (head_ == nullptr)
+                {
+                    tail_ = nullptr;
+                }
+                run(node);
+            }
+            dispatching_ = false;
+        }
+
+    private:
+        Node * head_ = nullptr;
+        Node * tail_ = nullptr;
+        bool dispatching_ = false;
+    };
+
+    /**
+     * Entry of the transaction queue of a BusQueue
+     */
+    struct BusTransactionNode
+    {
+        void (*run)(BusTransactionNode &);
+        async::Priority priority = async::highestPriority;
+        BusTransactionNode * next = nullptr;
+    };
+
+    enum class BusOrder
+    {
+        // In the order the transactions were started
+        FIFO,
+        // Lowest priority value first, like the lanes of the scheduler,
+        // then in the order they were started
+        PRIORITY
+    };
+
+    /**
+     * Transaction queue of a bus that runs one transaction at a time. A
+     * running transaction is never interrupted.
+     */
+    template<BusOrder order>
+    class BusQueue
+    {
+    public:
+        void enqueue(BusTransactionNode & node)
+        {
+            if constexpr (order == BusOrder::PRIORITY)
+            {
+                queue_.insert(node, [&](const BusTransactionNode & it) { return it.priority > node.priority; });
+            }
+            else
+            {
+                queue_.pushBack(node);
+            }
+            dispatch();
+        }
+
+        bool remove(BusTransactionNode & node)
+        {
+            return queue_.remove(node);
+        }
+
+        // Called when the running transaction has completed
+        void release()
+        {
+            active_ = false;
+        }
+
+        void dispatch()
+        {
+            queue_.dispatch(
+                [this]() { return !active_; },
+                [this](BusTransactionNode & node) {
+                    active_ = true;
+                    node.run(node);
+                });
+        }
+
+    private:
+        IntrusiveQueue<BusTransactionNode> queue_;
+        bool active_ = false;
+    };
+
+    /**
+     * Hooks of a BusTransactionOperation around the inner future, e.g. to
+     * select a device on the bus. A bus without hooks uses these.
+     */
+    struct NoBusHooks
+    {
+        void select() { }
+        void deselect() { }
+    };
+
+    /**
+     * Runs a future while the bus is owned by a device: waits for its turn
+     * in the queue of the bus, calls hooks.select() and then starts the
+     * future. hooks.deselect() is called and the bus is handed to the next
+     * transaction when the future completes.
+     *
+     * Must be started and stopped from the scheduler, like the completions
+     * of the transactions.
+     */
+    template<class Queue, class Hooks, class S, class R>
+    class BusTransactionOperation : private BusTransactionNode
+    {
+        class InnerReceiver
+        {
+        public:
+            explicit InnerReceiver(BusTransactionOperation & op) : op_(op) { }
+
+            template<class ... T>
+            void setValue(T && ... values) &&
+            {
+                auto & op = op_;
+                auto & queue = op.finish();
+                async::setValue(std::move(op.getReceiver()), static_cast<T&&>(values)...);
+                queue.dispatch();
+            }
+
+            template<class E>
+            void setError(E && e) &&
+            {
+                auto & op = op_;
+                auto & queue = op.finish();
+                async::setError(std::move(op.getReceiver()), static_cast<E&&>(e));
+                queue.dispatch();
+            }
+
+            void setDone() &&
+            {
+                auto & op = op_;
+                auto & queue = op.finish();
+                async::setDone(std::move(op.getReceiver()));
+                queue.dispatch();
+            }
+
+        private:
+            template<class Cpo, class ... Args>
+            friend auto tag_invoke(Cpo cpo, const InnerReceiver & self, Args &&... args)
+                -> decltype(cpo(std::declval<const R&>(), static_cast<Args&&>(args)...))
+            {
+                return cpo(self.op_.getReceiver(), static_cast<Args&&>(args)...);
+            }
+
+            BusTransactionOperation & op_;
+        };
+
+        using InnerOperation = async::connect_result_t<S, InnerReceiver>;
+
+        enum class State
+        {
+            IDLE,
+            QUEUED,
+            ACTIVE,
+            DONE
+        };
+
+    public:
+        template<class Hooks2, class S2, class R2>
+        BusTransactionOperation(Queue & queue, async::Priority priority, Hooks2 && hooks, S2 && sender, R2 && receiver)
+        : BusTransactionNode{&BusTransactionOperation::run, priority}
+        , queue_(queue)
+        , hooks_(static_cast<Hooks2&&>(hooks))
+        , sender_(static_cast<S2&&>(sender))
+        , receiver_(static_cast<R2&&>(receiver))
+        {
+
+        }
+
+        BusTransactionOperation(const BusTransactionOperation &) = delete;
+        BusTransactionOperation & operator=(const BusTransactionOperation &) = delete;
+
+        ~BusTransactionOperation()
+        {
+            if (hasInnerOperation_)
+            {
+                innerOperation_.destruct();
+            }
+        }
+
+        void start()
+        {
+            state_ = State::QUEUED;
+            queue_.enqueue(*this);
+        }
+
+        void stop()
+        {
+            if (state_ == State::QUEUED)
+            {
+                queue_.remove(*this);
+                state_ = State::DONE;
+                async::setDone(std::move(receiver_));
+            }
+            else if (state_ == State::ACTIVE)
+            {
+                if constexpr (requires(InnerOperation & op) { op.stop(); })
+                {
+                    innerOperation_.get().stop();
+                }
+
+                // The inner operation does not necessarily complete when stopped
+                if (state_ == State::ACTIVE)
+                {
+                    auto & queue = finish();
+                    async::setDone(std::move(receiver_));
+                    queue.dispatch();
+                }
+            }
+        }
+
+        R & getReceiver() & { return receiver_; }
+        const R & getReceiver() const & { return receiver_; }
+
+    private:
+        static void run(BusTransactionNode & node)
+        {
+            static_cast<BusTransactionOperation &>(node).runImpl();
+        }
+
+        void runImpl()
+        {
+            state_ = State::ACTIVE;
+            hooks_.select();
+
+            hasInnerOperation_ = true;
+            auto & op = innerOperation_.constructWith([this]() {
+                return async::connect(std::move(sender_), InnerReceiver{*this});
+            });
+            async::start(op);
+        }
+
+        // Releases the bus. The next transaction is only dispatched after
+        // the receiver has been notified, as it may destroy this operation.
+        Queue & finish()
+        {
+            state_ = State::DONE;
+            hooks_.deselect();
+            queue_.release();
+            return queue_;
+        }
+
+        Queue & queue_;
+        [[no_unique_address]] Hooks hooks_;
+        [[no_unique_address]] S sender_;
+        [[no_unique_address]] R receiver_;
+        State state_ = State::IDLE;
+        bool hasInnerOperation_ = false;
+        cont::Box<InnerOperation> innerOperation_;
+    };
+}
@@ -17,6 +17,15 @@ namespace drivers::dma
     {
     public:
     	constexpr MemoryAddress(std::uint32_t address) : address_(address) { }
+
+        // The address of a buffer. Truncated to 32 bits when compiled for a 64 bit host.
+        template<class T>
+        MemoryAddress(T * ptr)
+        : address_(static_cast<std::uint32_t>(reinterpret_cast<std::uintptr_t>(ptr)))
+        {
+
+        }
+
         constexpr std::uint32_t getAddress() const { return address_; }
 
     private:
@@ -36,4 +45,11 @@ namespace drivers::dma
         std::uint32_t address0_;
         std::uint32_t address1_;
     };
+
+    // Part of a chained transfer: size data items at address
+    struct MemorySegment
+    {
+        MemoryAddress address;
+        std::uint16_t size;
+    };
 }
\ No newline at end of file
@@ -0,0 +1,192 @@
+#pragma once
+#include "types.hpp"
+#include "transfer_operation.hpp"
+#include "async/event.hpp"
+#include "../address.hpp"
+#include "../dma_signal.hpp"
+#include "board/regmap/dma.hpp"
+#include <cstddef>
+#include <cstdint>
+
+#include "reg/write.hpp"
+#include "reg/set.hpp"
+#include "reg/clear.hpp"
+#include "reg/apply.hpp"
+#include "reg/bit_is_set.hpp"
+
+namespace drivers::dma::detail
+{
+    /**
+     * Transfers the memory segments one after the other, from or to the
+     * same peripheral address. The stream is re-armed with the next segment
+     * from the transfer complete interrupt, which only takes the writes of
+     * the memory address, the size and the enable bit.
+     *
+     * The handler gets TRANSFER_COMPLETE once, after the last segment.
+     * Empty segments are skipped.
+     *
+     * @tparam Segments std::array or std::span of MemorySegment
+     */
+    template<
+        class DmaX,
+        std::uint8_t streamIndex,
+        class Segments,
+        bool toPeripheral,
+        class R>
+    class ChainedTransferOperation : public async::EventHandlerImpl<
+        ChainedTransferOperation<DmaX, streamIndex, Segments, toPeripheral, R>>
+    {
+    public:
+        template<class Segments2, class R2>
+        ChainedTransferOperation(
+            const async::EventEmitter & interruptEvent,
+            Segments2 && segments,
+            PeripheralAddress peripheralAddress,
+            R2 && receiver)
+        : interruptEvent_(interruptEvent)
+        , segments_(static_cast<Segments2&&>(segments))
+        , peripheralAddress_(peripheralAddress)
+        , handler_(static_cast<R2&&>(receiver))
+        {
+
+        }
+
+        ChainedTransferOperation(const ChainedTransferOperation&) = delete;
+        ChainedTransferOperation & operator=(const ChainedTransferOperation&) = delete;
+
+        bool start()
+        {
+            if (!interruptEvent_.subscribe(this))
+            {
+                return false;
+            }
+
+            constexpr auto streamIdx = uint8_c<streamIndex>;
+
+            // Clear interrupt flags
+            reg::apply(DmaX{},
+                reg::set(board::dma::IFCR::CTCIF[streamIdx]),
+                reg::set(board::dma::IFCR::CTEIF[streamIdx]),
+                reg::set(board::dma::IFCR::CDMEIF[streamIdx]),
+                reg::set(board::dma::IFCR::CFEIF[streamIdx]),
+                reg::set(board::dma::IFCR::CHTIF[streamIdx]));
+
+            // The memory address is set per segment
+            if constexpr (toPeripheral)
+            {
+                setMemoryAddressAndDirection(DmaX{}, streamIdx, MemoryAddress(0U), peripheralAddress_);
+            }
+            else
+            {
+                setMemoryAddressAndDirection(DmaX{}, streamIdx, peripheralAddress_, MemoryAddress(0U));
+            }
+
+            reg::apply(DmaX{},
+                reg::clear(board::dma::CR::DBM[streamIdx]),
+                reg::clear(board::dma::CR::CIRC[streamIdx]));
+
+            reg::apply(DmaX{},
+                reg::set(board::dma::CR::TCIE[streamIdx]),
+                reg::set(board::dma::CR::TEIE[streamIdx]),
+                reg::clear(board::dma::CR::HTIE[streamIdx]),
+                reg::clear(board::dma::CR::DMEIE[streamIdx]));
+
+            next_ = 0;
+            if (!armNext())
+            {
+                stop();
+                handler_(DmaSignal::TRANSFER_COMPLETE);
+            }
+
+            return true;
+        }
+
+        void handleEvent()
+        {
+            if (reg::bitIsSet(DmaX{}, board::dma::ISR::TEIF[uint8_c<streamIndex>]))
+            {
+                reg::set(DmaX{}, board::dma::IFCR::CTEIF[uint8_c<streamIndex>]);
+
+                stop();
+                handler_(DmaSignal::TRANSFER_ERROR);
+
+                return;
+            }
+
+            if (reg::bitIsSet(DmaX{}, board::dma::ISR::TCIF[uint8_c<streamIndex>]))
+            {
+                reg::set(DmaX{}, board::dma::IFCR::CTCIF[uint8_c<streamIndex>]);
+
+                // The stream is disabled by the hardware at the end of a segment
+                if (!armNext())
+                {
+                    stop();
+                    handler_(DmaSignal::TRANSFER_COMPLETE);
+                }
+            }
+        }
+
+        /**
+         * Number of segments that have been started, including the one
+         * in progress.
+         */
+        std::size_t segmentsStarted() const
+        {
+            return next_;
+        }
+
+        void stop()
+        {
+            reg::apply(DmaX{},
+                reg::clear(board::dma::CR::TCIE[uint8_c<streamIndex>]),
+                reg::clear(board::dma::CR::TEIE[uint8_c<streamIndex>]));
+
+            interruptEvent_.unsubscribe();
+        }
+
+    private:
+        bool armNext()
+        {
+            while (next_ < segments_.size() && segments_[next_].size == 0)
+            {
+                ++next_;
+            }
+
+            if (next_ == segments_.size())
+            {
+                return false;
+            }
+
+            const MemorySegment & segment = segments_[next_++];
+            constexpr auto streamIdx = uint8_c<streamIndex>;
+            reg::write(DmaX{}, board::dma::M0AR::M0A[streamIdx], segment.address.getAddress());
+            reg::write(DmaX{}, board::dma::NDTR::NDT[streamIdx], segment.size);
+            reg::set(DmaX{}, board::dma::CR::EN[streamIdx]);
+            return true;
+        }
+
+        async::EventEmitter interruptEvent_;
+        Segments segments_;
+        PeripheralAddress peripheralAddress_;
+        std::size_t next_ = 0;
+        R handler_;
+    };
+
+    template<class DmaX,
+        std::uint8_t streamIndex,
+        class Segments,
+        bool toPeripheral>
+    struct ChainedTransferOperationFactory
+    {
+        template<std::invocable<DmaSignal> R>
+        auto operator()(R && receiver) const
+            -> ChainedTransferOperation<DmaX, streamIndex, Segments, toPeripheral, std::remove_cvref_t<R>>
+        {
+            return {interruptEvent_, segments_, peripheralAddress_, static_cast<R&&>(receiver)};
+        }
+
+        async::EventEmitter interruptEvent_;
+        Segments segments_;
+        PeripheralAddress peripheralAddress_;
+    };
+}
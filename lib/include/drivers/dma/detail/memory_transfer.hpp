@@ -0,0 +1,240 @@
+#pragma once
+#include "types.hpp"
+#include "async/event.hpp"
+#include "board/regmap/dma.hpp"
+#include <cstdint>
+
+#include "reg/write.hpp"
+#include "reg/set.hpp"
+#include "reg/clear.hpp"
+#include "reg/apply.hpp"
+#include "reg/bit_is_set.hpp"
+
+namespace drivers::dma::detail
+{
+    /**
+     * Data width and burst of a memory to memory transfer.
+     *
+     * The width is the widest that the addresses and the size are aligned
+     * to. Bursts fill the FIFO (16 bytes) at once, and are used when the
+     * addresses and the size are aligned to 16 bytes, so that a burst
+     * never crosses a 1 KB boundary. A transfer with more items than the
+     * 16 bit counter of a stream can hold is split into chunks, which are
+     * a multiple of the burst.
+     */
+    struct MemoryTransferPlan
+    {
+        using Width = board::dma::CR::PsizeVal;
+
+        static constexpr std::uint32_t fifoSize = 16;
+        static constexpr std::uint32_t maxItems = 0xFFFF;
+
+        static constexpr MemoryTransferPlan make(std::uint32_t dst, std::uint32_t src, std::uint32_t size, bool fill)
+        {
+            // The source of a fill is a word that is not incremented
+            const std::uint32_t alignment = dst | size | (fill ? 0U : src);
+
+            MemoryTransferPlan plan{};
+            if (alignment % 4 == 0)
+            {
+                plan.width = Width::WORD;
+                plan.itemSize = 4;
+            }
+            else if (alignment % 2 == 0)
+            {
+                plan.width = Width::HALF_WORD;
+                plan.itemSize = 2;
+            }
+            else
+            {
+                plan.width = Width::BYTE;
+                plan.itemSize = 1;
+            }
+
+            plan.burst = alignment % fifoSize == 0;
+            const std::uint32_t beats = plan.burst ? fifoSize / plan.itemSize : 1;
+            plan.itemsPerChunk = maxItems - maxItems % beats;
+            return plan;
+        }
+
+        board::dma::CR::MburstVal memoryBurst() const
+        {
+            if (!burst)
+            {
+                return board::dma::CR::MburstVal::SINGLE_TRANSFER;
+            }
+
+            switch (width)
+            {
+                case Width::WORD:
+                    return board::dma::CR::MburstVal::INCR4;
+                case Width::HALF_WORD:
+                    return board::dma::CR::MburstVal::INCR8;
+                default:
+                    return board::dma::CR::MburstVal::INCR16;
+            }
+        }
+
+        board::dma::CR::PburstVal peripheralBurst() const
+        {
+            return static_cast<board::dma::CR::PburstVal>(memoryBurst());
+        }
+
+        Width width;
+        std::uint32_t itemSize;
+        bool burst;
+        std::uint32_t itemsPerChunk;
+    };
+
+    enum class MemoryTransferStatus
+    {
+        COMPLETE,
+        BUSY,
+        TRANSFER_ERROR
+    };
+
+    /**
+     * Entry of the request queue of a MemoryEngine
+     */
+    struct MemoryTransferNode
+    {
+        // Called from the DMA interrupt when the last chunk is done, or
+        // from run when the stream is taken
+        void (*complete)(MemoryTransferNode &, MemoryTransferStatus);
+        std::uint32_t dst = 0;
+        std::uint32_t src = 0;
+        std::uint32_t size = 0;
+        bool fill = false;
+        std::uint8_t stream = 0;
+        MemoryTransferNode * next = nullptr;
+    };
+
+    /**
+     * A stream of a MemoryEngine. Runs one request at a time, chunk after
+     * chunk, re-armed from the transfer complete interrupt.
+     */
+    template<class DmaX, std::uint8_t streamIndex>
+    class MemoryStream : public async::EventHandlerImpl<MemoryStream<DmaX, streamIndex>>
+    {
+    public:
+        explicit MemoryStream(const async::EventEmitter & interruptEvent)
+        : interruptEvent_(interruptEvent)
+        {
+
+        }
+
+        MemoryStream(const MemoryStream &) = delete;
+        MemoryStream & operator=(const MemoryStream &) = delete;
+
+        void run(MemoryTransferNode & node)
+        {
+            if (!interruptEvent_.subscribe(this))
+            {
+                node.complete(node, MemoryTransferStatus::BUSY);
+                return;
+            }
+
+            node_ = &node;
+            plan_ = MemoryTransferPlan::make(node.dst, node.src, node.size, node.fill);
+            dst_ = node.dst;
+            src_ = node.src;
+            remaining_ = node.size / plan_.itemSize;
+
+            constexpr auto streamIdx = uint8_c<streamIndex>;
+
+            reg::apply(DmaX{},
+                reg::set(board::dma::IFCR::CTCIF[streamIdx]),
+                reg::set(board::dma::IFCR::CTEIF[streamIdx]),
+                reg::set(board::dma::IFCR::CDMEIF[streamIdx]),
+                reg::set(board::dma::IFCR::CFEIF[streamIdx]),
+                reg::set(board::dma::IFCR::CHTIF[streamIdx]));
+
+            // Memory to memory needs the FIFO, a full FIFO is one burst
+            reg::apply(DmaX{},
+                reg::set(board::dma::FCR::DMDIS[streamIdx]),
+                reg::write(board::dma::FCR::FTH[streamIdx], constant_c<board::dma::FCR::FthVal::FULL>));
+
+            // The peripheral port is the source, which does not burst
+            // from the fixed address of a fill
+            reg::apply(DmaX{},
+                reg::write(board::dma::CR::DIR[streamIdx], constant_c<board::dma::CR::DirVal::MEMORY_TO_MEMORY>),
+                reg::write(board::dma::CR::PSIZE[streamIdx], plan_.width),
+                reg::write(board::dma::CR::MSIZE[streamIdx], static_cast<board::dma::CR::MsizeVal>(plan_.width)),
+                reg::write(board::dma::CR::PBURST[streamIdx], node.fill ? board::dma::CR::PburstVal::SINGLE_TRANSFER : plan_.peripheralBurst()),
+                reg::write(board::dma::CR::MBURST[streamIdx], plan_.memoryBurst()),
+                reg::write(board::dma::CR::PINC[streamIdx], !node.fill),
+                reg::set(board::dma::CR::MINC[streamIdx]),
+                reg::clear(board::dma::CR::CIRC[streamIdx]),
+                reg::clear(board::dma::CR::DBM[streamIdx]),
+                reg::set(board::dma::CR::TCIE[streamIdx]),
+                reg::set(board::dma::CR::TEIE[streamIdx]),
+                reg::clear(board::dma::CR::HTIE[streamIdx]),
+                reg::clear(board::dma::CR::DMEIE[streamIdx]));
+
+            armNext();
+        }
+
+        void handleEvent()
+        {
+            constexpr auto streamIdx = uint8_c<streamIndex>;
+
+            if (reg::bitIsSet(DmaX{}, board::dma::ISR::TEIF[streamIdx]))
+            {
+                reg::set(DmaX{}, board::dma::IFCR::CTEIF[streamIdx]);
+                finish(MemoryTransferStatus::TRANSFER_ERROR);
+                return;
+            }
+
+            if (reg::bitIsSet(DmaX{}, board::dma::ISR::TCIF[streamIdx]))
+            {
+                reg::set(DmaX{}, board::dma::IFCR::CTCIF[streamIdx]);
+
+                if (remaining_ == 0)
+                {
+                    finish(MemoryTransferStatus::COMPLETE);
+                    return;
+                }
+
+                armNext();
+            }
+        }
+
+    private:
+        void armNext()
+        {
+            const std::uint32_t items = remaining_ < plan_.itemsPerChunk ? remaining_ : plan_.itemsPerChunk;
+
+            constexpr auto streamIdx = uint8_c<streamIndex>;
+            reg::write(DmaX{}, board::dma::PAR::PA[streamIdx], src_);
+            reg::write(DmaX{}, board::dma::M0AR::M0A[streamIdx], dst_);
+            reg::write(DmaX{}, board::dma::NDTR::NDT[streamIdx], items);
+            reg::set(DmaX{}, board::dma::CR::EN[streamIdx]);
+
+            remaining_ -= items;
+            dst_ += items * plan_.itemSize;
+            if (!node_->fill)
+            {
+                src_ += items * plan_.itemSize;
+            }
+        }
+
+        void finish(MemoryTransferStatus status)
+        {
+            reg::apply(DmaX{},
+                reg::clear(board::dma::CR::TCIE[uint8_c<streamIndex>]),
+                reg::clear(board::dma::CR::TEIE[uint8_c<streamIndex>]));
+            interruptEvent_.unsubscribe();
+
+            auto & node = *node_;
+            node_ = nullptr;
+            node.complete(node, status);
+        }
+
+        async::EventEmitter interruptEvent_;
+        MemoryTransferNode * node_ = nullptr;
+        MemoryTransferPlan plan_ = {};
+        std::uint32_t dst_ = 0;
+        std::uint32_t src_ = 0;
+        std::uint32_t remaining_ = 0;
+    };
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include "memory_transfer.hpp"
+#include "../address.hpp"
+#include "../dma_error.hpp"
+#include "async/receiver.hpp"
+#include "async/scheduler.hpp"
+#include "delegate.hpp"
+#include <cstdint>
+#include <utility>
+
+namespace drivers::dma::detail
+{
+    /**
+     * Copy or fill of a MemoryEngine. Waits in the queue of the engine
+     * until a stream is free, the stream is handed to the next request as
+     * soon as this one completes.
+     */
+    template<class Engine, class R>
+    class MemoryTransferOperation : private MemoryTransferNode
+    {
+        enum class State
+        {
+            IDLE,
+            QUEUED,
+            DONE
+        };
+
+    public:
+        /**
+         * @param src Source address of a copy, or the pattern of a fill
+         */
+        template<class R2>
+        MemoryTransferOperation(Engine & engine, std::uint32_t dst, std::uint32_t src, std::uint32_t size, bool fill, R2 && receiver)
+        : MemoryTransferNode{&MemoryTransferOperation::onComplete, dst, src, size, fill}
+        , engine_(engine)
+        , pattern_(src)
+        , receiver_(static_cast<R2&&>(receiver))
+        {
+
+        }
+
+        MemoryTransferOperation(const MemoryTransferOperation &) = delete;
+        MemoryTransferOperation & operator=(const MemoryTransferOperation &) = delete;
+
+        void start()
+        {
+            if (size == 0)
+            {
+                state_ = State::DONE;
+                async::setValue(std::move(receiver_));
+                return;
+            }
+
+            // The operation does not move once started
+            if (fill)
+            {
+                src = MemoryAddress(&pattern_).getAddress();
+            }
+
+            state_ = State::QUEUED;
+            engine_.enqueue(*this);
+        }
+
+        // A running transfer is not interrupted, it completes as usual
+        void stop()
+        {
+            // The engine has already taken the node if it is running
+            if (state_ == State::QUEUED && engine_.remove(*this))
+            {
+                state_ = State::DONE;
+                async::setDone(std::move(receiver_));
+            }
+        }
+
+    private:
+        static void onComplete(MemoryTransferNode & node, MemoryTransferStatus status)
+        {
+            auto & op = static_cast<MemoryTransferOperation &>(node);
+            op.status_ = status;
+
+            // A stream that is taken is found when the engine runs the node
+            if (status == MemoryTransferStatus::BUSY)
+            {
+                op.completeImpl();
+                return;
+            }
+
+            auto & s = async::getScheduler(op.receiver_);
+            s.postFromISR({memFn<&MemoryTransferOperation::completeImpl>, op});
+        }
+
+        void completeImpl()
+        {
+            // The receiver may destroy the operation
+            auto & engine = engine_;
+            state_ = State::DONE;
+            engine.release(stream);
+
+            switch (status_)
+            {
+                case MemoryTransferStatus::COMPLETE:
+                    async::setValue(std::move(receiver_));
+                    break;
+                case MemoryTransferStatus::BUSY:
+                    async::setError(std::move(receiver_), DmaError::BUSY);
+                    break;
+                default:
+                    async::setError(std::move(receiver_), DmaError::TRANSFER_ERROR);
+                    break;
+            }
+
+            engine.dispatch();
+        }
+
+        Engine & engine_;
+        std::uint32_t pattern_;
+        [[no_unique_address]] R receiver_;
+        State state_ = State::IDLE;
+        MemoryTransferStatus status_ = MemoryTransferStatus::COMPLETE;
+    };
+}
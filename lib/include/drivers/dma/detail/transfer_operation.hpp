@@ -154,7 +154,7 @@ namespace drivers::dma::detail
             reg::apply(DmaX{}, 
                 reg::set(board::dma::CR::TCIE[streamIdx]),
                 reg::set(board::dma::CR::TEIE[streamIdx]),
-                reg::clear(board::dma::CR::HTIE[streamIdx]),
+                reg::write(board::dma::CR::HTIE[streamIdx], bool_c<mode == DmaMode::CIRCULAR>),
                 reg::clear(board::dma::CR::DMEIE[streamIdx]));
 
             reg::write(DmaX{}, board::dma::NDTR::NDT[streamIdx], size_);
@@ -180,32 +180,15 @@ namespace drivers::dma::detail
 
             // TODO handle direct mode error, fifo error
 
-            // Transfer half complete
-            /*if(reg::bitIsSet(DmaX{}, board::dma::ISR::HTIF[uint8_c<streamIndex>]))
+            // Transfer half complete, only enabled in circular mode
+            if constexpr (mode == DmaMode::CIRCULAR)
             {
-                reg::set(DmaX{}, board::dma::IFCR::CHTIF[uint8_c<streamIndex>]);
-
-                if constexpr (mode == DmaMode::SINGLE_SHOT)
+                if(reg::bitIsSet(DmaX{}, board::dma::ISR::HTIF[uint8_c<streamIndex>]))
                 {
+                    reg::set(DmaX{}, board::dma::IFCR::CHTIF[uint8_c<streamIndex>]);
                     handler_(DmaSignal::TRANSFER_HALF_COMPLETE);
-                    reg::clear(DmaX{}, board::dma::CR::HTIE);
                 }
-                else if constexpr (mode == DmaMode::DOUBLE_BUFFERED)
-                {
-                    if (reg::read(DmaX{}, board::dma::CR::CT[uint8_c<streamIndex>]) == 0)
-                    {
-                        handler_(DmaSignal::TRANSFER_HALF_COMPLETE_MEMORY1);
-                    }
-                    else
-                    {
-                        handler_(DmaSignal::TRANSFER_HALF_COMPLETE);
-                    }
-                }
-                else
-                {
-                    handler_(DmaSignal::TRANSFER_HALF_COMPLETE);
-                }
-            }*/
+            }
 
             // Transfer complete
             if (reg::bitIsSet(DmaX{}, board::dma::ISR::TCIF[uint8_c<streamIndex>]))
@@ -235,11 +218,21 @@ namespace drivers::dma::detail
             }
         }
 
+        /**
+         * Number of data items left to transfer. Counts down from the 
+         * transfer size, and is reloaded when a circular transfer wraps around.
+         */
+        std::uint16_t remaining() const
+        {
+            return static_cast<std::uint16_t>(reg::read(DmaX{}, board::dma::NDTR::NDT[uint8_c<streamIndex>]));
+        }
+
         void stop()
         {
             reg::apply(DmaX{}, 
                 reg::clear(board::dma::CR::TCIE[uint8_c<streamIndex>]),
-                reg::clear(board::dma::CR::TEIE[uint8_c<streamIndex>]));
+                reg::clear(board::dma::CR::TEIE[uint8_c<streamIndex>]),
+                reg::clear(board::dma::CR::HTIE[uint8_c<streamIndex>]));
             
             interruptEvent_.unsubscribe();
         }
@@ -3,7 +3,11 @@
 #include "detail/dma_modes.hpp"
 #include "address.hpp"
 #include "detail/transfer_operation.hpp"
+#include "detail/chained_transfer_operation.hpp"
 #include "async/event.hpp"
+#include <array>
+#include <cstddef>
+#include <span>
 
 namespace drivers::dma
 {
@@ -34,6 +38,18 @@ namespace drivers::dma
             return {interruptEvent_, src, dst, size};
         }
 
+        auto transferCircular(MemoryAddress src, PeripheralAddress dst, std::uint16_t size)
+            -> detail::TransferOperationFactory<DmaX, streamIndex, detail::DmaMode::CIRCULAR, MemoryAddress, PeripheralAddress>
+        {
+            return {interruptEvent_, src, dst, size};
+        }
+
+        auto transferCircular(PeripheralAddress src, MemoryAddress dst, std::uint16_t size)
+            -> detail::TransferOperationFactory<DmaX, streamIndex, detail::DmaMode::CIRCULAR, PeripheralAddress, MemoryAddress>
+        {
+            return {interruptEvent_, src, dst, size};
+        }
+
         auto transferDoubleBuffered(MemoryAddressPair src, PeripheralAddress dst, std::uint16_t size)
             -> detail::TransferOperationFactory<DmaX, streamIndex, detail::DmaMode::DOUBLE_BUFFERED, MemoryAddressPair, PeripheralAddress>
         {
@@ -45,7 +61,43 @@ namespace drivers::dma
         {
             return {interruptEvent_, src, dst, size};
         }
-        
+
+        /**
+         * Transfer the segments one after the other, e.g. the header,
+         * payload and CRC of a packet, without copying them to one buffer.
+         * The segments are copied into the transfer.
+         */
+        template<std::size_t N>
+        auto transferChain(const std::array<MemorySegment, N> & src, PeripheralAddress dst)
+            -> detail::ChainedTransferOperationFactory<DmaX, streamIndex, std::array<MemorySegment, N>, true>
+        {
+            return {interruptEvent_, src, dst};
+        }
+
+        template<std::size_t N>
+        auto transferChain(PeripheralAddress src, const std::array<MemorySegment, N> & dst)
+            -> detail::ChainedTransferOperationFactory<DmaX, streamIndex, std::array<MemorySegment, N>, false>
+        {
+            return {interruptEvent_, dst, src};
+        }
+
+        /**
+         * Transfer the segments one after the other. The segments are
+         * read during the transfer, and must be kept alive until it is
+         * complete.
+         */
+        auto transferChain(std::span<const MemorySegment> src, PeripheralAddress dst)
+            -> detail::ChainedTransferOperationFactory<DmaX, streamIndex, std::span<const MemorySegment>, true>
+        {
+            return {interruptEvent_, src, dst};
+        }
+
+        auto transferChain(PeripheralAddress src, std::span<const MemorySegment> dst)
+            -> detail::ChainedTransferOperationFactory<DmaX, streamIndex, std::span<const MemorySegment>, false>
+        {
+            return {interruptEvent_, dst, src};
+        }
+
     private:
         async::EventEmitter interruptEvent_;
     };
@@ -36,6 +36,8 @@ namespace drivers::dma
         {
             { dma.transferDoubleBuffered(memoryAddressPair, peripheralAddress, size) } -> DmaTransferFactory;
             { dma.transferDoubleBuffered(peripheralAddress, memoryAddressPair, size) } -> DmaTransferFactory;
+            { dma.transferCircular(memoryAddress, peripheralAddress, size) } -> DmaTransferFactory;
+            { dma.transferCircular(peripheralAddress, memoryAddress, size) } -> DmaTransferFactory;
             { dma.transferSingle(memoryAddress, peripheralAddress, size) }  -> DmaTransferFactory;
             { dma.transferSingle(peripheralAddress, memoryAddress, size) } -> DmaTransferFactory;
             { dma.transferSingle(memoryAddress, memoryAddress, size) } -> DmaTransferFactory;
@@ -0,0 +1,10 @@
+#pragma once
+
+namespace drivers::dma
+{
+    enum class DmaError
+    {
+        BUSY,
+        TRANSFER_ERROR
+    };
+}
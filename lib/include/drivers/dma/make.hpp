@@ -2,6 +2,7 @@
 #include "peripheral_types.hpp"
 #include "board/interrupts.hpp"
 #include "dma.hpp"
+#include "memory_engine.hpp"
 #include "board/regmap/dma.hpp"
 #include "reg/bit_is_set.hpp"
 
@@ -94,4 +95,39 @@ namespace drivers::dma
 
     template<DmaConfig config>
     inline constexpr makeStream_t<config> makeStream{};
+
+    template<std::uint8_t deviceId, std::uint8_t ... streamIds>
+    struct makeMemoryEngine_t
+    {
+        static_assert(deviceId == 1, "Only DMA2 can transfer from memory to memory");
+
+        template<class Board>
+        constexpr auto operator()(Board boardDescriptor) const
+        {
+            constexpr auto dmaX = boardDescriptor.getPeripheral(PeripheralTypes::DMA<deviceId>);
+
+            dmaX.enable();
+
+            // Disable the streams if currently enabled
+            ([&](auto streamIndex) {
+                if(reg::bitIsSet(dmaX, board::dma::CR::EN[streamIndex]))
+                {
+                    reg::clear(dmaX, board::dma::CR::EN[streamIndex]);
+                    while(reg::bitIsSet(dmaX, board::dma::CR::EN[streamIndex])) { }
+                }
+            }(uint8_c<streamIds>), ...);
+
+            (boardDescriptor.enableIRQ(detail::getDmaInterrupt(detail::DmaStreamId<deviceId, streamIds>{})), ...);
+
+            return MemoryEngine<decltype(dmaX), streamIds...>{
+                boardDescriptor.getInterruptEvent(detail::getDmaInterrupt(detail::DmaStreamId<deviceId, streamIds>{}))...};
+        }
+    };
+
+    /**
+     * Memory copy and fill engine on the given streams of DMA2, e.g.
+     * makeMemoryEngine<1, 0, 1>(board) for streams 0 and 1
+     */
+    template<std::uint8_t deviceId, std::uint8_t ... streamIds>
+    inline constexpr makeMemoryEngine_t<deviceId, streamIds...> makeMemoryEngine{};
 }
\ No newline at end of file
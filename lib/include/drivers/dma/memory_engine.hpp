@@ -0,0 +1,145 @@
+#pragma once
+#include "async/future.hpp"
+#include "async/make_future.hpp"
+#include "async/event.hpp"
+#include "address.hpp"
+#include "dma_error.hpp"
+#include "detail/memory_transfer.hpp"
+#include "detail/memory_transfer_operation.hpp"
+#include "drivers/detail/bus_queue.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace drivers::dma
+{
+    /**
+     * Copies and fills memory with the streams of a DMA controller (only
+     * DMA2 can transfer from memory to memory), to offload large copies
+     * from the CPU.
+     *
+     * The data width is the widest that the addresses and the size are
+     * aligned to, and bursts of a full FIFO are used when they are aligned
+     * to 16 bytes. Transfers of more than 65535 items are run in chunks.
+     *
+     * Requests wait in an IntrusiveQueue and run on the first free stream,
+     * in the order they were started, so the engine does not allocate.
+     * Start and stop them from the scheduler.
+     *
+     * @tparam streamIndices The streams owned by the engine
+     */
+    template<class DmaX, std::uint8_t ... streamIndices>
+    class MemoryEngine
+    {
+        static_assert(sizeof...(streamIndices) > 0, "The engine needs at least one stream");
+
+        template<std::uint8_t>
+        using InterruptEvent = const async::EventEmitter &;
+
+        inline static constexpr std::size_t numberOfStreams = sizeof...(streamIndices);
+
+    public:
+        /**
+         * @param interruptEvents The interrupt events of the streams, in
+         *        the order of streamIndices
+         */
+        explicit MemoryEngine(InterruptEvent<streamIndices> ... interruptEvents)
+        : streams_(interruptEvents...)
+        {
+
+        }
+
+        MemoryEngine(const MemoryEngine &) = delete;
+        MemoryEngine(MemoryEngine &&) = delete;
+        MemoryEngine & operator=(const MemoryEngine &) = delete;
+        MemoryEngine & operator=(MemoryEngine &&) = delete;
+
+        /**
+         * Copy size bytes from src to dst. The buffers must not overlap and
+         * must be kept alive until the future completes.
+         *
+         * @return void future
+         */
+        auto copy(void * dst, const void * src, std::size_t size)
+        {
+            return transfer(MemoryAddress(dst), MemoryAddress(src).getAddress(), size, false);
+        }
+
+        /**
+         * Set size bytes at dst to value
+         *
+         * @return void future
+         */
+        auto fill(void * dst, std::uint8_t value, std::size_t size)
+        {
+            // Repeated over a word, the widest item
+            return transfer(MemoryAddress(dst), value * 0x01010101U, size, true);
+        }
+
+    private:
+        template<class, class>
+        friend class detail::MemoryTransferOperation;
+
+        auto transfer(MemoryAddress dst, std::uint32_t src, std::size_t size, bool fill)
+        {
+            return async::makeFuture<void, DmaError>(
+                [this, dst, src, size, fill]<typename R>(R && receiver)
+                    -> detail::MemoryTransferOperation<MemoryEngine, std::remove_cvref_t<R>>
+                {
+                    return {*this, dst.getAddress(), src, static_cast<std::uint32_t>(size), fill, static_cast<R&&>(receiver)};
+                });
+        }
+
+        void enqueue(detail::MemoryTransferNode & node)
+        {
+            queue_.pushBack(node);
+            dispatch();
+        }
+
+        bool remove(detail::MemoryTransferNode & node)
+        {
+            return queue_.remove(node);
+        }
+
+        void release(std::uint8_t stream)
+        {
+            busy_[stream] = false;
+        }
+
+        // Runs the queued requests on the free streams
+        void dispatch()
+        {
+            queue_.dispatch(
+                [this]() { return freeStream() < numberOfStreams; },
+                [this](detail::MemoryTransferNode & node) {
+                    const auto stream = freeStream();
+                    busy_[stream] = true;
+                    node.stream = static_cast<std::uint8_t>(stream);
+                    run(node, std::make_index_sequence<numberOfStreams>{});
+                });
+        }
+
+        std::size_t freeStream() const
+        {
+            std::size_t stream = 0;
+            while (stream < numberOfStreams && busy_[stream])
+            {
+                ++stream;
+            }
+            return stream;
+        }
+
+        template<std::size_t ... Is>
+        void run(detail::MemoryTransferNode & node, std::index_sequence<Is...>)
+        {
+            ((node.stream == Is && (std::get<Is>(streams_).run(node), true)) || ...);
+        }
+
+        std::tuple<detail::MemoryStream<DmaX, streamIndices>...> streams_;
+        std::array<bool, numberOfStreams> busy_ = {};
+        drivers::detail::IntrusiveQueue<detail::MemoryTransferNode> queue_;
+    };
+}
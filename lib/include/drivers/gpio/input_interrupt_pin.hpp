@@ -109,7 +109,10 @@ namespace drivers::gpio
             return reg::read(GpioX{}, board::gpio::IDR::IDR[uint8_c<pinNo>]);
         }
 
-        async::Stream<bool, GpioError> auto whenChanged()
+        /**
+         * @return stream of bool, the level of the pin after each change
+         */
+        auto whenChanged()
         {
             return async::makeStream<bool, GpioError>(
                 [this]<typename R>(R &&receiver)
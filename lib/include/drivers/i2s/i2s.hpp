@@ -5,6 +5,8 @@
 #include "drivers/spi/detail/write_dma.hpp"
 #include "async/event.hpp"
 #include "async/make_future.hpp"
+#include <atomic>
+#include <cstdint>
 
 namespace drivers::i2s
 {
@@ -14,7 +16,11 @@ namespace drivers::i2s
     public:
         explicit I2S(const async::EventEmitter &interruptSource) : interruptSource_(interruptSource) {}
         I2S(const I2S &) = delete;
-        I2S(I2S &&) = default;
+        I2S(I2S &&other)
+        : interruptSource_(other.interruptSource_)
+        , underruns_(other.underruns_.load(std::memory_order_relaxed))
+        {
+        }
         I2S &operator=(const I2S &) = delete;
         I2S &operator=(I2S &&) = delete;
 
@@ -23,42 +29,68 @@ namespace drivers::i2s
          *
          * @param data Array of data to write
          * @param size Array size
-         * @return true on success, false otherwise
+         * @return void future
          */
-        async::Future<void, spi::SpiError> auto write(std::uint16_t *data, std::uint32_t size)
+        auto write(std::uint16_t *data, std::uint32_t size)
         {
             return async::makeFuture<void, spi::SpiError>(
-                [this, data, size]<typename R>(R &&receiver) -> spi::detail::WriteOperation<SpiX, std::uint16_t, spi::detail::WriteOperationType::TX_ONLY_I2S, std::remove_cvref_t<R>>
+                [this, data, size]<typename R>(R &&receiver) -> spi::detail::WriteOperation<SpiX, std::uint16_t, spi::detail::WriteOperationType::TX_ONLY_SPI, std::remove_cvref_t<R>>
                 {
                     return {static_cast<R &&>(receiver), interruptSource_, data, size};
                 });
         }
 
+        /**
+         * Start a double buffered DMA transmission to the peripheral. The
+         * transmission continues until the operation is stopped.
+         *
+         * @param dmaDevice Dma stream on the channel of the peripheral's TX request
+         * @param data The two buffers
+         * @param size Size of each buffer (at most 65535)
+         * @param callback Called with a buffer and its size to fill it, when 
+         *        the DMA is done with it (and for both before the transmission
+         *        starts). Runs from the scheduler at the highest priority.
+         * @return void future, that only completes with an error or when stopped
+         */
         template <dma::DmaLike Dma, std::invocable<std::uint16_t *, std::uint32_t> F>
         async::Future<void, spi::SpiError> auto writeContinuous(
             Dma &dmaDevice, std::uint16_t *data[2], std::uint32_t size, F &&callback)
         {
-            return spi::detail::writeDoubleBufferedDma(SpiX{}, dmaDevice, data, size);
+            return spi::detail::writeDoubleBufferedDma(
+                SpiX{}, dmaDevice, data, static_cast<std::uint16_t>(size), static_cast<F &&>(callback), underruns_);
         }
 
-        /*template<class DmaX, class DmaConfig>
-        bool writeDma(dma::Dma<DmaX, DmaConfig> & dmaDev, std::uint16_t * data, std::uint32_t size);*/
-
         /**
-         * Start a double buffered dma transmission to the peripheral. The transmission will
-         * continue indefinetly.
+         * Start a circular DMA transmission of a single buffer, that is
+         * refilled half by half (on the DMA half transfer and transfer
+         * complete interrupts).
          *
-         * @param dmaDev Dma device to use. Must be configured in memory to peripheral mode and double buffer mode.
-         * @param data Data buffers
-         * @param size Data buffer size
-         * @param callback Callback that is called whenever one of the buffers becomes available. The
-         * empty buffer is passed along with the buffer size.
-         * @return true on success, false otherwise
+         * @param dmaDevice Dma stream on the channel of the peripheral's TX request
+         * @param data The buffer
+         * @param size Size of the buffer, even and at most 65535
+         * @param callback Called with a half of the buffer and the size of 
+         *        the half, see the double buffered writeContinuous
+         * @return void future, that only completes with an error or when stopped
          */
-        /*template<class DmaX, class DmaConfig>
-        bool startWriteStream(dma::Dma<DmaX, DmaConfig> & dmaDev, std::uint16_t * data[2], std::uint32_t size, TransferCompleteCallback && callback);*/
+        template <dma::DmaLike Dma, std::invocable<std::uint16_t *, std::uint32_t> F>
+        async::Future<void, spi::SpiError> auto writeContinuous(
+            Dma &dmaDevice, std::uint16_t *data, std::uint32_t size, F &&callback)
+        {
+            return spi::detail::writeCircularDma(
+                SpiX{}, dmaDevice, data, static_cast<std::uint16_t>(size), static_cast<F &&>(callback), underruns_);
+        }
+
+        /**
+         * Number of buffers that were sent again because they had not been 
+         * refilled in time by a continuous write.
+         */
+        std::uint32_t getUnderrunCount() const
+        {
+            return underruns_.load(std::memory_order_relaxed);
+        }
 
     private:
         async::EventEmitter interruptSource_;
+        std::atomic<std::uint32_t> underruns_ = 0;
     };
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #pragma once
 
 #include "spi/make.hpp"
-#include "spi/spi.hpp"
\ No newline at end of file
+#include "spi/spi.hpp"
+#include "spi/spi_bus.hpp"
\ No newline at end of file
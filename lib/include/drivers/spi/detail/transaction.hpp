@@ -0,0 +1,30 @@
+#pragma once
+#include "../device_config.hpp"
+
+namespace drivers::spi::detail
+{
+    /**
+     * Hooks of a transaction on a SpiBus: applies the device's
+     * configuration and selects the device before the future is started,
+     * and deselects it once the last frame of the future has been sent.
+     */
+    template<class Bus, class CsPin>
+    struct TransactionHooks
+    {
+        void select()
+        {
+            bus_.configure(config_);
+            csPin_.clear();
+        }
+
+        void deselect()
+        {
+            bus_.waitUntilIdle();
+            csPin_.set();
+        }
+
+        Bus & bus_;
+        [[no_unique_address]] CsPin csPin_;
+        DeviceConfig config_;
+    };
+}
@@ -0,0 +1,148 @@
+#pragma once
+#include "async/receiver.hpp"
+#include "async/scheduler.hpp"
+#include "drivers/dma/dma_concepts.hpp"
+#include "drivers/dma/dma_signal.hpp"
+#include "../spi_error.hpp"
+#include "board/regmap/spi.hpp"
+#include "delegate.hpp"
+#include <atomic>
+#include <cstdint>
+
+#include "reg/set.hpp"
+#include "reg/clear.hpp"
+#include "reg/apply.hpp"
+#include "reg/bit_is_set.hpp"
+#include "reg/unchecked_read.hpp"
+
+namespace drivers::spi::detail
+{
+    /**
+     * Full-duplex transfer with one DMA stream writing the data register and
+     * another one reading it. The last word has been clocked in when the RX
+     * stream completes, so that is the only interrupt the operation completes on.
+     */
+    template<class SpiX, class TxTransferFactory, class RxTransferFactory, class R>
+    class TransferDmaOperation
+    {
+        struct TxEventHandler
+        {
+            void operator()(dma::DmaSignal signal)
+            {
+                if (signal == dma::DmaSignal::TRANSFER_ERROR)
+                {
+                    op_.complete({memFn<&TransferDmaOperation::setErrorImpl>, op_});
+                }
+            }
+
+            TransferDmaOperation & op_;
+        };
+
+        struct RxEventHandler
+        {
+            void operator()(dma::DmaSignal signal)
+            {
+                switch (signal)
+                {
+                    case dma::DmaSignal::TRANSFER_COMPLETE:
+                        op_.complete({memFn<&TransferDmaOperation::setValueImpl>, op_});
+                        break;
+                    case dma::DmaSignal::TRANSFER_ERROR:
+                        op_.complete({memFn<&TransferDmaOperation::setErrorImpl>, op_});
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            TransferDmaOperation & op_;
+        };
+
+        using TxTransfer = dma::DmaTransferType<TxTransferFactory, TxEventHandler>;
+        using RxTransfer = dma::DmaTransferType<RxTransferFactory, RxEventHandler>;
+    public:
+        template<class TxTransferFactory2, class RxTransferFactory2, class R2>
+        TransferDmaOperation(
+            TxTransferFactory2 && txTransferFactory,
+            RxTransferFactory2 && rxTransferFactory,
+            R2 && receiver,
+            std::uint16_t size)
+        : txTransfer_(static_cast<TxTransferFactory2&&>(txTransferFactory)(TxEventHandler{*this}))
+        , rxTransfer_(static_cast<RxTransferFactory2&&>(rxTransferFactory)(RxEventHandler{*this}))
+        , receiver_(static_cast<R2&&>(receiver))
+        , size_(size)
+        {
+
+        }
+
+        void start()
+        {
+            if (size_ == 0)
+            {
+                async::setValue(std::move(receiver_));
+                return;
+            }
+
+            // The receiving stream must be ready before the first word is sent
+            if (!rxTransfer_.start())
+            {
+                async::setError(std::move(receiver_), SpiError::BUSY);
+                return;
+            }
+
+            if (!txTransfer_.start())
+            {
+                rxTransfer_.stop();
+                async::setError(std::move(receiver_), SpiError::BUSY);
+                return;
+            }
+
+            // Discard a word left over from a previous operation
+            if (reg::bitIsSet(SpiX{}, board::spi::SR::RXNE))
+            {
+                static_cast<void>(reg::uncheckedRead(SpiX{}, board::spi::DR::_Offset{}));
+            }
+
+            reg::set(SpiX{}, board::spi::CR2::RXDMAEN);
+            reg::set(SpiX{}, board::spi::CR2::TXDMAEN);
+        }
+
+        void stop()
+        {
+            reg::apply(SpiX{},
+                reg::clear(board::spi::CR2::TXDMAEN),
+                reg::clear(board::spi::CR2::RXDMAEN));
+            txTransfer_.stop();
+            rxTransfer_.stop();
+        }
+
+    private:
+        // Called from the DMA interrupts, only the first completion is posted
+        void complete(Delegate<void(void)> completion)
+        {
+            if (!completed_.exchange(true, std::memory_order_acq_rel))
+            {
+                auto & s = async::getScheduler(receiver_);
+                s.postFromISR(completion);
+            }
+        }
+
+        void setValueImpl()
+        {
+            stop();
+            async::setValue(std::move(receiver_));
+        }
+
+        void setErrorImpl()
+        {
+            stop();
+            async::setError(std::move(receiver_), SpiError::DMA_ERROR);
+        }
+
+        TxTransfer txTransfer_;
+        RxTransfer rxTransfer_;
+        R receiver_;
+        std::uint16_t size_;
+        std::atomic<bool> completed_ = false;
+    };
+}
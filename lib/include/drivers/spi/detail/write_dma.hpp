@@ -1,32 +1,67 @@
 #pragma once
 #include <array>
+#include <atomic>
+#include <cstdint>
 #include "async/receiver.hpp"
 #include "async/make_future.hpp"
 #include "async/scheduler.hpp"
+#include "drivers/dma/address.hpp"
 #include "drivers/dma/dma_concepts.hpp"
 #include "drivers/dma/dma_signal.hpp"
+#include "board/regmap/spi.hpp"
 #include "../spi_error.hpp"
 #include "delegate.hpp"
-#include "reg/bit_is_set.hpp"
+#include "reg/set.hpp"
+#include "reg/clear.hpp"
 
 namespace drivers::spi::detail
 {
-    template<class SpiX, class DataType, class TransferFactory, class R, class F>
+    enum class StreamBuffering
+    {
+        // Two buffers, the memory targets of a double buffered DMA transfer
+        DOUBLE_BUFFERED,
+        // One buffer in a circular DMA transfer, refilled half by half
+        HALF_TRANSFER
+    };
+
+    /**
+     * Writes to the peripheral with a DMA transfer that never ends.
+     *
+     * The data is sent from two buffers (or the two halves of one buffer)
+     * in turn. Whenever the DMA is done with one of them, the callback is
+     * posted to refill it, at the highest priority, as it has to complete
+     * before the DMA is done with the other one. Both are filled by the
+     * callback before the transfer starts.
+     *
+     * A refill that has not completed when the DMA moves on to its buffer
+     * is an underrun: the old content is sent again, and the underrun
+     * counter is incremented.
+     */
+    template<class SpiX, class DataType, StreamBuffering buffering, class TransferFactory, class R, class F>
     class WriteDmaOperation
     {
         struct DmaEventHandler
         {
             void operator()(dma::DmaSignal signal)
             {
-                auto & s = async::getScheduler(op_.receiver_);
                 switch (signal)
                 {
+                    case dma::DmaSignal::TRANSFER_HALF_COMPLETE:
+                        op_.bufferSent(0);
+                        break;
                     case dma::DmaSignal::TRANSFER_COMPLETE:
-                        s.postFromISR({memFn<&WriteDmaOperation::fillBuffer0>, op_});
+                        // Double buffered: memory 0 is done, circular: the second half is done
+                        op_.bufferSent(buffering == StreamBuffering::DOUBLE_BUFFERED ? 0 : 1);
                         break;
                     case dma::DmaSignal::TRANSFER_COMPLETE_MEMORY1:
-                        s.postFromISR({memFn<&WriteDmaOperation::fillBuffer1>, op_});
+                        op_.bufferSent(1);
                         break;
+                    case dma::DmaSignal::TRANSFER_ERROR:
+                    {
+                        auto & s = async::getScheduler(op_.receiver_);
+                        s.postFromISR({memFn<&WriteDmaOperation::fail>, op_});
+                        break;
+                    }
                     default:
                         break;
                 }
@@ -37,18 +72,33 @@ namespace drivers::spi::detail
 
         using DmaTransfer = dma::DmaTransferType<TransferFactory, DmaEventHandler>;
     public:
-        template<class TransferFactory2, class R2>
-        WriteDmaOperation(TransferFactory2 && transferFactory, R2 && receiver, DataType * buffer0, DataType * buffer1)
+        template<class TransferFactory2, class R2, class F2>
+        WriteDmaOperation(
+            TransferFactory2 && transferFactory,
+            R2 && receiver,
+            F2 && callback,
+            std::atomic<std::uint32_t> & underruns,
+            DataType * buffer0,
+            DataType * buffer1,
+            std::uint32_t bufferSize)
         : transfer_(static_cast<TransferFactory2&&>(transferFactory)(DmaEventHandler{*this}))
         , receiver_(static_cast<R2&&>(receiver))
-        , buffer0_{buffer0}
-        , buffer1_{buffer1}
+        , callback_(static_cast<F2&&>(callback))
+        , underruns_(underruns)
+        , buffers_{buffer0, buffer1}
+        , bufferSize_(bufferSize)
         {
-            
+
         }
 
+        WriteDmaOperation(const WriteDmaOperation &) = delete;
+        WriteDmaOperation & operator=(const WriteDmaOperation &) = delete;
+
         void start()
         {
+            fillBuffer(0);
+            fillBuffer(1);
+
             if (!transfer_.start())
             {
                 async::setError(std::move(receiver_), SpiError::BUSY);
@@ -60,54 +110,147 @@ namespace drivers::spi::detail
 
         void stop()
         {
-            reg::clear(SpiX{}, board::spi::CR2::TXDMAEN);
-            transfer_.stop();
+            disable();
             async::setDone(std::move(receiver_));
         }
 
     private:
+        // Called from the DMA interrupt, the DMA continues with the other buffer
+        void bufferSent(std::uint8_t index)
+        {
+            if (pending_[1 - index].load(std::memory_order_acquire))
+            {
+                underruns_.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            pending_[index].store(true, std::memory_order_release);
+            auto & s = async::getScheduler(receiver_);
+            if (index == 0)
+            {
+                async::postFromISRWithPriority(s, {memFn<&WriteDmaOperation::fillBuffer0>, *this}, async::highestPriority);
+            }
+            else
+            {
+                async::postFromISRWithPriority(s, {memFn<&WriteDmaOperation::fillBuffer1>, *this}, async::highestPriority);
+            }
+        }
+
         void fillBuffer0()
         {
-            callback_(buffer0_);
+            fillBuffer(0);
         }
 
         void fillBuffer1()
         {
-            callback_(buffer0_);
+            fillBuffer(1);
+        }
+
+        void fillBuffer(std::uint8_t index)
+        {
+            if (!stopped_)
+            {
+                callback_(buffers_[index], bufferSize_);
+            }
+            pending_[index].store(false, std::memory_order_release);
+        }
+
+        void fail()
+        {
+            if (!stopped_)
+            {
+                disable();
+                async::setError(std::move(receiver_), SpiError::DMA_ERROR);
+            }
+        }
+
+        void disable()
+        {
+            stopped_ = true;
+            reg::clear(SpiX{}, board::spi::CR2::TXDMAEN);
+            transfer_.stop();
         }
 
         DmaTransfer transfer_;
         R receiver_;
-        DataType * buffer0_;
-        DataType * buffer1_;
         F callback_;
+        std::atomic<std::uint32_t> & underruns_;
+        std::array<DataType *, 2> buffers_;
+        std::uint32_t bufferSize_;
+        std::array<std::atomic<bool>, 2> pending_ = {};
+        bool stopped_ = false;
     };
 
+    /**
+     * @param data The two buffers
+     * @param size Size of each buffer
+     */
     template<class SpiX, dma::DmaLike Dma, class DataType, class F>
     async::Future<void, SpiError> auto writeDoubleBufferedDma(
-        SpiX spiX, 
-        Dma & dmaDevice, 
-        DataType * data[2], 
-        std::uint32_t size, 
-        F && callback)
+        SpiX spiX,
+        Dma & dmaDevice,
+        DataType * data[2],
+        std::uint16_t size,
+        F && callback,
+        std::atomic<std::uint32_t> & underruns)
     {
         auto transferFactory = dmaDevice.transferDoubleBuffered(
-            dma::MemoryAddressPair(reinterpret_cast<std::uint32_t>(data[0]), reinterpret_cast<std::uint32_t>(data[1])),
+            dma::MemoryAddressPair(dma::MemoryAddress(data[0]).getAddress(), dma::MemoryAddress(data[1]).getAddress()),
             dma::PeripheralAddress(spiX.getAddress(board::spi::DR::_Offset{})),
             size);
 
         using TransferFactoryType = decltype(transferFactory);
         using CallbackType = std::remove_cvref_t<F>;
-        
+
+        return async::makeFuture<void, SpiError>(
+            [=, &underruns, buffer0 = data[0], buffer1 = data[1], callback = static_cast<F&&>(callback)]<typename R>(R && receiver) mutable
+                -> WriteDmaOperation<SpiX, DataType, StreamBuffering::DOUBLE_BUFFERED, TransferFactoryType, std::remove_cvref_t<R>, CallbackType>
+            {
+                return {
+                    std::move(transferFactory),
+                    static_cast<R&&>(receiver),
+                    std::move(callback),
+                    underruns,
+                    buffer0,
+                    buffer1,
+                    size
+                };
+            });
+    }
+
+    /**
+     * @param data The buffer, refilled half by half
+     * @param size Size of the buffer, must be even
+     */
+    template<class SpiX, dma::DmaLike Dma, class DataType, class F>
+    async::Future<void, SpiError> auto writeCircularDma(
+        SpiX spiX,
+        Dma & dmaDevice,
+        DataType * data,
+        std::uint16_t size,
+        F && callback,
+        std::atomic<std::uint32_t> & underruns)
+    {
+        auto transferFactory = dmaDevice.transferCircular(
+            dma::MemoryAddress(data),
+            dma::PeripheralAddress(spiX.getAddress(board::spi::DR::_Offset{})),
+            size);
+
+        using TransferFactoryType = decltype(transferFactory);
+        using CallbackType = std::remove_cvref_t<F>;
+
         return async::makeFuture<void, SpiError>(
-            [=]<typename R>(R && receiver)
-                -> WriteDmaOperation<SpiX, DataType, TransferFactoryType, std::remove_cvref_t<R>, CallbackType>
+            [=, &underruns, callback = static_cast<F&&>(callback)]<typename R>(R && receiver) mutable
+                -> WriteDmaOperation<SpiX, DataType, StreamBuffering::HALF_TRANSFER, TransferFactoryType, std::remove_cvref_t<R>, CallbackType>
             {
                 return {
-                    std::move(transferFactory), 
-                    data[0], 
-                    data[1]
+                    std::move(transferFactory),
+                    static_cast<R&&>(receiver),
+                    std::move(callback),
+                    underruns,
+                    data,
+                    data + size / 2,
+                    size / 2u
                 };
             });
     }
-}
\ No newline at end of file
+}
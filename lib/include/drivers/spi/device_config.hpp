@@ -0,0 +1,37 @@
+#pragma once
+#include "board/regmap/spi.hpp"
+
+namespace drivers::spi
+{
+    enum class BitOrder
+    {
+        LSB_FIRST,
+        MSB_FIRST
+    };
+
+    using DataFrameFormat = board::spi::CR1::DffVal;
+
+    // Clock polarity
+    using ClockPolarity = board::spi::CR1::CpolVal;
+
+    // Clock phase
+    using ClockPhase = board::spi::CR1::CphaVal;
+
+    // The factor that the peripheral clock should be divided by to obtain the SPI baud rate
+    using BaudRateDivider = board::spi::CR1::BrVal;
+
+    /**
+     * The part of the SPI configuration that depends on the device
+     * that is addressed: the SPI mode, data size and clock rate.
+     */
+    struct DeviceConfig
+    {
+        ClockPolarity clockPolarity = ClockPolarity::LOW;
+        ClockPhase clockPhase = ClockPhase::LOW;
+        DataFrameFormat dataFrameFormat = DataFrameFormat::BYTE;
+        BaudRateDivider baudRateDivider = BaudRateDivider::PCKL_DIV2;
+        BitOrder bitOrder = BitOrder::LSB_FIRST;
+
+        constexpr bool operator==(const DeviceConfig &) const = default;
+    };
+}
@@ -5,6 +5,7 @@
 #include "detail/interrupt.hpp"
 
 #include "types.hpp"
+#include "device_config.hpp"
 #include "detail/bus_config.hpp"
 #include "board/regmap/spi.hpp"
 #include "reg/peripheral_operations.hpp"
@@ -19,26 +20,9 @@ namespace drivers::spi
         SLAVE
     };
 
-    enum class BitOrder
-    {
-        LSB_FIRST,
-        MSB_FIRST
-    };
-
-    using DataFrameFormat = board::spi::CR1::DffVal;
-
     // Bus config
     using BusConfig = detail::BusConfig;
 
-    // Clock polarity
-    using ClockPolarity = board::spi::CR1::CpolVal;
-
-    // Clock phase
-    using ClockPhase = board::spi::CR1::CphaVal;
-
-    // The factor that the peripheral clock should be divided by to obtain the SPI baud rate
-    using BaudRateDivider = board::spi::CR1::BrVal;
-
     struct SpiConfig
     {
         std::uint8_t deviceId;
@@ -5,6 +5,8 @@
 #include "detail/bus_config.hpp"
 #include "detail/read.hpp"
 #include "detail/write.hpp"
+#include "detail/transfer_dma.hpp"
+#include "drivers/dma/dma_concepts.hpp"
 
 namespace drivers::spi
 {
@@ -13,11 +15,11 @@ namespace drivers::spi
         template<detail::BusConfig busConfig>
         constexpr detail::WriteOperationType getWriteOpType()
         {
-            if constexpr (busConfig == detail::BusConfig::FullDuplex)
+            if constexpr (busConfig == detail::BusConfig::FULL_DUPLEX)
                 return detail::WriteOperationType::FULL_DUPLEX_SPI;
-            else if constexpr (busConfig == detail::BusConfig::HalfDuplex)
+            else if constexpr (busConfig == detail::BusConfig::HALF_DUPLEX)
                 return detail::WriteOperationType::HALF_DUPLEX_SPI;
-            else if constexpr (busConfig == detail::BusConfig::TxOnly)
+            else if constexpr (busConfig == detail::BusConfig::WRITE_ONLY)
                 return detail::WriteOperationType::TX_ONLY_SPI;
         }
     }
@@ -38,9 +40,9 @@ namespace drivers::spi
          * 
          * @param data Array of data to write
          * @param size Array size
-         * @return void sender
+         * @return void future
          */
-        async::Future<void, SpiError> auto write(const DataType * data, std::uint32_t size)
+        auto write(const DataType * data, std::uint32_t size)
         {
             return async::makeFuture<void, SpiError>(
                 [this, data, size]<typename R>(R && receiver) 
@@ -55,18 +57,52 @@ namespace drivers::spi
          * 
          * @param data Array to store the read data into
          * @param size Array size
-         * @return SenderOf<DataType *, std::uint32_t>
+         * @return void future
          */
-        async::Future<void, SpiError> auto read(DataType * data, std::uint32_t size)
+        auto read(DataType * data, std::uint32_t size)
         {
             return async::makeFuture<void, SpiError>(
-                [=]<typename R>(R && receiver) 
+                [this, data, size]<typename R>(R && receiver) 
                     -> detail::ReadOperation<SpiX, DataType, std::remove_cvref_t<R>>
                 {
                     return {static_cast<R&&>(receiver), interruptSource_, data, size};
                 });
         }
 
+        /**
+         * Write and read data simultaneously using two DMA streams, one on the 
+         * channel of the SPI's TX request and one on the channel of its RX request.
+         * Completes when the last word has been received.
+         * 
+         * @param dmaTx DMA stream that writes the data register
+         * @param dmaRx DMA stream that reads the data register
+         * @param txData Array of data to write
+         * @param rxData Array to store the read data into
+         * @param size Size of both arrays
+         * @return void future
+         */
+        template<dma::DmaLike TxDma, dma::DmaLike RxDma>
+        auto transfer(
+            TxDma & dmaTx, 
+            RxDma & dmaRx, 
+            const DataType * txData, 
+            DataType * rxData, 
+            std::uint16_t size)
+        {
+            auto dataRegister = dma::PeripheralAddress(SpiX{}.getAddress(board::spi::DR::_Offset{}));
+            auto txTransferFactory = dmaTx.transferSingle(dma::MemoryAddress(txData), dataRegister, size);
+            auto rxTransferFactory = dmaRx.transferSingle(dataRegister, dma::MemoryAddress(rxData), size);
+            using TxTransferFactoryType = decltype(txTransferFactory);
+            using RxTransferFactoryType = decltype(rxTransferFactory);
+
+            return async::makeFuture<void, SpiError>(
+                [txTransferFactory, rxTransferFactory, size]<typename R>(R && receiver) mutable
+                    -> detail::TransferDmaOperation<SpiX, TxTransferFactoryType, RxTransferFactoryType, std::remove_cvref_t<R>>
+                {
+                    return {std::move(txTransferFactory), std::move(rxTransferFactory), static_cast<R&&>(receiver), size};
+                });
+        }
+
     private:
         async::EventEmitter interruptSource_;
     };
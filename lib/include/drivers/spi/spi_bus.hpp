@@ -0,0 +1,145 @@
+#pragma once
+#include "async/future.hpp"
+#include "async/make_future.hpp"
+#include "device_config.hpp"
+#include "spi.hpp"
+#include "detail/bus_config.hpp"
+#include "detail/transaction.hpp"
+#include "drivers/detail/bus_queue.hpp"
+#include "board/regmap/spi.hpp"
+#include <type_traits>
+
+#include "reg/set.hpp"
+#include "reg/clear.hpp"
+#include "reg/apply.hpp"
+#include "reg/write.hpp"
+#include "reg/bit_is_set.hpp"
+
+namespace drivers::spi
+{
+    /**
+     * Chip select output of a device, active low (e.g. a gpio::OutputPin)
+     */
+    template<class P>
+    concept ChipSelectPin = requires(P & pin) {
+        pin.set();
+        pin.clear();
+    };
+
+    /**
+     * Shares a SPI peripheral between several devices.
+     *
+     * The transactions of the devices are queued and run back-to-back in
+     * the order they were started. The configuration of the peripheral
+     * is only written when a transaction's device config differs from the
+     * one of the previous transaction. The queue is intrusive (the
+     * transaction operations are its nodes), so the bus does not allocate.
+     *
+     * Transactions must be started and stopped from the scheduler, the
+     * context their futures complete on.
+     */
+    template<class SpiX>
+    class SpiBus
+    {
+    public:
+        SpiBus() = default;
+
+        template<class DataType, detail::BusConfig busConfig>
+        explicit SpiBus(Spi<SpiX, DataType, busConfig> &) { }
+
+        SpiBus(const SpiBus &) = delete;
+        SpiBus(SpiBus &&) = delete;
+        SpiBus & operator=(const SpiBus &) = delete;
+        SpiBus & operator=(SpiBus &&) = delete;
+
+    private:
+        template<class, class>
+        friend struct detail::TransactionHooks;
+
+        template<class, ChipSelectPin>
+        friend class SpiDevice;
+
+        void configure(const DeviceConfig & config)
+        {
+            if (configured_ && config == config_)
+            {
+                return;
+            }
+
+            // The frame format may only be changed while the peripheral is disabled
+            waitUntilIdle();
+            reg::clear(SpiX{}, board::spi::CR1::SPE);
+            reg::apply(SpiX{},
+                reg::write(board::spi::CR1::BR, config.baudRateDivider),
+                reg::write(board::spi::CR1::CPOL, config.clockPolarity),
+                reg::write(board::spi::CR1::CPHA, config.clockPhase),
+                reg::write(board::spi::CR1::DFF, config.dataFrameFormat),
+                reg::write(board::spi::CR1::LSBFIRST, config.bitOrder == BitOrder::LSB_FIRST));
+            reg::set(SpiX{}, board::spi::CR1::SPE);
+
+            config_ = config;
+            configured_ = true;
+        }
+
+        // A future completes when the last frame has been handed to the
+        // peripheral (TXE or the DMA transfer complete), it must still be
+        // shifted out before the device is deselected or SPE is cleared
+        void waitUntilIdle()
+        {
+            while (!reg::bitIsSet(SpiX{}, board::spi::SR::TXE)) { }
+            while (reg::bitIsSet(SpiX{}, board::spi::SR::BSY)) { }
+        }
+
+        drivers::detail::BusQueue<drivers::detail::BusOrder::FIFO> queue_;
+        DeviceConfig config_;
+        bool configured_ = false;
+    };
+
+    template<class SpiX, class DataType, detail::BusConfig busConfig>
+    SpiBus(Spi<SpiX, DataType, busConfig> &) -> SpiBus<SpiX>;
+
+    /**
+     * A device on a shared SPI bus, selected by its chip select pin.
+     */
+    template<class SpiX, ChipSelectPin CsPin>
+    class SpiDevice
+    {
+        using Queue = drivers::detail::BusQueue<drivers::detail::BusOrder::FIFO>;
+        using Hooks = detail::TransactionHooks<SpiBus<SpiX>, CsPin>;
+
+    public:
+        SpiDevice(SpiBus<SpiX> & bus, CsPin csPin, const DeviceConfig & config)
+        : bus_(bus)
+        , csPin_(csPin)
+        , config_(config)
+        {
+            csPin_.set();
+        }
+
+        /**
+         * Run a future (e.g. spi.write(...) or spi.transfer(...)) on the bus
+         * with this device selected. The transaction is queued when it is
+         * started, and completes with the result of the future.
+         *
+         * @param sender Future that accesses the SPI peripheral
+         * @return Future with the value and error type of sender
+         */
+        template<async::AnyFuture S>
+        async::Future<async::future_value_t<std::remove_cvref_t<S>>, async::future_error_t<std::remove_cvref_t<S>>> auto
+            transaction(S && sender)
+        {
+            using Sender = std::remove_cvref_t<S>;
+            return async::makeFuture<async::future_value_t<Sender>, async::future_error_t<Sender>>(
+                [this, sender = static_cast<S&&>(sender)]<typename R>(R && receiver) mutable
+                    -> drivers::detail::BusTransactionOperation<Queue, Hooks, Sender, std::remove_cvref_t<R>>
+                {
+                    return {bus_.queue_, 0, Hooks{bus_, csPin_, config_}, std::move(sender), static_cast<R&&>(receiver)};
+                });
+        }
+
+    private:
+        SpiBus<SpiX> & bus_;
+        [[no_unique_address]] CsPin csPin_;
+        DeviceConfig config_;
+    };
+}
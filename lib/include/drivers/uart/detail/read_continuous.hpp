@@ -0,0 +1,276 @@
+#pragma once
+#include "../uart_error.hpp"
+#include "async/event.hpp"
+#include "async/receiver.hpp"
+#include "async/scheduler.hpp"
+#include "drivers/dma/dma_concepts.hpp"
+#include "drivers/dma/dma_signal.hpp"
+#include "board/regmap/uart.hpp"
+#include "delegate.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <span>
+
+#include "reg/set.hpp"
+#include "reg/clear.hpp"
+#include "reg/apply.hpp"
+#include "reg/read.hpp"
+#include "reg/bit_is_set.hpp"
+
+namespace drivers::uart::detail
+{
+    /**
+     * Receives into a ring buffer with a circular DMA transfer, and emits
+     * the received data as chunks that point into the ring buffer.
+     *
+     * A chunk is emitted on the DMA half transfer and transfer complete
+     * interrupts, and when the USART detects an idle line, so a frame is
+     * delivered as soon as the sender pauses. There are no per-byte interrupts.
+     *
+     * A chunk stays valid until the next value is requested (with next).
+     * If the DMA laps data that has not been released, or the USART
+     * overruns, the stream fails with UartError::OVERRUN.
+     *
+     * The USART and DMA stream interrupts must have the same priority, as
+     * both update the write position.
+     */
+    template<class UartX, class TransferFactory, class R>
+    class ReadContinuousOperation : public async::EventHandlerImpl<ReadContinuousOperation<UartX, TransferFactory, R>>
+    {
+        struct DmaEventHandler
+        {
+            void operator()(dma::DmaSignal signal)
+            {
+                switch (signal)
+                {
+                    case dma::DmaSignal::TRANSFER_HALF_COMPLETE:
+                    case dma::DmaSignal::TRANSFER_COMPLETE:
+                        op_.updateWritePosition();
+                        break;
+                    case dma::DmaSignal::TRANSFER_ERROR:
+                        op_.dmaError_.store(true, std::memory_order_relaxed);
+                        op_.postDataReceived();
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            ReadContinuousOperation & op_;
+        };
+
+        using DmaTransfer = dma::DmaTransferType<TransferFactory, DmaEventHandler>;
+    public:
+        template<class TransferFactory2, class R2>
+        ReadContinuousOperation(
+            TransferFactory2 && transferFactory,
+            R2 && receiver,
+            const async::EventEmitter & interruptEvent,
+            std::uint8_t * buffer,
+            std::uint16_t size)
+        : transfer_(static_cast<TransferFactory2&&>(transferFactory)(DmaEventHandler{*this}))
+        , receiver_(static_cast<R2&&>(receiver))
+        , interruptEvent_(interruptEvent)
+        , buffer_(buffer)
+        , size_(size)
+        {
+
+        }
+
+        void start()
+        {
+            if (!interruptEvent_.subscribe(this))
+            {
+                async::setError(std::move(receiver_), UartError::BUSY);
+                return;
+            }
+
+            if (!transfer_.start())
+            {
+                interruptEvent_.unsubscribe();
+                async::setError(std::move(receiver_), UartError::BUSY);
+                return;
+            }
+
+            // Clear stale idle and overrun flags (read SR, then DR)
+            if (reg::bitIsSet(UartX{}, board::uart::SR::IDLE) || reg::bitIsSet(UartX{}, board::uart::SR::ORE))
+            {
+                static_cast<void>(reg::read(UartX{}, board::uart::DR::DR));
+            }
+
+            reg::apply(UartX{},
+                reg::set(board::uart::CR3::DMAR),
+                reg::set(board::uart::CR3::EIE));
+            reg::apply(UartX{},
+                reg::set(board::uart::CR1::IDLEIE),
+                reg::set(board::uart::CR1::RE));
+        }
+
+        void next()
+        {
+            // The previous chunk is handed back to the DMA
+            consumed_.store(delivered_, std::memory_order_relaxed);
+            ready_ = true;
+            emitPending();
+        }
+
+        // USART interrupt
+        void handleEvent()
+        {
+            bool overrun = reg::bitIsSet(UartX{}, board::uart::SR::ORE);
+            bool idle = reg::bitIsSet(UartX{}, board::uart::SR::IDLE);
+            if (overrun || idle)
+            {
+                // Clears the flags (and noise/framing errors), the data
+                // itself has already been moved by the DMA
+                static_cast<void>(reg::read(UartX{}, board::uart::DR::DR));
+            }
+
+            if (overrun)
+            {
+                overrun_.store(true, std::memory_order_relaxed);
+                postDataReceived();
+            }
+            else if (idle)
+            {
+                updateWritePosition();
+            }
+        }
+
+        void stop()
+        {
+            // The stream may have already failed
+            if (stopped_)
+            {
+                return;
+            }
+
+            disable();
+            async::setDone(std::move(receiver_));
+        }
+
+    private:
+        // Called from the interrupts
+        void updateWritePosition()
+        {
+            std::uint16_t position = static_cast<std::uint16_t>(size_ - transfer_.remaining());
+            if (position == size_)
+            {
+                position = 0;
+            }
+
+            std::uint16_t newBytes = position >= lastPosition_
+                ? position - lastPosition_
+                : size_ - lastPosition_ + position;
+            lastPosition_ = position;
+
+            if (newBytes > 0)
+            {
+                received_.fetch_add(newBytes, std::memory_order_release);
+                postDataReceived();
+            }
+        }
+
+        void postDataReceived()
+        {
+            if (!posted_.exchange(true, std::memory_order_acq_rel))
+            {
+                // When the queue of the scheduler is full, the data is
+                // emitted after a later interrupt
+                auto & s = async::getScheduler(receiver_);
+                if (!s.postFromISR({memFn<&ReadContinuousOperation::onDataReceived>, *this}))
+                {
+                    posted_.store(false, std::memory_order_release);
+                }
+            }
+        }
+
+        // Called from the scheduler
+        void onDataReceived()
+        {
+            posted_.store(false, std::memory_order_release);
+            emitPending();
+        }
+
+        void emitPending()
+        {
+            if (emitting_ || stopped_)
+            {
+                return;
+            }
+
+            emitting_ = true;
+            while (!stopped_)
+            {
+                std::uint32_t received = received_.load(std::memory_order_acquire);
+                if (received - consumed_.load(std::memory_order_relaxed) > size_ ||
+                    overrun_.load(std::memory_order_relaxed))
+                {
+                    fail(UartError::OVERRUN);
+                    break;
+                }
+
+                if (dmaError_.load(std::memory_order_relaxed))
+                {
+                    fail(UartError::DMA_ERROR);
+                    break;
+                }
+
+                std::uint32_t pending = received - delivered_;
+                if (!ready_ || pending == 0)
+                {
+                    break;
+                }
+
+                std::uint16_t index = static_cast<std::uint16_t>(delivered_ % size_);
+                std::uint16_t length = static_cast<std::uint16_t>(
+                    std::min<std::uint32_t>(pending, size_ - index));
+
+                ready_ = false;
+                delivered_ += length;
+                async::setNext(receiver_, std::span<const std::uint8_t>(buffer_ + index, length));
+            }
+            emitting_ = false;
+        }
+
+        void fail(UartError error)
+        {
+            disable();
+            async::setError(std::move(receiver_), error);
+        }
+
+        void disable()
+        {
+            stopped_ = true;
+            reg::apply(UartX{},
+                reg::clear(board::uart::CR1::IDLEIE),
+                reg::clear(board::uart::CR1::RE));
+            reg::apply(UartX{},
+                reg::clear(board::uart::CR3::DMAR),
+                reg::clear(board::uart::CR3::EIE));
+            transfer_.stop();
+            interruptEvent_.unsubscribe();
+        }
+
+        DmaTransfer transfer_;
+        R receiver_;
+        async::EventEmitter interruptEvent_;
+        std::uint8_t * buffer_;
+        std::uint16_t size_;
+
+        // Written by the interrupts
+        std::uint16_t lastPosition_ = 0;
+        std::atomic<std::uint32_t> received_ = 0;
+        std::atomic<bool> overrun_ = false;
+        std::atomic<bool> dmaError_ = false;
+        std::atomic<bool> posted_ = false;
+
+        // Written by the scheduler
+        std::atomic<std::uint32_t> consumed_ = 0;
+        std::uint32_t delivered_ = 0;
+        bool ready_ = true;
+        bool emitting_ = false;
+        bool stopped_ = false;
+    };
+}
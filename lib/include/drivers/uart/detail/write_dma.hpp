@@ -0,0 +1,102 @@
+#pragma once
+#include "../uart_error.hpp"
+#include "async/receiver.hpp"
+#include "async/scheduler.hpp"
+#include "drivers/dma/dma_concepts.hpp"
+#include "drivers/dma/dma_signal.hpp"
+#include "board/regmap/uart.hpp"
+#include "delegate.hpp"
+
+#include "reg/set.hpp"
+#include "reg/clear.hpp"
+
+namespace drivers::uart::detail
+{
+    /**
+     * Writes a buffer through a DMA stream. The only interrupt is the DMA
+     * transfer complete (or transfer error), so the value is set as soon as 
+     * the last byte has been moved to the data register. The byte may thus 
+     * still be shifted out when the receiver is notified.
+     */
+    template<class UartX, class TransferFactory, class R>
+    class WriteDmaOperation
+    {
+        struct DmaEventHandler
+        {
+            void operator()(dma::DmaSignal signal)
+            {
+                switch (signal)
+                {
+                    case dma::DmaSignal::TRANSFER_COMPLETE:
+                        op_.postCompletion({memFn<&WriteDmaOperation::setValueImpl>, op_});
+                        break;
+                    case dma::DmaSignal::TRANSFER_ERROR:
+                        op_.postCompletion({memFn<&WriteDmaOperation::setErrorImpl>, op_});
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            WriteDmaOperation & op_;
+        };
+
+        using DmaTransfer = dma::DmaTransferType<TransferFactory, DmaEventHandler>;
+    public:
+        template<class TransferFactory2, class R2>
+        WriteDmaOperation(TransferFactory2 && transferFactory, R2 && receiver, std::uint16_t size)
+        : transfer_(static_cast<TransferFactory2&&>(transferFactory)(DmaEventHandler{*this}))
+        , receiver_(static_cast<R2&&>(receiver))
+        , size_(size)
+        {
+
+        }
+
+        void start()
+        {
+            if (size_ == 0)
+            {
+                async::setValue(std::move(receiver_));
+                return;
+            }
+
+            if (!transfer_.start())
+            {
+                async::setError(std::move(receiver_), UartError::BUSY);
+                return;
+            }
+
+            reg::clear(UartX{}, board::uart::SR::TC);
+            reg::set(UartX{}, board::uart::CR3::DMAT);
+        }
+
+        void stop()
+        {
+            reg::clear(UartX{}, board::uart::CR3::DMAT);
+            transfer_.stop();
+        }
+
+    private:
+        void postCompletion(Delegate<void(void)> completion)
+        {
+            auto & s = async::getScheduler(receiver_);
+            s.postFromISR(completion);
+        }
+
+        void setValueImpl()
+        {
+            stop();
+            async::setValue(std::move(receiver_));
+        }
+
+        void setErrorImpl()
+        {
+            stop();
+            async::setError(std::move(receiver_), UartError::DMA_ERROR);
+        }
+
+        DmaTransfer transfer_;
+        R receiver_;
+        std::uint16_t size_;
+    };
+}
\ No newline at end of file
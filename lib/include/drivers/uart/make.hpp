@@ -121,7 +121,7 @@ namespace drivers::uart
                 .pullUpDown = gpio::PuPd::PULL_UP
             }>(board);
             gpio::makeAltFnPin<gpio::AltFnPinConfig {
-                .pin = config.txPin,
+                .pin = config.rxPin,
                 .altFn = config.id.value < 3 ? gpio::AltFn::USART1_3 : gpio::AltFn::USART4_6
             }>(board);
 
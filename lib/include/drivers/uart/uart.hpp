@@ -4,6 +4,10 @@
 #include "uart_error.hpp"
 #include "async/make_future.hpp"
 #include "detail/write.hpp"
+#include "detail/write_dma.hpp"
+#include "detail/read_continuous.hpp"
+#include "async/make_stream.hpp"
+#include "drivers/dma/dma_concepts.hpp"
 
 namespace drivers::uart
 {   
@@ -27,9 +31,9 @@ namespace drivers::uart
          * 
          * @param data Array of data to write
          * @param size Array size
-         * @return void sender
+         * @return void future
          */
-        async::Future<void, UartError> auto write(const std::uint8_t * data, std::uint32_t size)
+        auto write(const std::uint8_t * data, std::uint32_t size)
         {
             return async::makeFuture<void, UartError>(
                 [this, data, size]<typename R>(R && receiver) mutable
@@ -38,6 +42,66 @@ namespace drivers::uart
                     return { static_cast<R&&>(receiver), interruptSource_, data, size };
                 });
         }
+
+        /**
+         * Write data to the peripheral using a DMA stream. The stream must be
+         * configured for byte transfers on the channel of the UART's TX request.
+         * 
+         * @param dmaDevice DMA stream to use for the transfer
+         * @param data Array of data to write, must be kept alive until the write completes
+         * @param size Array size
+         * @return void future
+         */
+        template<dma::DmaLike Dma>
+        auto writeDma(Dma & dmaDevice, const std::uint8_t * data, std::uint16_t size)
+        {
+            auto transferFactory = dmaDevice.transferSingle(
+                dma::MemoryAddress(data),
+                dma::PeripheralAddress(UartX{}.getAddress(board::uart::DR::_Offset{})),
+                size);
+            using TransferFactoryType = decltype(transferFactory);
+
+            return async::makeFuture<void, UartError>(
+                [transferFactory, size]<typename R>(R && receiver) mutable
+                    -> detail::WriteDmaOperation<UartX, TransferFactoryType, std::remove_cvref_t<R>>
+                {
+                    return {std::move(transferFactory), static_cast<R&&>(receiver), size};
+                });
+        }
+
+        /**
+         * Receive continuously into a ring buffer using a circular DMA transfer. 
+         * The stream must be configured for byte transfers on the channel of the 
+         * UART's RX request.
+         * 
+         * Emits the received data as chunks pointing into the ring buffer, 
+         * when half of the buffer has been filled, when the end of the buffer is 
+         * reached and when the line becomes idle. A chunk may be used until the 
+         * next chunk is requested. Uses the UART interrupt, so interrupt driven 
+         * writes are rejected while receiving (use writeDma instead).
+         * 
+         * @param dmaDevice DMA stream to use for the transfer
+         * @param buffer Ring buffer, must be kept alive while the stream is running
+         * @param size Ring buffer size
+         * @return stream of std::span<const std::uint8_t>
+         */
+        template<dma::DmaLike Dma>
+        auto readContinuous(
+            Dma & dmaDevice, std::uint8_t * buffer, std::uint16_t size)
+        {
+            auto transferFactory = dmaDevice.transferCircular(
+                dma::PeripheralAddress(UartX{}.getAddress(board::uart::DR::_Offset{})),
+                dma::MemoryAddress(buffer),
+                size);
+            using TransferFactoryType = decltype(transferFactory);
+
+            return async::makeStream<std::span<const std::uint8_t>, UartError>(
+                [this, transferFactory, buffer, size]<typename R>(R && receiver) mutable
+                    -> detail::ReadContinuousOperation<UartX, TransferFactoryType, std::remove_cvref_t<R>>
+                {
+                    return {std::move(transferFactory), static_cast<R&&>(receiver), interruptSource_, buffer, size};
+                });
+        }
     private:
         async::EventEmitter interruptSource_;
     };
@@ -4,6 +4,8 @@ namespace drivers::uart
 {
     enum class UartError
     {
-        BUSY
+        BUSY,
+        DMA_ERROR,
+        OVERRUN
     };
 }
\ No newline at end of file
@@ -16,6 +16,7 @@
 #include "async/conditional.hpp"
 #include "async/repeat.hpp"
 #include "async/just.hpp"
+#include "async/map.hpp"
 
 namespace drivers
 {
@@ -76,34 +77,20 @@ namespace drivers
         async::Future<vl6180::DeviceIdentification, i2c::I2cError> auto getDeviceIdentification()
         {
             using namespace vl6180::regmap;
-            return async::useState(
-                vl6180::DeviceIdentification{},
-                [this](auto & deviceIdentification) {
-                    return async::sequence(
-                        reg::read(device_, MODEL_ID::MODEL_ID)
-                        | async::transform([&](auto modelId) {
-                            deviceIdentification.modelId = modelId;
-                        }),
-
-                        reg::apply(device_, 
-                            reg::read(MODEL_REV::MINOR),
-                            reg::read(MODEL_REV::MAJOR))
-                        | async::transform([&](auto modelMinorVersion, auto modelMajorVersion) {
-                            deviceIdentification.modelRevision.minor = modelMinorVersion;
-                            deviceIdentification.modelRevision.major = modelMajorVersion;
-                        }),
-
-                        reg::apply(device_, 
-                            reg::read(MODULE_REV::MINOR),
-                            reg::read(MODULE_REV::MAJOR))
-                        | async::transform([&](auto moduleMinorVersion, auto moduleMajorVersion) {
-                            deviceIdentification.moduleRevision.minor = moduleMinorVersion;
-                            deviceIdentification.moduleRevision.major = moduleMajorVersion;
-                        })
-                    ) 
-                    | async::transform([&]() {
-                        return deviceIdentification;
-                    });
+            // The identification registers are adjacent, read them in one transaction
+            return 
+                device_.readBlock(
+                    reg::read(MODEL_ID::MODEL_ID),
+                    reg::read(MODEL_REV::MINOR),
+                    reg::read(MODEL_REV::MAJOR),
+                    reg::read(MODULE_REV::MINOR),
+                    reg::read(MODULE_REV::MAJOR))
+                | async::map([](auto values) {
+                    auto [modelId, modelMinor, modelMajor, moduleMinor, moduleMajor] = values;
+                    return vl6180::DeviceIdentification{
+                        static_cast<std::uint8_t>(modelId),
+                        {static_cast<std::uint8_t>(modelMajor), static_cast<std::uint8_t>(modelMinor)},
+                        {static_cast<std::uint8_t>(moduleMajor), static_cast<std::uint8_t>(moduleMinor)}};
                 });
         }
 
@@ -0,0 +1,167 @@
+#pragma once
+#include "delegate.hpp"
+#include <concepts>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+template<class F, std::size_t capacity = 2 * sizeof(void *)>
+class InplaceDelegate;
+
+/**
+ * Delegate that stores small function objects in place, instead of
+ * referring to a function object that has to be kept alive elsewhere.
+ *
+ * Function objects (e.g. lambdas) are copied into an inline buffer of
+ * `capacity` bytes. They must be trivially copyable, so that the delegate
+ * itself stays trivially copyable, and must fit into the buffer (checked
+ * at compile time). Nothing is ever allocated.
+ *
+ * Function pointers, member function pointers and pointers to function
+ * objects are supported as for Delegate.
+ */
+template<class R, class ... Args, std::size_t capacity>
+class InplaceDelegate<R(Args...), capacity>
+{
+    static_assert(capacity >= sizeof(void *), "The capacity must fit at least a pointer");
+
+    using FunctionType = R (*)(void *, Args...);
+
+    // Stores an object pointer and a compile-time bound member function
+    template<class T>
+    struct BoundObject
+    {
+        T * object;
+    };
+
+public:
+    constexpr InplaceDelegate() = default;
+
+    /**
+     * Construct from a function pointer (compile-time)
+     */
+    template<R(*ptr)(Args...)>
+    constexpr InplaceDelegate(detail::Fn<R(*)(Args...), ptr>)
+    : function_(callFunctionPointer<ptr>)
+    {
+
+    }
+
+    /**
+     * Construct from a member function pointer (compile-time)
+     */
+    template<class T, R(T::*ptr)(Args...)>
+    InplaceDelegate(detail::MemFn<R(T::*)(Args...), ptr>, T & object)
+    : function_(callMemberFunctionPointer<T, ptr>)
+    {
+        store(BoundObject<T>{&object});
+    }
+
+    /**
+     * Construct from a const member function pointer (compile-time)
+     */
+    template<class T, R(T::*ptr)(Args...) const>
+    InplaceDelegate(detail::MemFn<R(T::*)(Args...) const, ptr>, T & object)
+    : function_(callConstMemberFunctionPointer<T, ptr>)
+    {
+        store(BoundObject<T>{&object});
+    }
+
+    /**
+     * Construct from a pointer to a function object, which must outlive the delegate
+     */
+    template<class F>
+        requires (std::invocable<F, Args...> && !std::same_as<std::decay_t<F>, InplaceDelegate>)
+    InplaceDelegate(F * f)
+    : function_(callFunctionObjectPointer<F>)
+    {
+        store(f);
+    }
+
+    /**
+     * Construct from a function object, which is stored in place
+     */
+    template<class F>
+        requires (
+            std::invocable<std::decay_t<F> &, Args...> &&
+            !std::is_pointer_v<std::decay_t<F>> &&
+            !std::same_as<std::decay_t<F>, InplaceDelegate>)
+    InplaceDelegate(F && f)
+    : function_(callFunctionObject<std::decay_t<F>>)
+    {
+        using Stored = std::decay_t<F>;
+        static_assert(sizeof(Stored) <= capacity, "The function object does not fit into the delegate, increase the capacity");
+        static_assert(alignof(Stored) <= alignof(std::max_align_t), "The function object is over-aligned");
+        static_assert(std::is_trivially_copyable_v<Stored>, "Only trivially copyable function objects can be stored in place");
+        store(Stored(static_cast<F&&>(f)));
+    }
+
+    void reset()
+    {
+        function_ = nullptr;
+    }
+
+    constexpr operator bool() const
+    {
+        return function_ != nullptr;
+    }
+
+    R operator()(Args ... args) const
+    {
+        return function_(storage_, static_cast<Args&&>(args)...);
+    }
+
+private:
+    template<class T>
+    void store(const T & value)
+    {
+        ::new (static_cast<void *>(storage_)) T(value);
+    }
+
+    template<class F>
+    static R callFunctionObject(void * storage, Args... args)
+    {
+        F & f = *std::launder(static_cast<F *>(storage));
+        return f(static_cast<Args&&>(args)...);
+    }
+
+    template<class F>
+    static R callFunctionObjectPointer(void * storage, Args... args)
+    {
+        F * f = *std::launder(static_cast<F **>(storage));
+        return (*f)(static_cast<Args&&>(args)...);
+    }
+
+    template<R(*functionPointer)(Args...)>
+    static constexpr R callFunctionPointer(void *, Args... args)
+    {
+        return functionPointer(static_cast<Args&&>(args)...);
+    }
+
+    template<class T, R(T::*ptr)(Args...)>
+    static R callMemberFunctionPointer(void * storage, Args... args)
+    {
+        T * obj = std::launder(static_cast<BoundObject<T> *>(storage))->object;
+        return (obj->*ptr)(static_cast<Args&&>(args)...);
+    }
+
+    template<class T, R(T::*ptr)(Args...) const>
+    static R callConstMemberFunctionPointer(void * storage, Args... args)
+    {
+        T * obj = std::launder(static_cast<BoundObject<T> *>(storage))->object;
+        return (obj->*ptr)(static_cast<Args&&>(args)...);
+    }
+
+    FunctionType function_ = nullptr;
+    alignas(std::max_align_t) mutable std::byte storage_[capacity] = {};
+};
+
+// Template deduction guides
+template<class T, auto ptr, class R, class ... Args>
+InplaceDelegate(detail::MemFn<R(T::*)(Args...), ptr> memberFunction, T & object) -> InplaceDelegate<R(Args...)>;
+
+template<class T, auto ptr, class R, class ... Args>
+InplaceDelegate(detail::MemFn<R(T::*)(Args...) const, ptr> memberFunction, const T & object) -> InplaceDelegate<R(Args...)>;
+
+template<auto ptr, class R, class ... Args>
+InplaceDelegate(detail::Fn<R(*)(Args...), ptr>) -> InplaceDelegate<R(Args...)>;
@@ -0,0 +1,146 @@
+#pragma once
+#include "format.hpp"
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace logging
+{
+    /**
+     * Turns the records written by a Logger back into text. Intended for
+     * the host, e.g. in a tool that reads the UART.
+     *
+     * The decoder must know all format strings used by the target, as
+     * only their ids are transmitted.
+     */
+    class LogDecoder
+    {
+    public:
+        LogDecoder(std::initializer_list<std::string_view> formats)
+        {
+            for (auto format : formats)
+            {
+                addFormat(format);
+            }
+        }
+
+        void addFormat(std::string_view format)
+        {
+            formats_[formatId(format)] = format;
+        }
+
+        /**
+         * Decode the complete records in data, and append them to output
+         * (one line per record).
+         *
+         * @return The number of bytes consumed. A trailing incomplete record
+         * is not consumed, and should be passed again when more data is available.
+         */
+        std::size_t decode(std::span<const std::uint8_t> data, std::string & output) const
+        {
+            std::size_t position = 0;
+            while (data.size() - position >= headerSize)
+            {
+                std::uint32_t id = readWord(data, position);
+                std::uint8_t numberOfArgs = data[position + 4U];
+                std::size_t recordSize = headerSize + 4U * numberOfArgs;
+                if (data.size() - position < recordSize)
+                {
+                    break;
+                }
+
+                std::uint32_t args[255];
+                for (std::uint8_t i = 0; i < numberOfArgs; ++i)
+                {
+                    args[i] = readWord(data, position + headerSize + 4U * i);
+                }
+
+                formatRecord(id, std::span<const std::uint32_t>(args, numberOfArgs), output);
+                output += '\n';
+                position += recordSize;
+            }
+            return position;
+        }
+
+    private:
+        static constexpr std::size_t headerSize = 5U;
+
+        static std::uint32_t readWord(std::span<const std::uint8_t> data, std::size_t position)
+        {
+            return static_cast<std::uint32_t>(data[position])
+                | (static_cast<std::uint32_t>(data[position + 1U]) << 8)
+                | (static_cast<std::uint32_t>(data[position + 2U]) << 16)
+                | (static_cast<std::uint32_t>(data[position + 3U]) << 24);
+        }
+
+        void formatRecord(std::uint32_t id, std::span<const std::uint32_t> args, std::string & output) const
+        {
+            char text[64];
+            if (id == droppedRecordsId && args.size() == 1U)
+            {
+                std::snprintf(text, sizeof(text), "<%u log records dropped>", static_cast<unsigned>(args[0]));
+                output += text;
+                return;
+            }
+
+            auto it = formats_.find(id);
+            if (it == formats_.end())
+            {
+                std::snprintf(text, sizeof(text), "<unknown format 0x%08x>", static_cast<unsigned>(id));
+                output += text;
+                return;
+            }
+
+            std::string_view format = it->second;
+            std::size_t nextArg = 0;
+            for (std::size_t i = 0; i < format.size(); ++i)
+            {
+                if (format[i] != '%')
+                {
+                    output += format[i];
+                    continue;
+                }
+
+                if (i + 1U < format.size() && format[i + 1U] == '%')
+                {
+                    output += '%';
+                    ++i;
+                    continue;
+                }
+
+                std::size_t end = detail::findConversionEnd(format, i);
+                if (end == std::string_view::npos || nextArg >= args.size())
+                {
+                    output += "<invalid format>";
+                    return;
+                }
+
+                // Format the conversion on its own
+                std::string specification(format.substr(i, end - i + 1U));
+                std::uint32_t word = args[nextArg++];
+                switch (format[end])
+                {
+                    case 'd':
+                    case 'i':
+                        std::snprintf(text, sizeof(text), specification.c_str(), static_cast<int>(static_cast<std::int32_t>(word)));
+                        break;
+                    case 'f':
+                        std::snprintf(text, sizeof(text), specification.c_str(), static_cast<double>(std::bit_cast<float>(word)));
+                        break;
+                    default:
+                        std::snprintf(text, sizeof(text), specification.c_str(), static_cast<unsigned>(word));
+                        break;
+                }
+                output += text;
+                i = end;
+            }
+        }
+
+        std::unordered_map<std::uint32_t, std::string_view> formats_;
+    };
+}
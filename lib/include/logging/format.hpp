@@ -0,0 +1,146 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+namespace logging
+{
+    /**
+     * Format string that can be passed as a template argument,
+     * e.g. logger.log<"adc overrun at %u">(position).
+     *
+     * Supported conversions are d, i, u, x, X, o, c and f, with optional
+     * flags, width and precision. Length modifiers are not supported, all
+     * arguments are transferred as 32 bit words.
+     */
+    template<std::size_t N>
+    struct FormatString
+    {
+        consteval FormatString(const char (&str)[N])
+        {
+            std::copy_n(str, N, value);
+        }
+
+        constexpr std::string_view view() const
+        {
+            return {value, N - 1U};
+        }
+
+        char value[N];
+    };
+
+    // Format id of the record that reports the number of dropped records
+    inline constexpr std::uint32_t droppedRecordsId = 0U;
+
+    /**
+     * Id of a format string (32 bit FNV-1a hash). Never equal to droppedRecordsId.
+     */
+    constexpr std::uint32_t formatId(std::string_view format)
+    {
+        std::uint32_t hash = 2166136261U;
+        for (char c : format)
+        {
+            hash = (hash ^ static_cast<std::uint8_t>(c)) * 16777619U;
+        }
+        return hash == droppedRecordsId ? 1U : hash;
+    }
+
+    namespace detail
+    {
+        constexpr bool isConversion(char c)
+        {
+            return std::string_view("diuxXocf").find(c) != std::string_view::npos;
+        }
+
+        constexpr bool isFlag(char c)
+        {
+            return std::string_view("-+ #0").find(c) != std::string_view::npos;
+        }
+
+        constexpr bool isDigit(char c)
+        {
+            return c >= '0' && c <= '9';
+        }
+
+        /**
+         * Find the end of the conversion specification that starts
+         * (with a '%') at position. Returns npos if it is invalid.
+         */
+        constexpr std::size_t findConversionEnd(std::string_view format, std::size_t position)
+        {
+            std::size_t i = position + 1U;
+            while (i < format.size() && isFlag(format[i])) ++i;
+            while (i < format.size() && isDigit(format[i])) ++i;
+            if (i < format.size() && format[i] == '.')
+            {
+                ++i;
+                while (i < format.size() && isDigit(format[i])) ++i;
+            }
+            return (i < format.size() && isConversion(format[i])) ? i : std::string_view::npos;
+        }
+
+        /**
+         * Number of arguments expected by a format string, or -1 if the
+         * format string contains an unsupported conversion.
+         */
+        constexpr int countArguments(std::string_view format)
+        {
+            int count = 0;
+            for (std::size_t i = 0; i < format.size(); ++i)
+            {
+                if (format[i] != '%')
+                {
+                    continue;
+                }
+
+                if (i + 1U < format.size() && format[i + 1U] == '%')
+                {
+                    ++i;
+                    continue;
+                }
+
+                i = findConversionEnd(format, i);
+                if (i == std::string_view::npos)
+                {
+                    return -1;
+                }
+                ++count;
+            }
+            return count;
+        }
+    }
+
+    template<class T>
+    concept LogArgument =
+        ((std::integral<T> || std::is_enum_v<T>) && sizeof(T) <= sizeof(std::uint32_t)) ||
+        std::same_as<T, float>;
+
+    /**
+     * Encode a log argument as a 32 bit word. Signed values are sign
+     * extended and floats are stored by their bit pattern.
+     */
+    template<LogArgument T>
+    constexpr std::uint32_t toWord(T value)
+    {
+        if constexpr (std::same_as<T, float>)
+        {
+            return std::bit_cast<std::uint32_t>(value);
+        }
+        else if constexpr (std::is_enum_v<T>)
+        {
+            return toWord(static_cast<std::underlying_type_t<T>>(value));
+        }
+        else if constexpr (std::is_signed_v<T>)
+        {
+            return static_cast<std::uint32_t>(static_cast<std::int32_t>(value));
+        }
+        else
+        {
+            return static_cast<std::uint32_t>(value);
+        }
+    }
+}
@@ -0,0 +1,300 @@
+#pragma once
+#include "format.hpp"
+#include "async/future.hpp"
+#include "async/receiver.hpp"
+#include "async/scheduler.hpp"
+#include "cont/box.hpp"
+#include "cont/mpsc_queue.hpp"
+#include "delegate.hpp"
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <type_traits>
+
+namespace logging
+{
+    /**
+     * A log call, as stored in the logger's queue
+     */
+    template<std::uint8_t MaxArgs>
+    struct LogRecord
+    {
+        std::uint32_t formatId;
+        std::uint8_t numberOfArgs;
+        std::uint32_t args[MaxArgs];
+    };
+
+    /**
+     * Writes a buffer, e.g. [&](const std::uint8_t * data, std::uint16_t size) {
+     * return uart.writeDma(dmaStream, data, size); }
+     */
+    template<class W>
+    concept LogWriter = requires(W & writer, const std::uint8_t * data, std::uint16_t size) {
+        { writer(data, size) } -> async::AnyFuture;
+    };
+
+    /**
+     * Logger with deferred formatting.
+     *
+     * A log call only stores the id of the format string and the arguments
+     * in a lock-free queue, so it can be used from any context, including
+     * interrupt handlers. The records are encoded into a transmit buffer
+     * and written by a task that is posted to the scheduler (without a
+     * priority, so to the lowest priority lane). The text is produced on
+     * the host by a LogDecoder.
+     *
+     * Records that do not fit into the queue are dropped. The number of
+     * dropped records is reported at the start of the next batch.
+     *
+     * The encoding of a record is the format id (4 bytes, little endian),
+     * the number of arguments (1 byte) and the arguments (4 bytes each,
+     * little endian).
+     *
+     * @tparam Scheduler Scheduler that runs the write task
+     * @tparam Writer Function that starts a write, see LogWriter
+     * @tparam NRecords Capacity of the record queue, must be a power of two
+     * @tparam NTxBytes Size of the transmit buffer
+     * @tparam MaxArgs Maximum number of arguments of a log call
+     */
+    template<
+        async::Scheduler Scheduler,
+        LogWriter Writer,
+        std::uint32_t NRecords = 64U,
+        std::uint16_t NTxBytes = 256U,
+        std::uint8_t MaxArgs = 4U>
+    class Logger
+    {
+        using Record = LogRecord<MaxArgs>;
+
+        static constexpr std::uint16_t headerSize = 5U;
+        static constexpr std::uint16_t maxRecordSize = headerSize + 4U * MaxArgs;
+        static_assert(NTxBytes >= maxRecordSize, "The transmit buffer must fit a record with MaxArgs arguments");
+
+        class WriteReceiver
+        {
+        public:
+            explicit WriteReceiver(Logger & logger) : logger_(logger) { }
+
+            template<class ... Values>
+            void setValue(Values && ...) &&
+            {
+                logger_.writeCompleted(true);
+            }
+
+            template<class E>
+            void setError(E &&) &&
+            {
+                logger_.writeCompleted(false);
+            }
+
+            void setDone() &&
+            {
+                logger_.writeCompleted(false);
+            }
+
+        private:
+            friend Scheduler & tag_invoke(async::getScheduler_t, const WriteReceiver & self)
+            {
+                return self.logger_.scheduler_;
+            }
+
+            Logger & logger_;
+        };
+
+        using WriteOperation = async::connect_result_t<
+            std::invoke_result_t<Writer &, const std::uint8_t *, std::uint16_t>,
+            WriteReceiver>;
+
+    public:
+        template<class Writer2>
+        Logger(Scheduler & scheduler, Writer2 && writer)
+        : scheduler_(scheduler)
+        , writer_(static_cast<Writer2&&>(writer))
+        {
+
+        }
+
+        ~Logger()
+        {
+            if (hasWriteOperation_)
+            {
+                writeOperation_.destruct();
+            }
+        }
+
+        Logger(const Logger &) = delete;
+        Logger(Logger &&) = delete;
+        Logger & operator=(const Logger &) = delete;
+        Logger & operator=(Logger &&) = delete;
+
+        /**
+         * Log a message. Safe to call from any context.
+         *
+         * @return false if the record was dropped because the queue is full
+         */
+        template<FormatString format, LogArgument ... Args>
+        bool log(Args ... args)
+        {
+            static_assert(detail::countArguments(format.view()) >= 0, "Unsupported conversion in the format string");
+            static_assert(detail::countArguments(format.view()) == sizeof...(Args), "The number of arguments does not match the format string");
+            static_assert(sizeof...(Args) <= MaxArgs, "Too many arguments, increase MaxArgs");
+            constexpr std::uint32_t id = formatId(format.view());
+
+            if (!records_.push(Record{id, sizeof...(Args), {toWord(args)...}}))
+            {
+                dropped_.fetch_add(1U, std::memory_order_relaxed);
+                return false;
+            }
+
+            postWrite();
+            return true;
+        }
+
+        /**
+         * Number of write operations that failed. The records of a
+         * failed write are lost.
+         */
+        std::uint32_t getWriteErrors() const
+        {
+            return writeErrors_;
+        }
+
+    private:
+        void postWrite()
+        {
+            // Only read the flag in the common case that a write is posted already
+            if (!writePosted_.load(std::memory_order_relaxed) &&
+                !writePosted_.exchange(true, std::memory_order_acq_rel))
+            {
+                // When the queue of the scheduler is full, the next
+                // record posts the write again
+                if (!scheduler_.postFromISR({memFn<&Logger::write>, *this}))
+                {
+                    writePosted_.store(false, std::memory_order_release);
+                }
+            }
+        }
+
+        // Runs on the scheduler
+        void write()
+        {
+            writePosted_.store(false, std::memory_order_release);
+            if (writing_)
+            {
+                // Written once the current write has completed
+                return;
+            }
+
+            if (hasWriteOperation_)
+            {
+                writeOperation_.destruct();
+                hasWriteOperation_ = false;
+            }
+
+            std::uint16_t size = fillTxBuffer();
+            if (size == 0U)
+            {
+                return;
+            }
+
+            writing_ = true;
+            hasWriteOperation_ = true;
+            auto & operation = writeOperation_.constructWith([this, size]() {
+                return async::connect(writer_(txBuffer_.data(), size), WriteReceiver{*this});
+            });
+            async::start(operation);
+        }
+
+        void writeCompleted(bool success)
+        {
+            writing_ = false;
+            if (!success)
+            {
+                ++writeErrors_;
+            }
+
+            // The records still queued are written after a failed write too
+            if (hasPendingRecord_ || !records_.isEmpty() || dropped_.load(std::memory_order_relaxed) > 0U)
+            {
+                postWrite();
+            }
+        }
+
+        std::uint16_t fillTxBuffer()
+        {
+            std::uint16_t size = 0U;
+
+            std::uint32_t dropped = dropped_.exchange(0U, std::memory_order_relaxed);
+            if (dropped > 0U)
+            {
+                std::uint32_t args[1] = {dropped};
+                size = encode(size, droppedRecordsId, 1U, args);
+            }
+
+            for (;;)
+            {
+                if (!hasPendingRecord_)
+                {
+                    if (!records_.pop(pendingRecord_))
+                    {
+                        break;
+                    }
+                    hasPendingRecord_ = true;
+                }
+
+                std::uint16_t recordSize = headerSize + 4U * pendingRecord_.numberOfArgs;
+                if (size + recordSize > NTxBytes)
+                {
+                    // Written in the next batch
+                    break;
+                }
+
+                size = encode(size, pendingRecord_.formatId, pendingRecord_.numberOfArgs, pendingRecord_.args);
+                hasPendingRecord_ = false;
+            }
+
+            return size;
+        }
+
+        std::uint16_t encode(std::uint16_t position, std::uint32_t id, std::uint8_t numberOfArgs, const std::uint32_t * args)
+        {
+            position = encodeWord(position, id);
+            txBuffer_[position++] = numberOfArgs;
+            for (std::uint8_t i = 0; i < numberOfArgs; ++i)
+            {
+                position = encodeWord(position, args[i]);
+            }
+            return position;
+        }
+
+        std::uint16_t encodeWord(std::uint16_t position, std::uint32_t word)
+        {
+            txBuffer_[position++] = static_cast<std::uint8_t>(word);
+            txBuffer_[position++] = static_cast<std::uint8_t>(word >> 8);
+            txBuffer_[position++] = static_cast<std::uint8_t>(word >> 16);
+            txBuffer_[position++] = static_cast<std::uint8_t>(word >> 24);
+            return position;
+        }
+
+        Scheduler & scheduler_;
+        [[no_unique_address]] Writer writer_;
+
+        // Written by the log calls
+        cont::MpscQueue<Record, NRecords> records_;
+        std::atomic<std::uint32_t> dropped_ = 0U;
+        std::atomic<bool> writePosted_ = false;
+
+        // Written by the write task
+        Record pendingRecord_;
+        bool hasPendingRecord_ = false;
+        bool writing_ = false;
+        bool hasWriteOperation_ = false;
+        std::uint32_t writeErrors_ = 0U;
+        cont::Box<WriteOperation> writeOperation_;
+        std::array<std::uint8_t, NTxBytes> txBuffer_;
+    };
+
+    template<class Scheduler, class Writer>
+    Logger(Scheduler &, Writer &&) -> Logger<Scheduler, std::remove_cvref_t<Writer>>;
+}
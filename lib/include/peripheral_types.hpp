@@ -11,6 +11,7 @@ namespace PeripheralTypes
         template<std::uint8_t id> struct Uart {};
         template<std::uint8_t id> struct Dma {};
         template<std::uint8_t id> struct Adc {};
+        struct AdcCommon {};
         struct Exti {};
         struct SysCfg {};
     }
@@ -21,6 +22,7 @@ namespace PeripheralTypes
     template<std::uint8_t id> constexpr tags::Uart<id> UART{};
     template<std::uint8_t id> constexpr tags::Dma<id> DMA{};
     template<std::uint8_t id> constexpr tags::Adc<id> ADC{};
+    constexpr tags::AdcCommon ADC_COMMON{};
     constexpr tags::Exti EXTI{};
     constexpr tags::SysCfg SYSCFG{};
 }
\ No newline at end of file
@@ -1,4 +1,6 @@
 #pragma once
 
 #include "i2c/make.hpp"
-#include "i2c/i2c_master.hpp"
\ No newline at end of file
+#include "i2c/i2c_master.hpp"
+#include "i2c/i2c_dma_master.hpp"
+#include "i2c/i2c_bus.hpp"
\ No newline at end of file
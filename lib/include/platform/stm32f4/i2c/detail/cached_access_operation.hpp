@@ -0,0 +1,142 @@
+#pragma once
+#include "../i2c_error.hpp"
+#include "async/future.hpp"
+#include "async/operation.hpp"
+#include "async/receiver.hpp"
+#include "cont/box.hpp"
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace drivers::i2c::detail
+{
+    /**
+     * Access to a cached register. The register is only read from the
+     * device if the access needs its value and the cache does not hold it.
+     * The access itself (f) runs on the cache, writes are deferred until
+     * the cache is flushed.
+     */
+    template<class I2cDevice, class Cache, class Serializer, class TOffset, TOffset addr, class F, class R>
+    class CachedAccessOperation
+    {
+        using Value = typename Cache::Value;
+        using Result = std::invoke_result_t<F &, Cache &>;
+
+        class ReadReceiver
+        {
+        public:
+            explicit ReadReceiver(CachedAccessOperation & op) : op_(op) { }
+
+            template<class T>
+            void setValue(T &&) &&
+            {
+                op_.cache_.fill(addr, op_.value_);
+                op_.complete();
+            }
+
+            template<class E>
+            void setError(E && e) &&
+            {
+                async::setError(std::move(op_.receiver_), static_cast<E&&>(e));
+            }
+
+            void setDone() &&
+            {
+                async::setDone(std::move(op_.receiver_));
+            }
+
+        private:
+            template<class Cpo, class ... Args>
+            friend auto tag_invoke(Cpo cpo, const ReadReceiver & self, Args &&... args)
+                -> decltype(cpo(std::declval<const R&>(), static_cast<Args&&>(args)...))
+            {
+                return cpo(self.op_.getReceiver(), static_cast<Args&&>(args)...);
+            }
+
+            CachedAccessOperation & op_;
+        };
+
+        using ReadFuture = decltype(std::declval<I2cDevice &>().writeAndRead(
+            std::uint8_t{}, std::declval<const std::uint8_t *>(), std::uint16_t{},
+            std::declval<std::uint8_t *>(), std::uint16_t{}));
+        using ReadOperation = async::connect_result_t<ReadFuture, ReadReceiver>;
+
+    public:
+        template<class F2, class R2>
+        CachedAccessOperation(
+            I2cDevice & i2cDevice,
+            std::uint8_t slaveAddress,
+            Cache & cache,
+            bool needsValue,
+            F2 && f,
+            R2 && receiver)
+        : i2cDevice_(i2cDevice)
+        , slaveAddress_(slaveAddress)
+        , cache_(cache)
+        , needsValue_(needsValue)
+        , f_(static_cast<F2&&>(f))
+        , receiver_(static_cast<R2&&>(receiver))
+        {
+
+        }
+
+        CachedAccessOperation(const CachedAccessOperation &) = delete;
+        CachedAccessOperation & operator=(const CachedAccessOperation &) = delete;
+
+        ~CachedAccessOperation()
+        {
+            if (hasReadOperation_)
+            {
+                readOperation_.destruct();
+            }
+        }
+
+        void start()
+        {
+            if (!needsValue_ || cache_.isValid(addr))
+            {
+                complete();
+                return;
+            }
+
+            Serializer::serializeAddress(addr, address_);
+            hasReadOperation_ = true;
+            auto & op = readOperation_.constructWith([this]() {
+                return async::connect(
+                    i2cDevice_.writeAndRead(slaveAddress_,
+                        address_, sizeof(TOffset),
+                        reinterpret_cast<std::uint8_t *>(&value_), sizeof(Value)),
+                    ReadReceiver{*this});
+            });
+            async::start(op);
+        }
+
+        R & getReceiver() & { return receiver_; }
+        const R & getReceiver() const & { return receiver_; }
+
+    private:
+        void complete()
+        {
+            if constexpr (std::is_void_v<Result>)
+            {
+                f_(cache_);
+                async::setValue(std::move(receiver_));
+            }
+            else
+            {
+                async::setValue(std::move(receiver_), f_(cache_));
+            }
+        }
+
+        I2cDevice & i2cDevice_;
+        std::uint8_t slaveAddress_;
+        Cache & cache_;
+        bool needsValue_;
+        [[no_unique_address]] F f_;
+        R receiver_;
+        std::uint8_t address_[sizeof(TOffset)];
+        Value value_;
+        bool hasReadOperation_ = false;
+        cont::Box<ReadOperation> readOperation_;
+    };
+}
@@ -0,0 +1,339 @@
+#pragma once
+#include "i2c_common.hpp"
+#include "error_event_handler.hpp"
+#include "../i2c_error.hpp"
+#include "async/event.hpp"
+#include "async/receiver.hpp"
+#include "async/scheduler.hpp"
+#include "drivers/dma/dma_concepts.hpp"
+#include "drivers/dma/dma_signal.hpp"
+#include "board/regmap/i2c.hpp"
+#include "delegate.hpp"
+#include <atomic>
+#include <cstdint>
+
+#include "reg/set.hpp"
+#include "reg/clear.hpp"
+#include "reg/apply.hpp"
+#include "reg/bit_is_set.hpp"
+#include "reg/unchecked_write.hpp"
+
+namespace drivers::i2c::detail
+{
+    /**
+     * Write, read or write-then-read transaction where the data bytes are
+     * moved by DMA. The event interrupt only handles the start condition,
+     * the address phase and the end of the write phase (BTF), and the read
+     * phase completes on the DMA transfer complete interrupt.
+     *
+     * Reads of two or more bytes set LAST, so the peripheral NACKs the
+     * last byte by itself. A single byte is NACKed (and the stop condition
+     * requested) while clearing ADDR, as the reference manual prescribes.
+     */
+    template<class I2cX, class TxTransferFactory, class RxTransferFactory, class R>
+    class DmaTransactionOperation
+    {
+        enum class Phase
+        {
+            WRITING,
+            READING
+        };
+
+        struct EventInterruptHandler : async::EventHandlerImpl<EventInterruptHandler>
+        {
+            explicit EventInterruptHandler(DmaTransactionOperation & parent) : parent_(parent) { }
+
+            void handleEvent()
+            {
+                parent_.handleEvent();
+            }
+
+            DmaTransactionOperation & parent_;
+        };
+
+        struct ErrorInterruptHandler : async::EventHandlerImpl<ErrorInterruptHandler>
+        {
+            explicit ErrorInterruptHandler(DmaTransactionOperation & parent) : parent_(parent) { }
+
+            void handleEvent()
+            {
+                ErrorEventHandler<I2cX>{}(parent_);
+            }
+
+            DmaTransactionOperation & parent_;
+        };
+
+        struct TxEventHandler
+        {
+            void operator()(dma::DmaSignal signal)
+            {
+                // The write phase ends on BTF, when the last byte has left the shift register
+                if (signal == dma::DmaSignal::TRANSFER_ERROR)
+                {
+                    reg::set(I2cX{}, board::i2c::CR1::STOP);
+                    op_.finishTransactionWithError(I2cError::DMA_ERROR);
+                }
+            }
+
+            DmaTransactionOperation & op_;
+        };
+
+        struct RxEventHandler
+        {
+            void operator()(dma::DmaSignal signal)
+            {
+                switch (signal)
+                {
+                    case dma::DmaSignal::TRANSFER_COMPLETE:
+                        if (op_.readSize_ > 1)
+                        {
+                            reg::set(I2cX{}, board::i2c::CR1::STOP);
+                        }
+                        op_.finishTransactionWithValue();
+                        break;
+                    case dma::DmaSignal::TRANSFER_ERROR:
+                        reg::set(I2cX{}, board::i2c::CR1::STOP);
+                        op_.finishTransactionWithError(I2cError::DMA_ERROR);
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            DmaTransactionOperation & op_;
+        };
+
+        using TxTransfer = dma::DmaTransferType<TxTransferFactory, TxEventHandler>;
+        using RxTransfer = dma::DmaTransferType<RxTransferFactory, RxEventHandler>;
+
+    public:
+        template<class TxTransferFactory2, class RxTransferFactory2, class R2>
+        DmaTransactionOperation(
+            TxTransferFactory2 && txTransferFactory,
+            RxTransferFactory2 && rxTransferFactory,
+            R2 && receiver,
+            const async::EventEmitter & eventInterrupt,
+            const async::EventEmitter & errorInterrupt,
+            std::uint8_t slaveAddress,
+            std::uint16_t writeSize,
+            std::uint16_t readSize)
+        : txTransfer_(static_cast<TxTransferFactory2&&>(txTransferFactory)(TxEventHandler{*this}))
+        , rxTransfer_(static_cast<RxTransferFactory2&&>(rxTransferFactory)(RxEventHandler{*this}))
+        , receiver_(static_cast<R2&&>(receiver))
+        , eventInterrupt_(eventInterrupt)
+        , errorInterrupt_(errorInterrupt)
+        , eventInterruptHandler_(*this)
+        , errorInterruptHandler_(*this)
+        , slaveAddress_(slaveAddress)
+        , writeSize_(writeSize)
+        , readSize_(readSize)
+        , phase_(writeSize > 0 || readSize == 0 ? Phase::WRITING : Phase::READING)
+        {
+
+        }
+
+        DmaTransactionOperation(const DmaTransactionOperation &) = delete;
+        DmaTransactionOperation & operator=(const DmaTransactionOperation &) = delete;
+
+        void start()
+        {
+            if (!eventInterrupt_.subscribe(&eventInterruptHandler_))
+            {
+                async::setError(std::move(receiver_), I2cError::BUSY);
+                return;
+            }
+
+            if (!errorInterrupt_.subscribe(&errorInterruptHandler_))
+            {
+                eventInterrupt_.unsubscribe();
+                async::setError(std::move(receiver_), I2cError::BUSY);
+                return;
+            }
+
+            txStarted_ = writeSize_ > 0 && txTransfer_.start();
+            rxStarted_ = readSize_ > 0 && rxTransfer_.start();
+            if ((writeSize_ > 0 && !txStarted_) || (readSize_ > 0 && !rxStarted_))
+            {
+                stop();
+                async::setError(std::move(receiver_), I2cError::BUSY);
+                return;
+            }
+
+            startImpl();
+        }
+
+        void stop()
+        {
+            reg::apply(I2cX{},
+                reg::clear(board::i2c::CR2::ITEVTEN),
+                reg::clear(board::i2c::CR2::ITERREN),
+                reg::clear(board::i2c::CR2::DMAEN),
+                reg::clear(board::i2c::CR2::LAST));
+
+            // Only release the streams of this operation
+            if (txStarted_)
+            {
+                txTransfer_.stop();
+                txStarted_ = false;
+            }
+            if (rxStarted_)
+            {
+                rxTransfer_.stop();
+                rxStarted_ = false;
+            }
+
+            eventInterrupt_.unsubscribe();
+            errorInterrupt_.unsubscribe();
+        }
+
+        // Called from the interrupts, only the first completion is posted
+        void finishTransactionWithValue()
+        {
+            if (!completed_.exchange(true, std::memory_order_acq_rel))
+            {
+                stop();
+                auto & s = async::getScheduler(receiver_);
+                s.postFromISR({memFn<&DmaTransactionOperation::setValue>, *this});
+            }
+        }
+
+        void finishTransactionWithError(I2cError error)
+        {
+            if (!completed_.exchange(true, std::memory_order_acq_rel))
+            {
+                stop();
+                error_ = error;
+                auto & s = async::getScheduler(receiver_);
+                s.postFromISR({memFn<&DmaTransactionOperation::setError>, *this});
+            }
+        }
+
+    private:
+        void startImpl()
+        {
+            if (reg::bitIsSet(I2cX{}, board::i2c::SR2::BUSY))
+            {
+                // Retry
+                auto & s = async::getScheduler(receiver_);
+                s.postFromISR({memFn<&DmaTransactionOperation::startImpl>, *this});
+                return;
+            }
+
+            if (phase_ == Phase::READING)
+            {
+                prepareRead();
+            }
+
+            reg::set(I2cX{}, board::i2c::CR1::START);
+
+            // Interrupt on SB, ADDR, BTF and errors, the data is moved by DMA
+            reg::apply(I2cX{},
+                reg::write(board::i2c::CR2::DMAEN, writeSize_ > 0 || readSize_ > 0),
+                reg::set(board::i2c::CR2::ITEVTEN),
+                reg::set(board::i2c::CR2::ITERREN));
+        }
+
+        void prepareRead()
+        {
+            if (readSize_ > 1)
+            {
+                reg::apply(I2cX{},
+                    reg::clear(board::i2c::CR1::POS),
+                    reg::set(board::i2c::CR1::ACK));
+                reg::set(I2cX{}, board::i2c::CR2::LAST);
+            }
+            else
+            {
+                reg::clear(I2cX{}, board::i2c::CR2::LAST);
+            }
+        }
+
+        // Event interrupt
+        void handleEvent()
+        {
+            auto sr1val = reg::getRegisterValue(I2cX{}, board::i2c::SR1::_Offset{});
+            if (reg::bitIsSet(sr1val, board::i2c::SR1::SB))
+            {
+                std::uint8_t direction = phase_ == Phase::READING ? 1 : 0;
+                reg::uncheckedWrite(I2cX{}, board::i2c::DR::_Offset{}, (slaveAddress_ << 1) | direction);
+            }
+            else if (reg::bitIsSet(sr1val, board::i2c::SR1::ADDR))
+            {
+                if (phase_ == Phase::WRITING)
+                {
+                    clearAddressBit<I2cX>();
+                    if (writeSize_ == 0)
+                    {
+                        finishWrite();
+                    }
+                }
+                else if (readSize_ == 0)
+                {
+                    clearAddressBit<I2cX>();
+                    reg::set(I2cX{}, board::i2c::CR1::STOP);
+                    finishTransactionWithValue();
+                }
+                else if (readSize_ == 1)
+                {
+                    // NACK the only byte and stop after it, the DMA moves it
+                    reg::apply(I2cX{},
+                        reg::clear(board::i2c::CR1::POS),
+                        reg::clear(board::i2c::CR1::ACK));
+                    clearAddressBit<I2cX>();
+                    reg::set(I2cX{}, board::i2c::CR1::STOP);
+                }
+                else
+                {
+                    clearAddressBit<I2cX>();
+                }
+            }
+            else if (reg::bitIsSet(sr1val, board::i2c::SR1::BTF) &&
+                phase_ == Phase::WRITING && txTransfer_.remaining() == 0)
+            {
+                finishWrite();
+            }
+        }
+
+        void finishWrite()
+        {
+            if (readSize_ > 0)
+            {
+                // Repeated start, BTF is cleared by the start condition
+                phase_ = Phase::READING;
+                prepareRead();
+                reg::set(I2cX{}, board::i2c::CR1::START);
+            }
+            else
+            {
+                reg::set(I2cX{}, board::i2c::CR1::STOP);
+                finishTransactionWithValue();
+            }
+        }
+
+        void setValue()
+        {
+            async::setValue(std::move(receiver_));
+        }
+
+        void setError()
+        {
+            async::setError(std::move(receiver_), error_);
+        }
+
+        TxTransfer txTransfer_;
+        RxTransfer rxTransfer_;
+        R receiver_;
+        async::EventEmitter eventInterrupt_;
+        async::EventEmitter errorInterrupt_;
+        EventInterruptHandler eventInterruptHandler_;
+        ErrorInterruptHandler errorInterruptHandler_;
+        const std::uint8_t slaveAddress_;
+        const std::uint16_t writeSize_;
+        const std::uint16_t readSize_;
+        Phase phase_;
+        bool txStarted_ = false;
+        bool rxStarted_ = false;
+        std::atomic<bool> completed_ = false;
+        I2cError error_ = I2cError::UNKNOWN;
+    };
+}
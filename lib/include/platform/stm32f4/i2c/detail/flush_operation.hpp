@@ -0,0 +1,180 @@
+#pragma once
+#include "../i2c_error.hpp"
+#include "async/future.hpp"
+#include "async/operation.hpp"
+#include "async/receiver.hpp"
+#include "cont/box.hpp"
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+namespace drivers::i2c::detail
+{
+    /**
+     * Writes the dirty registers of a cache, one auto-incrementing write
+     * per run of contiguous registers.
+     */
+    template<class I2cDevice, class Cache, class Serializer, class R>
+    class FlushOperation
+    {
+        using Offset = typename Cache::Offset;
+        using Value = typename Cache::Value;
+
+        enum class WriteStatus
+        {
+            PENDING,
+            WRITTEN,
+            FAILED,
+            STOPPED
+        };
+
+        class WriteReceiver
+        {
+        public:
+            explicit WriteReceiver(FlushOperation & op) : op_(op) { }
+
+            template<class T>
+            void setValue(T &&) &&
+            {
+                op_.writeCompleted(WriteStatus::WRITTEN);
+            }
+
+            template<class E>
+            void setError(E && e) &&
+            {
+                op_.error_ = static_cast<E&&>(e);
+                op_.writeCompleted(WriteStatus::FAILED);
+            }
+
+            void setDone() &&
+            {
+                op_.writeCompleted(WriteStatus::STOPPED);
+            }
+
+        private:
+            template<class Cpo, class ... Args>
+            friend auto tag_invoke(Cpo cpo, const WriteReceiver & self, Args &&... args)
+                -> decltype(cpo(std::declval<const R&>(), static_cast<Args&&>(args)...))
+            {
+                return cpo(self.op_.getReceiver(), static_cast<Args&&>(args)...);
+            }
+
+            FlushOperation & op_;
+        };
+
+        using WriteFuture = decltype(std::declval<I2cDevice &>().write(
+            std::uint8_t{}, std::declval<const std::uint8_t *>(), std::uint16_t{}));
+        using WriteOperation = async::connect_result_t<WriteFuture, WriteReceiver>;
+
+    public:
+        template<class R2>
+        FlushOperation(I2cDevice & i2cDevice, std::uint8_t slaveAddress, Cache & cache, R2 && receiver)
+        : i2cDevice_(i2cDevice)
+        , slaveAddress_(slaveAddress)
+        , cache_(cache)
+        , receiver_(static_cast<R2&&>(receiver))
+        {
+
+        }
+
+        FlushOperation(const FlushOperation &) = delete;
+        FlushOperation & operator=(const FlushOperation &) = delete;
+
+        ~FlushOperation()
+        {
+            if (hasWriteOperation_)
+            {
+                writeOperation_.destruct();
+            }
+        }
+
+        void start()
+        {
+            writeNext();
+        }
+
+        R & getReceiver() & { return receiver_; }
+        const R & getReceiver() const & { return receiver_; }
+
+    private:
+        void writeCompleted(WriteStatus status)
+        {
+            status_ = status;
+
+            // A write that completes while it is started (e.g. on a
+            // synchronous device) is continued by the loop in writeNext,
+            // once its start has returned
+            if (!starting_)
+            {
+                writeNext();
+            }
+        }
+
+        void writeNext()
+        {
+            for (;;)
+            {
+                if (status_ == WriteStatus::FAILED)
+                {
+                    cache_.markDirty(offset_, length_);
+                    async::setError(std::move(receiver_), error_);
+                    return;
+                }
+
+                if (status_ == WriteStatus::STOPPED)
+                {
+                    cache_.markDirty(offset_, length_);
+                    async::setDone(std::move(receiver_));
+                    return;
+                }
+
+                if (hasWriteOperation_)
+                {
+                    writeOperation_.destruct();
+                    hasWriteOperation_ = false;
+                }
+
+                Value values[Cache::size];
+                length_ = cache_.takeDirtyRun(offset_, values);
+                if (length_ == 0)
+                {
+                    async::setValue(std::move(receiver_));
+                    return;
+                }
+
+                Serializer::serializeAddress(Cache::burstOffset(offset_), buffer_);
+                std::memcpy(buffer_ + sizeof(Offset), values, length_ * sizeof(Value));
+
+                status_ = WriteStatus::PENDING;
+                hasWriteOperation_ = true;
+                auto & op = writeOperation_.constructWith([this]() {
+                    return async::connect(
+                        i2cDevice_.write(slaveAddress_, buffer_, static_cast<std::uint16_t>(sizeof(Offset) + length_ * sizeof(Value))),
+                        WriteReceiver{*this});
+                });
+
+                starting_ = true;
+                async::start(op);
+                starting_ = false;
+
+                if (status_ == WriteStatus::PENDING)
+                {
+                    return;
+                }
+            }
+        }
+
+        I2cDevice & i2cDevice_;
+        std::uint8_t slaveAddress_;
+        Cache & cache_;
+        R receiver_;
+        Offset offset_ = {};
+        std::size_t length_ = 0;
+        std::uint8_t buffer_[sizeof(Offset) + Cache::size * sizeof(Value)];
+        WriteStatus status_ = WriteStatus::WRITTEN;
+        I2cError error_ = {};
+        bool starting_ = false;
+        bool hasWriteOperation_ = false;
+        cont::Box<WriteOperation> writeOperation_;
+    };
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include "async/future.hpp"
+#include "async/make_future.hpp"
+#include "i2c_error.hpp"
+#include "i2c_like.hpp"
+#include "drivers/detail/bus_queue.hpp"
+#include "async/scheduler.hpp"
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace drivers::i2c
+{
+    /**
+     * Shares an I2C master (e.g. I2cMaster or I2cDmaMaster) between the
+     * drivers of several devices.
+     *
+     * The transactions of the devices are queued and the next one is
+     * started as soon as the running one completes. Transactions of devices
+     * with a higher priority (a lower async::Priority value, 0 being
+     * async::highestPriority) run first, transactions of the same priority
+     * in the order they were started; a running transaction is never
+     * interrupted. The queue is intrusive (the transaction operations are
+     * its nodes), so the bus does not allocate.
+     *
+     * Transactions must be started and stopped from the scheduler, the
+     * context their futures complete on.
+     */
+    template<I2cLike Master>
+    class I2cBus
+    {
+    public:
+        static constexpr async::Priority lowestPriority = std::numeric_limits<async::Priority>::max();
+
+        explicit I2cBus(Master & master) : master_(master) { }
+
+        I2cBus(const I2cBus &) = delete;
+        I2cBus(I2cBus &&) = delete;
+        I2cBus & operator=(const I2cBus &) = delete;
+        I2cBus & operator=(I2cBus &&) = delete;
+
+        Master & getMaster()
+        {
+            return master_;
+        }
+
+    private:
+        template<I2cLike>
+        friend class I2cBusDevice;
+
+        Master & master_;
+        drivers::detail::BusQueue<drivers::detail::BusOrder::PRIORITY> queue_;
+    };
+
+    /**
+     * A device on a shared I2C bus. It is I2cLike itself, so it can be
+     * used in place of the master by the device drivers (e.g. through
+     * I2cMemory).
+     */
+    template<I2cLike Master>
+    class I2cBusDevice
+    {
+        using Queue = drivers::detail::BusQueue<drivers::detail::BusOrder::PRIORITY>;
+
+    public:
+        /**
+         * @param priority Transactions of devices with a lower value are
+         *                 run first, see async::Priority
+         */
+        explicit I2cBusDevice(I2cBus<Master> & bus, async::Priority priority = I2cBus<Master>::lowestPriority)
+        : bus_(bus), priority_(priority)
+        {
+
+        }
+
+        /**
+         * @return void future
+         */
+        auto write(std::uint8_t slaveAddress, const std::uint8_t * data, std::uint16_t size)
+        {
+            return transaction(bus_.getMaster().write(slaveAddress, data, size));
+        }
+
+        /**
+         * @return void future
+         */
+        auto read(std::uint8_t slaveAddress, std::uint8_t * data, std::uint16_t size)
+        {
+            return transaction(bus_.getMaster().read(slaveAddress, data, size));
+        }
+
+        /**
+         * @return void future
+         */
+        auto writeAndRead(std::uint8_t slaveAddress, const std::uint8_t * writeData, std::uint16_t writeSize, std::uint8_t * readBuffer, std::uint16_t readSize)
+        {
+            return transaction(bus_.getMaster().writeAndRead(slaveAddress, writeData, writeSize, readBuffer, readSize));
+        }
+
+    private:
+        template<class S>
+        auto transaction(S && sender)
+        {
+            using Sender = std::remove_cvref_t<S>;
+            return async::makeFuture<async::future_value_t<Sender>, I2cError>(
+                [this, sender = static_cast<S&&>(sender)]<typename R>(R && receiver) mutable
+                    -> drivers::detail::BusTransactionOperation<Queue, drivers::detail::NoBusHooks, Sender, std::remove_cvref_t<R>>
+                {
+                    return {bus_.queue_, priority_, drivers::detail::NoBusHooks{}, std::move(sender), static_cast<R&&>(receiver)};
+                });
+        }
+
+        I2cBus<Master> & bus_;
+        async::Priority priority_;
+    };
+}
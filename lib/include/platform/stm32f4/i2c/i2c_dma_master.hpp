@@ -0,0 +1,96 @@
+#pragma once
+#include "async/event.hpp"
+#include "async/make_future.hpp"
+#include "i2c_error.hpp"
+#include "detail/dma_transaction_operation.hpp"
+#include "drivers/dma/address.hpp"
+#include "drivers/dma/dma_concepts.hpp"
+#include "board/regmap/i2c.hpp"
+#include <type_traits>
+
+namespace drivers::i2c
+{
+    /**
+     * I2C master that moves the data bytes with DMA, so a transaction takes
+     * a few interrupts regardless of its length. Has the same interface as
+     * I2cMaster, so it can be used wherever an I2cLike is expected
+     * (e.g. by I2cMemory).
+     *
+     * @tparam I2cX I2C peripheral
+     * @tparam TxDma DMA stream on the channel of the peripheral's TX request
+     * @tparam RxDma DMA stream on the channel of the peripheral's RX request
+     */
+    template<class I2cX, dma::DmaLike TxDma, dma::DmaLike RxDma>
+    class I2cDmaMaster
+    {
+    public:
+        I2cDmaMaster(
+            const async::EventEmitter & evtInterrupt,
+            const async::EventEmitter & errInterrupt,
+            TxDma & dmaTx,
+            RxDma & dmaRx)
+        : eventInterrupt_(evtInterrupt)
+        , errorInterrupt_(errInterrupt)
+        , dmaTx_(dmaTx)
+        , dmaRx_(dmaRx)
+        {
+
+        }
+
+        I2cDmaMaster(const I2cDmaMaster &) = delete;
+        I2cDmaMaster(I2cDmaMaster &&) = delete;
+        I2cDmaMaster & operator=(const I2cDmaMaster &) = delete;
+        I2cDmaMaster & operator=(I2cDmaMaster &&) = delete;
+
+        /**
+         * @return void future
+         */
+        auto write(std::uint8_t slaveAddress, const std::uint8_t * data, std::uint16_t size)
+        {
+            return writeAndRead(slaveAddress, data, size, nullptr, 0);
+        }
+
+        /**
+         * @return void future
+         */
+        auto read(std::uint8_t slaveAddress, std::uint8_t * data, std::uint16_t size)
+        {
+            return writeAndRead(slaveAddress, nullptr, 0, data, size);
+        }
+
+        /**
+         * Write, then read after a repeated start condition.
+         *
+         * @return void future
+         */
+        auto writeAndRead(std::uint8_t slaveAddress, const std::uint8_t * writeData, std::uint16_t writeSize, std::uint8_t * readBuffer, std::uint16_t readSize)
+        {
+            auto dataRegister = dma::PeripheralAddress(I2cX{}.getAddress(board::i2c::DR::_Offset{}));
+            auto txTransferFactory = dmaTx_.transferSingle(dma::MemoryAddress(writeData), dataRegister, writeSize);
+            auto rxTransferFactory = dmaRx_.transferSingle(dataRegister, dma::MemoryAddress(readBuffer), readSize);
+            using TxTransferFactoryType = decltype(txTransferFactory);
+            using RxTransferFactoryType = decltype(rxTransferFactory);
+
+            return async::makeFuture<void, I2cError>(
+                [=, this]<typename R>(R && receiver) mutable
+                    -> detail::DmaTransactionOperation<I2cX, TxTransferFactoryType, RxTransferFactoryType, std::remove_cvref_t<R>>
+                {
+                    return {
+                        std::move(txTransferFactory),
+                        std::move(rxTransferFactory),
+                        static_cast<R&&>(receiver),
+                        eventInterrupt_,
+                        errorInterrupt_,
+                        slaveAddress,
+                        writeSize,
+                        readSize};
+                });
+        }
+
+    private:
+        async::EventEmitter eventInterrupt_;
+        async::EventEmitter errorInterrupt_;
+        TxDma & dmaTx_;
+        RxDma & dmaRx_;
+    };
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include "i2c_error.hpp"
+#include "async/future.hpp"
+#include <cstdint>
+
+namespace drivers::i2c
+{
+    /**
+     * An I2C master, as used by the device drivers (e.g. through I2cMemory)
+     */
+    template<class T>
+    concept I2cLike = requires(T & i2cDevice, std::uint8_t slaveAddress, const std::uint8_t * writeBuffer, std::uint8_t * readBuffer, std::uint16_t size)
+    {
+        {i2cDevice.read(slaveAddress, readBuffer, size)} -> async::Future<void, I2cError>;
+        {i2cDevice.write(slaveAddress, writeBuffer, size)} -> async::Future<void, I2cError>;
+        {i2cDevice.writeAndRead(slaveAddress, writeBuffer, size, readBuffer, size)} -> async::Future<void, I2cError>;
+    };
+}
@@ -21,19 +21,19 @@ namespace drivers::i2c
         I2cMaster & operator=(const I2cMaster &) = delete;
         I2cMaster & operator=(I2cMaster &&) = delete;
 
-        async::Future<void, I2cError> auto write(std::uint8_t slaveAddress, const std::uint8_t * data, std::uint16_t size)
+        auto write(std::uint8_t slaveAddress, const std::uint8_t * data, std::uint16_t size)
             -> detail::WriteSender<I2cX>
         {
             return {slaveAddress, eventInterrupt_, errorInterrupt_, data, size};
         }
 
-        async::Future<void, I2cError> auto read(std::uint8_t slaveAddress, std::uint8_t * data, std::uint16_t size)
+        auto read(std::uint8_t slaveAddress, std::uint8_t * data, std::uint16_t size)
             -> detail::ReadSender<I2cX>
         {
             return {slaveAddress, eventInterrupt_, errorInterrupt_, data, size};
         }
 
-        async::Future<void, I2cError> auto writeAndRead(std::uint8_t slaveAddress, const std::uint8_t * writeData, std::uint16_t writeSize, std::uint8_t * readBuffer, std::uint16_t readSize)
+        auto writeAndRead(std::uint8_t slaveAddress, const std::uint8_t * writeData, std::uint16_t writeSize, std::uint8_t * readBuffer, std::uint16_t readSize)
             -> detail::WriteAndReadSender<I2cX>
         {
             return {slaveAddress, eventInterrupt_, errorInterrupt_, writeData, writeSize, readBuffer, readSize};
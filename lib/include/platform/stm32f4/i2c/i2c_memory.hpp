@@ -1,11 +1,20 @@
 #pragma once
 #include "i2c_like.hpp"
+#include "register_cache.hpp"
+#include "detail/cached_access_operation.hpp"
+#include "detail/flush_operation.hpp"
 #include "reg/field.hpp"
+#include "reg/field_action.hpp"
+#include <algorithm>
 #include <array>
+#include <concepts>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
 #include "async/receiver.hpp"
 #include "async/future.hpp"
+#include "async/make_future.hpp"
 #include "async/use_state.hpp"
-#include "async/and_then.hpp"
 #include "async/map.hpp"
 #include "async/sequence.hpp"
 
@@ -28,14 +37,136 @@ namespace drivers::i2c
             TAddress address;
             TValue value;
         };
+
+        // The results of the read actions of a reg::apply
+        struct ReturnResults
+        {
+            template<class V, class R, class ... Tail>
+            auto operator()(V, R r, Tail... results) const
+            {
+                if constexpr (sizeof...(Tail) > 0)
+                {
+                    return std::make_tuple(r, results...);
+                }
+                else
+                {
+                    return r;
+                }
+            }
+        };
+
+        template<class Location> struct BlockLocation;
+
+        template<class T, class Tag, class TOffset, TOffset offset>
+        struct BlockLocation<reg::FieldLocation<T, Tag, reg::FieldOffset<TOffset, offset>>>
+        {
+            using Value = T;
+            using Offset = TOffset;
+            using Owner = Tag;
+            static constexpr TOffset value = offset;
+        };
+
+        /**
+         * The consecutive registers touched by the locations of a block
+         * access. Register offsets are byte addresses, so a 16 bit register
+         * at offset n is followed by the register at n + 2.
+         */
+        template<class ... Locations>
+        struct RegisterBlock
+        {
+            static_assert(sizeof...(Locations) > 0, "A block has at least one register");
+
+            using Offset = std::common_type_t<typename BlockLocation<Locations>::Offset...>;
+
+            static constexpr Offset first = std::min({static_cast<Offset>(BlockLocation<Locations>::value)...});
+            static constexpr std::size_t size = std::max({
+                static_cast<std::size_t>(BlockLocation<Locations>::value - first) + sizeof(typename BlockLocation<Locations>::Value)...});
+
+            template<class Location>
+            static constexpr std::size_t position = static_cast<std::size_t>(BlockLocation<Location>::value - first);
+
+            // Whether every byte of the block belongs to one of the locations
+            static constexpr bool isContiguous()
+            {
+                std::array<bool, size> covered = {};
+                ((std::fill_n(
+                    covered.begin() + position<Locations>,
+                    sizeof(typename BlockLocation<Locations>::Value),
+                    true)), ...);
+                return std::find(covered.begin(), covered.end(), false) == covered.end();
+            }
+        };
+
+        template<class Block, class Serializer>
+        struct BlockTransferState
+        {
+            BlockTransferState()
+            {
+                Serializer::serializeAddress(Block::first, buffer);
+            }
+
+            template<class Location>
+            auto get() const
+            {
+                typename BlockLocation<Location>::Value value;
+                std::memcpy(&value, valueBuffer() + Block::template position<Location>, sizeof(value));
+                return value;
+            }
+
+            template<class Location>
+            void set(typename BlockLocation<Location>::Value value)
+            {
+                std::memcpy(valueBuffer() + Block::template position<Location>, &value, sizeof(value));
+            }
+
+            std::uint8_t * valueBuffer()
+            {
+                return buffer + sizeof(typename Block::Offset);
+            }
+
+            const std::uint8_t * valueBuffer() const
+            {
+                return buffer + sizeof(typename Block::Offset);
+            }
+
+            static constexpr std::uint16_t addressSize()
+            {
+                return sizeof(typename Block::Offset);
+            }
+
+            static constexpr std::uint16_t valueSize()
+            {
+                return Block::size;
+            }
+
+            static constexpr std::uint16_t bufferSize()
+            {
+                return addressSize() + valueSize();
+            }
+
+            std::uint8_t buffer[sizeof(typename Block::Offset) + Block::size] = {};
+        };
     }
 
+    /**
+     * Registers of an I2C device, accessed with the reg operations.
+     *
+     * With a RegisterCache, the cached registers are only read from the
+     * device when their value is not known, and writes to them are deferred
+     * until flush, which writes runs of contiguous registers as single
+     * auto-incrementing writes. Registers outside the cache (or declared
+     * volatile by its policy) are always accessed on the device.
+     */
     template<
         I2cLike I2cDevice,
         class RegTag, 
-        class Serializer = detail::DefaultAddressSerializer>
+        class Serializer = detail::DefaultAddressSerializer,
+        class Cache = NoRegisterCache>
     class I2cMemory
     {
+        template<class TOffset, TOffset addr>
+        static constexpr bool isCached = Cache::isCached(addr);
+
         template<class TOffset, class TValue>
         struct TransferState
         {
@@ -120,50 +251,230 @@ namespace drivers::i2c
         template<class T, class TOffset, TOffset addr>
         async::Future<T, I2cError> auto read(reg::FieldLocation<T, RegTag, reg::FieldOffset<TOffset, addr>>)
         {
+            if constexpr (isCached<TOffset, addr>)
+            {
+                return accessCached<T, TOffset, addr>(true, [](Cache & cache) -> T {
+                    return cache.get(addr);
+                });
+            }
+            else
+            {
+                return readDevice<T, TOffset, addr>();
+            }
+        }
+
+        template<class T, class TOffset, TOffset addr, class F>
+        auto readAndTransform(reg::FieldLocation<T, RegTag, reg::FieldOffset<TOffset, addr>>, F && f)
+        {
+            if constexpr (isCached<TOffset, addr>)
+            {
+                return accessCached<T, TOffset, addr>(true, [f = static_cast<F&&>(f)](Cache & cache) mutable {
+                    return f(detail::ReturnResults{}, cache.get(addr));
+                });
+            }
+            else
+            {
+                return readDevice<T, TOffset, addr>()
+                    | async::map([f = static_cast<F&&>(f)](T value) mutable {
+                        return f(detail::ReturnResults{}, value);
+                    });
+            }
+        }
+
+        template<class T, class TOffset, TOffset addr, class T2>
+        async::Future<void, I2cError> auto write(reg::FieldLocation<T, RegTag, reg::FieldOffset<TOffset, addr>>, T2 value)
+        {
+            if constexpr (isCached<TOffset, addr>)
+            {
+                return accessCached<T, TOffset, addr>(false, [value = static_cast<T>(value)](Cache & cache) {
+                    cache.set(addr, value);
+                });
+            }
+            else
+            {
+                return writeDevice<T, TOffset, addr>(static_cast<T>(value));
+            }
+        }
+
+        template<class T, class TOffset, TOffset addr, class F>
+        async::Future<void, I2cError> auto readModifyWrite(reg::FieldLocation<T, RegTag, reg::FieldOffset<TOffset, addr>>, F && f)
+        {
+            if constexpr (isCached<TOffset, addr>)
+            {
+                // The read is skipped when the value is cached
+                return accessCached<T, TOffset, addr>(true, [f = static_cast<F&&>(f)](Cache & cache) mutable {
+                    f([&](T result) { cache.set(addr, result); }, cache.get(addr));
+                });
+            }
+            else
+            {
+                return readModifyWriteDevice<T, TOffset, addr>(static_cast<F&&>(f));
+            }
+        }
+
+        template<class T, class TOffset, TOffset addr, class F>
+        auto readModifyWriteTransform(reg::FieldLocation<T, RegTag, reg::FieldOffset<TOffset, addr>>, F && f)
+        {
+            static_assert(isCached<TOffset, addr>, "Reading and writing a register in one apply requires a cached register");
+            return accessCached<T, TOffset, addr>(true, [f = static_cast<F&&>(f)](Cache & cache) mutable {
+                return f(
+                    [&](T result, auto ... results) {
+                        cache.set(addr, result);
+                        return detail::ReturnResults{}(result, results...);
+                    },
+                    cache.get(addr));
+            });
+        }
+
+        /**
+         * Read a block of consecutive registers in one auto-incrementing
+         * transaction, and decode the fields of all read actions from it.
+         *
+         * Every register from the lowest to the highest location is read,
+         * including those between the locations of the actions.
+         *
+         * \code
+         * memory.readBlock(reg::read(MODEL_ID::MODEL_ID), reg::read(MODEL_REV::MINOR))
+         * \endcode
+         *
+         * @return Future of the field values (a tuple for several fields),
+         *         in the order of the actions
+         */
+        template<class ... Locations, class ... Actions>
+        auto readBlock(reg::FieldAction<Locations, Actions> ... actions)
+        {
+            using Block = detail::RegisterBlock<Locations...>;
+            static_assert((std::same_as<typename Locations::Owner, RegTag> && ...), "The fields do not belong to this memory");
+            static_assert((!Actions::isWrite && ...), "readBlock only takes read actions");
+            static_assert(!overlapsCache<Block>(), "Cached registers can not be read in a block");
+
             return async::useState(
-                TransferState<TOffset, T>{addr},
-                [this](auto & state) {
+                detail::BlockTransferState<Block, Serializer>{},
+                [this, actions...](auto & state) {
                     return 
                         i2cDevice_.writeAndRead(slaveAddress_, 
-                            state.addressBuffer(), state.addressSize(), 
+                            state.buffer, state.addressSize(), 
                             state.valueBuffer(), state.valueSize())
-                        | async::map([&]() -> T { 
-                            return state.getValue(); 
+                        | async::map([&state, actions...]() {
+                            return detail::ReturnResults{}(0,
+                                actions(detail::ReturnResults{}, state.template get<Locations>())...);
                         });
                 });
         }
 
+        /**
+         * Write a block of consecutive registers in one auto-incrementing
+         * transaction.
+         *
+         * The registers are written whole, without reading them first: the
+         * bits that are not written by one of the actions are cleared, and
+         * the actions must cover every register of the block.
+         *
+         * @return void future
+         */
+        template<class ... Locations, class ... Actions>
+        auto writeBlock(reg::FieldAction<Locations, Actions> ... actions)
+        {
+            using Block = detail::RegisterBlock<Locations...>;
+            static_assert((std::same_as<typename Locations::Owner, RegTag> && ...), "The fields do not belong to this memory");
+            static_assert((Actions::isWrite && ...), "writeBlock only takes write actions");
+            static_assert(Block::isContiguous(), "The locations of a block write must not have gaps");
+            static_assert(!overlapsCache<Block>(), "Cached registers can not be written in a block");
+
+            detail::BlockTransferState<Block, Serializer> blockState;
+            (blockState.template set<Locations>(
+                actions([](auto value, auto ...) { return value; }, blockState.template get<Locations>())), ...);
+
+            return async::useState(
+                std::move(blockState),
+                [this](auto & state) {
+                    return i2cDevice_.write(slaveAddress_, state.buffer, state.bufferSize());
+                });
+        }
+
+        /**
+         * Write the cached registers that have been written since the
+         * last flush, in runs of contiguous registers.
+         *
+         * @return void future
+         */
+        auto flush()
+            requires (!std::same_as<Cache, NoRegisterCache>)
+        {
+            return async::makeFuture<void, I2cError>(
+                [this]<typename R>(R && receiver)
+                    -> detail::FlushOperation<I2cDevice, Cache, Serializer, std::remove_cvref_t<R>>
+                {
+                    return {i2cDevice_, slaveAddress_, cache_, static_cast<R&&>(receiver)};
+                });
+        }
+
+        /**
+         * Forget the cached values, e.g. after a reset of the device.
+         * Values that have not been flushed are lost.
+         */
+        void invalidateCache()
+            requires (!std::same_as<Cache, NoRegisterCache>)
+        {
+            cache_.invalidate();
+        }
+
+    private:
+        template<class Block>
+        static constexpr bool overlapsCache()
+        {
+            for (std::size_t i = 0; i < Block::size; ++i)
+            {
+                if (Cache::isCached(static_cast<typename Block::Offset>(Block::first + i)))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
         template<class T, class TOffset, TOffset addr, class F>
-        async::Future<void, I2cError> auto readAndTransform(reg::FieldLocation<T, RegTag, reg::FieldOffset<TOffset, addr>>, F && f)
+        auto accessCached(bool needsValue, F && f)
+        {
+            using Result = std::invoke_result_t<std::remove_cvref_t<F> &, Cache &>;
+            static_assert(std::same_as<TOffset, typename Cache::Offset>, "The cache must use the offset type of the register map");
+            static_assert(sizeof(T) == sizeof(typename Cache::Value), "A cached register must have the register type of the cache");
+            return async::makeFuture<Result, I2cError>(
+                [this, needsValue, f = static_cast<F&&>(f)]<typename R>(R && receiver) mutable
+                    -> detail::CachedAccessOperation<I2cDevice, Cache, Serializer, TOffset, addr, std::remove_cvref_t<F>, std::remove_cvref_t<R>>
+                {
+                    return {i2cDevice_, slaveAddress_, cache_, needsValue, std::move(f), static_cast<R&&>(receiver)};
+                });
+        }
+
+        template<class T, class TOffset, TOffset addr>
+        auto readDevice()
         {
             return async::useState(
-                ReadModifyWriteState<TOffset, T, std::remove_cvref_t<F>>{static_cast<F&&>(f), addr}, 
+                TransferState<TOffset, T>{addr},
                 [this](auto & state) {
                     return 
-                        i2cDevice_.writeAndRead(
-                            slaveAddress_, 
-                            state.addressBuffer(), 
-                            state.addressSize(), 
-                            state.valueBuffer(), 
-                            state.valueSize())
-                        | async::map([&]() {
-                            return std::move(state.transform)(*(state.getValuePtr()));
+                        i2cDevice_.writeAndRead(slaveAddress_, 
+                            state.addressBuffer(), state.addressSize(), 
+                            state.valueBuffer(), state.valueSize())
+                        | async::map([&]() -> T { 
+                            return state.getValue(); 
                         });
                 });
         }
 
-        template<class T, class TOffset, TOffset addr, class T2>
-        async::Future<void, I2cError> auto write(reg::FieldLocation<T, RegTag, reg::FieldOffset<TOffset, addr>>, T2 value)
+        template<class T, class TOffset, TOffset addr>
+        auto writeDevice(T value)
         {
             return async::useState(
-                TransferState<TOffset, T>{addr, static_cast<T>(value)},
+                TransferState<TOffset, T>{addr, value},
                 [this](auto & state) {
                     return i2cDevice_.write(slaveAddress_, state.buffer, state.bufferSize());
                 });
         }
 
         template<class T, class TOffset, TOffset addr, class F>
-        async::Future<void, I2cError> auto readModifyWrite(reg::FieldLocation<T, RegTag, reg::FieldOffset<TOffset, addr>>, F && f)
+        auto readModifyWriteDevice(F && f)
         {
             return 
                 async::useState(
@@ -185,14 +496,8 @@ namespace drivers::i2c
                     });       
         }
 
-        /*template<type addr, class F>
-        async::Sender auto readModifyWriteTransform(reg::FieldLocation<type, Tag, reg::FieldOffset<type, addr>>, F && f)
-        {
-
-        }*/
-
-    private:
         I2cDevice & i2cDevice_;
         std::uint8_t slaveAddress_;
+        [[no_unique_address]] Cache cache_;
     };
 }
\ No newline at end of file
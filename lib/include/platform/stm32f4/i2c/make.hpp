@@ -9,7 +9,7 @@
 #include "reg/write.hpp"
 #include "reg/set.hpp"
 
-namespace platform::stm32f4::i2c
+namespace drivers::i2c
 {
 	struct MasterConfig
 	{
@@ -0,0 +1,179 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace drivers::i2c
+{
+    /**
+     * Register policy of a RegisterCache. Every register in the cached
+     * range keeps its value until it is written, and a burst is addressed
+     * by the offset of its first register.
+     *
+     * A device specific policy can declare status registers volatile (they
+     * are then always accessed on the device), or set the auto-increment
+     * flag of the register address in burstOffset.
+     */
+    struct DefaultCachePolicy
+    {
+        template<class TOffset>
+        static constexpr bool isVolatile(TOffset)
+        {
+            return false;
+        }
+
+        template<class TOffset>
+        static constexpr TOffset burstOffset(TOffset offset)
+        {
+            return offset;
+        }
+    };
+
+    /**
+     * Cache of an I2cMemory that does not cache
+     */
+    struct NoRegisterCache
+    {
+        template<class TOffset>
+        static constexpr bool isCached(TOffset)
+        {
+            return false;
+        }
+    };
+
+    /**
+     * Shadow copy of the registers first .. first + count - 1 of a device.
+     *
+     * A value is valid once it has been read from or written to the device
+     * through the cache, and dirty while it has not been written to the
+     * device yet.
+     *
+     * @tparam TOffset Register offset type of the register map
+     * @tparam first Offset of the first cached register
+     * @tparam count Number of cached registers
+     * @tparam Policy See DefaultCachePolicy
+     * @tparam TValue Register type, all cached registers have the same type
+     */
+    template<
+        class TOffset,
+        TOffset first,
+        std::size_t count,
+        class Policy = DefaultCachePolicy,
+        class TValue = std::uint8_t>
+    class RegisterCache
+    {
+    public:
+        using Offset = TOffset;
+        using Value = TValue;
+        static constexpr std::size_t size = count;
+
+        static constexpr bool isCached(TOffset offset)
+        {
+            return offset >= first
+                && static_cast<std::size_t>(offset - first) < count
+                && !Policy::isVolatile(offset);
+        }
+
+        static constexpr TOffset burstOffset(TOffset offset)
+        {
+            return Policy::burstOffset(offset);
+        }
+
+        bool isValid(TOffset offset) const
+        {
+            return valid_[index(offset)];
+        }
+
+        bool isDirty(TOffset offset) const
+        {
+            return dirty_[index(offset)];
+        }
+
+        TValue get(TOffset offset) const
+        {
+            return values_[index(offset)];
+        }
+
+        // Store a value read from the device
+        void fill(TOffset offset, TValue value)
+        {
+            values_[index(offset)] = value;
+            valid_[index(offset)] = true;
+        }
+
+        // Store a value that is to be written to the device
+        void set(TOffset offset, TValue value)
+        {
+            values_[index(offset)] = value;
+            valid_[index(offset)] = true;
+            dirty_[index(offset)] = true;
+        }
+
+        bool hasDirty() const
+        {
+            for (bool dirty : dirty_)
+            {
+                if (dirty)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * Forget all values, e.g. after the device has been reset.
+         * Values that have not been written are lost.
+         */
+        void invalidate()
+        {
+            valid_.fill(false);
+            dirty_.fill(false);
+        }
+
+        /**
+         * Copy the values of the first run of contiguous dirty registers to
+         * values, and mark them clean.
+         *
+         * @param offset Set to the offset of the first register of the run
+         * @return The number of registers in the run, 0 if none is dirty
+         */
+        std::size_t takeDirtyRun(TOffset & offset, TValue * values)
+        {
+            std::size_t i = 0;
+            while (i < count && !dirty_[i])
+            {
+                ++i;
+            }
+
+            std::size_t length = 0;
+            for (; i + length < count && dirty_[i + length]; ++length)
+            {
+                values[length] = values_[i + length];
+                dirty_[i + length] = false;
+            }
+
+            offset = static_cast<TOffset>(first + i);
+            return length;
+        }
+
+        // Mark a run dirty again, after it failed to be written
+        void markDirty(TOffset offset, std::size_t length)
+        {
+            for (std::size_t i = 0; i < length; ++i)
+            {
+                dirty_[index(offset) + i] = true;
+            }
+        }
+
+    private:
+        static constexpr std::size_t index(TOffset offset)
+        {
+            return static_cast<std::size_t>(offset - first);
+        }
+
+        std::array<TValue, count> values_ = {};
+        std::array<bool, count> valid_ = {};
+        std::array<bool, count> dirty_ = {};
+    };
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include "detail/timers.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace schedulers
+{
+    /**
+     * Timer backend that stores the timed tasks in a fixed size array.
+     * Both insertion and polling scan the whole array, so the cost
+     * grows linearly with NTimers. It has the smallest footprint of
+     * the timer backends and is a good choice for a handful of timers.
+     */
+    template<std::uint32_t NTimers>
+    class ArrayTimerQueue
+    {
+        struct FutureTask
+        {
+            detail::TimedFunctionType func;
+            std::uint32_t executeAtTick;
+        };
+
+    public:
+        bool insert(std::uint32_t executeAtTick, detail::TimedFunctionType func)
+        {
+            // Assign to the first unassigned slot
+            for (auto & futureTask : futureTasks_)
+            {
+                if (!futureTask.func)
+                {
+                    futureTask.executeAtTick = executeAtTick;
+                    futureTask.func = func;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * Run the timers that are due at currentTick. onTimerRun is called
+         * with the lateness (in ticks) of each timer before it is run.
+         */
+        template<class F = detail::IgnoreTimerLateness>
+        void runDue(std::uint32_t currentTick, std::uint32_t ticksPerMs, F && onTimerRun = {})
+        {
+            for (auto & task : futureTasks_)
+            {
+                if (task.func && detail::tickIsDue(task.executeAtTick, currentTick))
+                {
+                    onTimerRun(currentTick - task.executeAtTick);
+                    int delayUntilNext = task.func();
+                    if (delayUntilNext > 0)
+                    {
+                        task.executeAtTick = currentTick + delayUntilNext * ticksPerMs;
+                    }
+                    else
+                    {
+                        task.func.reset();
+                    }
+                }
+            }
+        }
+
+        /**
+         * Number of ticks from currentTick until the next timer is due, 
+         * or maxTicks if no timer is due within maxTicks ticks.
+         */
+        std::uint32_t ticksUntilNextDeadline(std::uint32_t currentTick, std::uint32_t maxTicks) const
+        {
+            std::uint32_t ticks = maxTicks;
+            for (auto & task : futureTasks_)
+            {
+                if (task.func)
+                {
+                    if (detail::tickIsDue(task.executeAtTick, currentTick))
+                    {
+                        return 0U;
+                    }
+                    ticks = std::min(ticks, task.executeAtTick - currentTick);
+                }
+            }
+            return ticks;
+        }
+
+    private:
+        std::array<FutureTask, NTimers> futureTasks_ = {};
+    };
+}
@@ -1,22 +1,66 @@
 #pragma once
 #include "types.hpp"
 #include "delegate.hpp"
-#include "cont/circular_queue.hpp"
+#include "cont/mpsc_queue.hpp"
 #include "async/event.hpp"
 #include "board/interrupts.hpp"
+#include "array_timer_queue.hpp"
+#include "detail/timers.hpp"
+#include "tickless.hpp"
+#include "instrumentation.hpp"
+#include "async/scheduler.hpp"
 #include <array>
+#include <type_traits>
 
 namespace schedulers
 {
-    template<std::uint32_t NTasks, std::uint32_t NTimers, class InterruptController, std::uint32_t ticksPerMs = 1U>
-    class CooperativeScheduler : async::EventHandlerImpl<CooperativeScheduler<NTasks, NTimers, InterruptController, ticksPerMs>>
+    /**
+     * Counters of the work done by the scheduler's poll functions
+     */
+    struct PollStatistics
     {
-        using TimedFunctionType = Delegate<int(void)>;
-        struct FutureTask
-        {
-            TimedFunctionType func;
-            std::uint32_t executeAtTick;
-        };
+        // Number of calls to poll, pollBatch and runUntilIdle
+        std::uint32_t polls = 0;
+        // Number of polls that found no queued task to run
+        std::uint32_t idlePolls = 0;
+        // Total number of queued tasks run
+        std::uint32_t tasksRun = 0;
+        // Highest number of tasks run by a single poll
+        std::uint32_t maxTasksPerPoll = 0;
+    };
+
+    /**
+     * Scheduler that runs posted tasks and timers from a polling loop.
+     * 
+     * Tasks may be posted from any context (including nested interrupts) 
+     * without disabling interrupts, the task queues are lock-free.
+     * 
+     * Each priority lane has its own task queue. Queued tasks are run from 
+     * the lane with the highest priority (lane 0) first, so a high priority 
+     * task waits for at most the currently running task. Tasks posted 
+     * without a priority go to the lowest priority lane.
+     * 
+     * @tparam NTasks Capacity of each task queue, must be a power of two
+     * @tparam NTimers Maximum number of concurrently active timers
+     * @tparam InterruptController Interrupt control of the board
+     * @tparam ticksPerMs Frequency of the timer event
+     * @tparam TimerQueue Timer backend, either ArrayTimerQueue (default) or TimerWheel
+     * @tparam NLanes Number of priority lanes
+     * @tparam Instrumentation Instrumentation policy, either NoInstrumentation (default) 
+     * or SchedulerInstrumentation
+     */
+    template<
+        std::uint32_t NTasks, 
+        std::uint32_t NTimers, 
+        class InterruptController, 
+        std::uint32_t ticksPerMs = 1U,
+        template<std::uint32_t> class TimerQueue = ArrayTimerQueue,
+        std::uint8_t NLanes = 1U,
+        class Instrumentation = NoInstrumentation>
+    class CooperativeScheduler : async::EventHandlerImpl<CooperativeScheduler<NTasks, NTimers, InterruptController, ticksPerMs, TimerQueue, NLanes, Instrumentation>>
+    {
+        static_assert(NLanes > 0U, "At least one priority lane is required");
+        using TimedFunctionType = detail::TimedFunctionType;
 
     public:
         using FunctionType = Delegate<void(void)>;
@@ -37,60 +81,167 @@ namespace schedulers
         CooperativeScheduler & operator=(const CooperativeScheduler &) = delete;
         CooperativeScheduler & operator=(CooperativeScheduler &&) = delete;
 
+        static constexpr async::Priority lowestPriority = NLanes - 1U;
+
         bool postFromISR(FunctionType func)
         {
-            return postImpl(func);
+            return pushTask(lowestPriority, func);
         }
 
         bool post(FunctionType func)
         {
-            InterruptController::disableIRQs();
-            bool ret = postImpl(func);
-            InterruptController::enableIRQs();
-            return ret;
+            return pushTask(lowestPriority, func);
+        }
+
+        /**
+         * Post a task to a priority lane. Priorities outside of the available
+         * lanes are posted to the lowest priority lane.
+         */
+        bool postFromISR(FunctionType func, async::Priority priority) requires (NLanes > 1U)
+        {
+            return pushTask(priority < NLanes ? priority : lowestPriority, func);
+        }
+
+        bool post(FunctionType func, async::Priority priority) requires (NLanes > 1U)
+        {
+            return postFromISR(func, priority);
         }
 
+        /**
+         * Run the due timers, followed by (at most) one queued task.
+         */
         void poll()
         {
+            pollBatch(1U);
+        }
+
+        /**
+         * Run the due timers, followed by up to maxTasks queued tasks. 
+         * 
+         * @param maxTasks Maximum number of queued tasks to run
+         * @param tasksPerTimerCheck Fairness between timed and queued work. If non-zero, 
+         * the timers are checked again after every tasksPerTimerCheck tasks, so that
+         * a large batch does not delay the timers. If zero, the timers are only 
+         * checked before the batch.
+         * @return The number of queued tasks that were run
+         */
+        std::uint32_t pollBatch(std::uint32_t maxTasks, std::uint32_t tasksPerTimerCheck = 0U)
+        {
+            if constexpr (Instrumentation::enabled)
+            {
+                instrumentation_.pollStarted(queuedTasks());
+            }
+
             // Run timed tasks first
-            auto currentTick = currentTick_;
-            for (auto & task : futureTasks_)
+            std::uint32_t timersRun = runTimers();
+
+            // Run enqueued tasks
+            std::uint32_t tasksRun = 0U;
+            QueuedTask task;
+            while (tasksRun < maxTasks && popTask(task))
             {
-                if (task.func && currentTick >= task.executeAtTick)
+                runTask(task);
+                ++tasksRun;
+
+                if (tasksPerTimerCheck != 0U && (tasksRun % tasksPerTimerCheck) == 0U)
                 {
-                    int delayUntilNext = task.func();
-                    if (delayUntilNext > 0)
-                    {
-                        task.executeAtTick = currentTick + delayUntilNext * ticksPerMs;
-                    }
-                    else
-                    {
-                        task.func.reset();
-                    }
+                    timersRun += runTimers();
                 }
             }
 
-            // Run enqueued tasks
-            if (headIndex_ != tailIndex_)
+            recordPoll(tasksRun);
+            if constexpr (Instrumentation::enabled)
             {
-                queue_[tailIndex_]();
-                tailIndex_ = (tailIndex_ + 1) % NTasks;
+                instrumentation_.pollEnded(tasksRun != 0U || timersRun != 0U);
             }
+            return tasksRun;
         }
 
-        bool postAfter(std::uint32_t delayMs, TimedFunctionType delegate)
+        /**
+         * Drain the task queue, including tasks that are posted while draining. 
+         * The timers are checked at least once every NTasks tasks.
+         * 
+         * @param tasksPerTimerCheck See pollBatch
+         * @return The number of queued tasks that were run
+         */
+        std::uint32_t runUntilIdle(std::uint32_t tasksPerTimerCheck = 0U)
         {
-            // Assign to the first unassigned slot
-            for (auto & futureTask : futureTasks_)
+            std::uint32_t totalTasksRun = 0U;
+            std::uint32_t tasksRun = 0U;
+            do
             {
-                if (!futureTask.func)
+                tasksRun = pollBatch(NTasks, tasksPerTimerCheck);
+                totalTasksRun += tasksRun;
+            } while (tasksRun != 0U);
+
+            return totalTasksRun;
+        }
+
+        /**
+         * Sleep until the next timer deadline or interrupt, if no tasks are queued.
+         * 
+         * The tick source is suspended until the next timer is due, so that the 
+         * processor is not woken up by every tick. The ticks that elapsed while
+         * sleeping are added to the tick count on wake-up. Meant to be called 
+         * from the main loop after the task queue has been drained, e.g:
+         * 
+         *   while (true)
+         *   {
+         *       scheduler.runUntilIdle();
+         *       scheduler.idle(tickSource, WaitForInterrupt{});
+         *   }
+         * 
+         * @param tickSource Source of the tick event passed to the constructor
+         * @param idleHook Called to sleep, should return when an interrupt has occurred
+         */
+        template<TickSource Source, class IdleHook>
+        void idle(Source & tickSource, IdleHook && idleHook)
+        {
+            // Interrupts are disabled so that a task posted after the queue has 
+            // been checked does not get stuck until the next wake-up. The idle 
+            // hook is still woken up by pending interrupts.
+            InterruptController::disableIRQs();
+            if (!hasQueuedTasks())
+            {
+                std::uint32_t ticks = timers_.ticksUntilNextDeadline(currentTick_, Source::maxSuspendTicks);
+                if (ticks > 1U)
                 {
-                    futureTask.executeAtTick = currentTick_ + delayMs * ticksPerMs;
-                    futureTask.func = delegate;
-                    return true;
+                    tickSource.suspendFor(ticks);
+                    idleHook();
+                    currentTick_ = currentTick_ + tickSource.resume();
+                }
+                else if (ticks == 1U)
+                {
+                    // Woken up by the next tick anyway
+                    idleHook();
                 }
             }
-            return false;
+            InterruptController::enableIRQs();
+        }
+
+        const PollStatistics & getStatistics() const
+        {
+            return statistics_;
+        }
+
+        void resetStatistics()
+        {
+            statistics_ = PollStatistics{};
+        }
+
+        const Instrumentation & getInstrumentation() const requires Instrumentation::enabled
+        {
+            return instrumentation_;
+        }
+
+        void resetInstrumentation() requires Instrumentation::enabled
+        {
+            instrumentation_.reset();
+        }
+
+        bool postAfter(std::uint32_t delayMs, TimedFunctionType delegate)
+        {
+            return timers_.insert(currentTick_ + delayMs * ticksPerMs, delegate);
         }
 
         void handleEvent()
@@ -99,32 +250,124 @@ namespace schedulers
         }
 
     private:
-        bool postImpl(FunctionType func)
+        // With instrumentation enabled, tasks are queued with the time they were posted
+        struct TimestampedTask
+        {
+            FunctionType func;
+            std::uint32_t postedAt;
+        };
+
+        using QueuedTask = std::conditional_t<Instrumentation::enabled, TimestampedTask, FunctionType>;
+
+        bool pushTask(async::Priority lane, FunctionType func)
+        {
+            if constexpr (Instrumentation::enabled)
+            {
+                return lanes_[lane].push(TimestampedTask{func, Instrumentation::now()});
+            }
+            else
+            {
+                return lanes_[lane].push(func);
+            }
+        }
+
+        void runTask(QueuedTask & task)
+        {
+            if constexpr (Instrumentation::enabled)
+            {
+                instrumentation_.taskStarted(task.postedAt);
+                task.func();
+            }
+            else
+            {
+                task();
+            }
+        }
+
+        // Returns the number of timers that were run if instrumentation is enabled, otherwise 0
+        std::uint32_t runTimers()
+        {
+            if constexpr (Instrumentation::enabled)
+            {
+                std::uint32_t timersRun = 0U;
+                timers_.runDue(currentTick_, ticksPerMs, [&](std::uint32_t lateness) {
+                    instrumentation_.timerRun(lateness);
+                    ++timersRun;
+                });
+                return timersRun;
+            }
+            else
+            {
+                timers_.runDue(currentTick_, ticksPerMs);
+                return 0U;
+            }
+        }
+
+        std::uint32_t queuedTasks() const
         {
-            std::uint_fast32_t nextHeadIndex = (headIndex_ + 1) % NTasks;
-            if (nextHeadIndex != tailIndex_) 
+            std::uint32_t count = 0U;
+            for (auto & lane : lanes_)
             {
-                queue_[headIndex_] = func;
-                headIndex_ = nextHeadIndex;
-                return true;
-            } 
-            else 
+                count += lane.size();
+            }
+            return count;
+        }
+
+        bool hasQueuedTasks() const
+        {
+            for (auto & lane : lanes_)
+            {
+                if (!lane.isEmpty())
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool popTask(QueuedTask & task)
+        {
+            for (auto & lane : lanes_)
+            {
+                if (lane.pop(task))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void recordPoll(std::uint32_t tasksRun)
+        {
+            ++statistics_.polls;
+            statistics_.tasksRun += tasksRun;
+            if (tasksRun == 0U)
+            {
+                ++statistics_.idlePolls;
+            }
+            else if (tasksRun > statistics_.maxTasksPerPoll)
             {
-                return false;
+                statistics_.maxTasksPerPoll = tasksRun;
             }
         }
 
-        FunctionType queue_[NTasks];
-        volatile std::uint_fast32_t headIndex_ = 0;
-        volatile std::uint_fast32_t tailIndex_ = 0;
-        std::array<FutureTask, NTimers> futureTasks_ = {};
+        std::array<cont::MpscQueue<QueuedTask, NTasks>, NLanes> lanes_;
+        TimerQueue<NTimers> timers_;
         volatile std::uint32_t currentTick_ = 0;
         async::EventEmitter timerEvent_;
+        PollStatistics statistics_;
+        [[no_unique_address]] Instrumentation instrumentation_;
     };
 
-    template<class Board>
+    template<
+        std::uint32_t NTasks = 16, 
+        std::uint32_t NTimers = 1, 
+        template<std::uint32_t> class TimerQueue = ArrayTimerQueue, 
+        std::uint8_t NLanes = 1U,
+        class Instrumentation = NoInstrumentation,
+        class Board>
     auto makeCooperativeScheduler(Board board)
-        -> CooperativeScheduler<16, 1, typename Board::InterruptController>
+        -> CooperativeScheduler<NTasks, NTimers, typename Board::InterruptController, 1U, TimerQueue, NLanes, Instrumentation>
     {
         // Enable SysTick interrupt with a frequency of 1 ms
         board.enableSysTickIRQ(uint32_c<1'000>);
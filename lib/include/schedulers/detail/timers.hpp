@@ -0,0 +1,27 @@
+#pragma once
+#include "delegate.hpp"
+#include <cstdint>
+
+namespace schedulers::detail
+{
+    // A timed function returns the delay (in ms) until it should
+    // be executed again, or a value <= 0 if it should be removed.
+    using TimedFunctionType = Delegate<int(void)>;
+
+    /**
+     * Check if a task scheduled for `executeAtTick` is due at `currentTick`.
+     * The comparison is made on the signed difference, so that it keeps
+     * working when the tick counter wraps around (as long as deadlines
+     * are less than 2^31 ticks into the future).
+     */
+    constexpr bool tickIsDue(std::uint32_t executeAtTick, std::uint32_t currentTick)
+    {
+        return static_cast<std::int32_t>(currentTick - executeAtTick) >= 0;
+    }
+
+    // Default timer observer, ignores how late (in ticks) a timer is run
+    struct IgnoreTimerLateness
+    {
+        constexpr void operator()(std::uint32_t) const { }
+    };
+}
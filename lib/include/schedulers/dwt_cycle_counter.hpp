@@ -0,0 +1,28 @@
+#pragma once
+#include "board/board.hpp"
+#include "reg/read.hpp"
+#include "reg/write.hpp"
+#include "reg/set.hpp"
+#include <cstdint>
+
+namespace schedulers
+{
+    /**
+     * Cycle counter based on the DWT cycle count register of the Cortex-M.
+     * enable() must be called once before the counter is used.
+     */
+    struct DwtCycleCounter
+    {
+        static void enable()
+        {
+            reg::set(board::Dcb{}, board::dcb::DEMCR::TRCENA);
+            reg::write(board::Dwt{}, board::dwt::CYCCNT::CYCCNT, uint32_c<0>);
+            reg::set(board::Dwt{}, board::dwt::CTRL::CYCCNTENA);
+        }
+
+        static std::uint32_t now()
+        {
+            return reg::read(board::Dwt{}, board::dwt::CYCCNT::CYCCNT);
+        }
+    };
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <type_traits>
+
+namespace schedulers
+{
+    /**
+     * Source of a free running cycle count, e.g. DwtCycleCounter on target
+     * or SteadyClockCycleCounter on the host. The counter may wrap around,
+     * only differences between two counts are used.
+     */
+    template<class T>
+    concept CycleCounter = requires {
+        { T::now() } -> std::same_as<std::uint32_t>;
+    };
+
+    /**
+     * Instrumentation policy that records nothing. The scheduler
+     * compiles the instrumentation out when this policy is used.
+     */
+    struct NoInstrumentation
+    {
+        static constexpr bool enabled = false;
+    };
+
+    /**
+     * Measurements of a scheduler. Trivially copyable, so that it can be
+     * sent as is, e.g. over a UART.
+     *
+     * Bucket i of the latency histogram counts the tasks that were run
+     * between 2^(i-1) and 2^i - 1 cycles after they were posted (bucket 0
+     * counts the tasks with zero latency). The last bucket also counts all
+     * longer latencies.
+     *
+     * The cycle sums are 64 bit, a 32 bit sum would wrap after about 25 s
+     * at 168 MHz.
+     */
+    template<std::uint32_t NLatencyBuckets>
+    struct InstrumentationSnapshot
+    {
+        // Cycles spent in polls that ran tasks or timers
+        std::uint64_t busyCycles = 0;
+        // Cycles spent in polls without work and in between polls
+        std::uint64_t idleCycles = 0;
+        // Highest number of queued tasks seen at the start of a poll
+        std::uint32_t queueHighWaterMark = 0;
+        // Highest post-to-execution latency, in cycles
+        std::uint32_t maxLatency = 0;
+        std::array<std::uint32_t, NLatencyBuckets> latencyHistogram = {};
+        // Number of timers that were run after their deadline
+        std::uint32_t lateTimers = 0;
+        // Highest timer lateness, in ticks
+        std::uint32_t maxTimerLateness = 0;
+    };
+
+    /**
+     * Instrumentation policy that measures the load and latencies of a
+     * scheduler. The hooks are called by the scheduler, use snapshot()
+     * to read the measurements.
+     *
+     * @tparam Counter Cycle counter
+     * @tparam NLatencyBuckets Number of buckets of the latency histogram
+     */
+    template<CycleCounter Counter, std::uint32_t NLatencyBuckets = 16U>
+    class SchedulerInstrumentation
+    {
+        static_assert(NLatencyBuckets > 0U && NLatencyBuckets <= 33U, "Invalid number of latency buckets");
+
+    public:
+        using Snapshot = InstrumentationSnapshot<NLatencyBuckets>;
+        static_assert(std::is_trivially_copyable_v<Snapshot>);
+
+        static constexpr bool enabled = true;
+
+        static std::uint32_t now()
+        {
+            return Counter::now();
+        }
+
+        void pollStarted(std::uint32_t queuedTasks)
+        {
+            pollStartedAt_ = Counter::now();
+            snapshot_.idleCycles += pollStartedAt_ - lastPollEndedAt_;
+            if (queuedTasks > snapshot_.queueHighWaterMark)
+            {
+                snapshot_.queueHighWaterMark = queuedTasks;
+            }
+        }
+
+        void pollEnded(bool didWork)
+        {
+            lastPollEndedAt_ = Counter::now();
+            std::uint32_t cycles = lastPollEndedAt_ - pollStartedAt_;
+            if (didWork)
+            {
+                snapshot_.busyCycles += cycles;
+            }
+            else
+            {
+                snapshot_.idleCycles += cycles;
+            }
+        }
+
+        void taskStarted(std::uint32_t postedAt)
+        {
+            std::uint32_t latency = Counter::now() - postedAt;
+            if (latency > snapshot_.maxLatency)
+            {
+                snapshot_.maxLatency = latency;
+            }
+
+            std::uint32_t bucket = static_cast<std::uint32_t>(std::bit_width(latency));
+            ++snapshot_.latencyHistogram[bucket < NLatencyBuckets ? bucket : NLatencyBuckets - 1U];
+        }
+
+        void timerRun(std::uint32_t latenessTicks)
+        {
+            if (latenessTicks > 0U)
+            {
+                ++snapshot_.lateTimers;
+                if (latenessTicks > snapshot_.maxTimerLateness)
+                {
+                    snapshot_.maxTimerLateness = latenessTicks;
+                }
+            }
+        }
+
+        const Snapshot & snapshot() const
+        {
+            return snapshot_;
+        }
+
+        void reset()
+        {
+            snapshot_ = Snapshot{};
+            lastPollEndedAt_ = Counter::now();
+        }
+
+    private:
+        Snapshot snapshot_;
+        std::uint32_t pollStartedAt_ = 0;
+        std::uint32_t lastPollEndedAt_ = Counter::now();
+    };
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+namespace schedulers
+{
+    /**
+     * Host cycle counter based on std::chrono::steady_clock, 
+     * one "cycle" is one nanosecond.
+     */
+    struct SteadyClockCycleCounter
+    {
+        static std::uint32_t now()
+        {
+            auto time = std::chrono::steady_clock::now().time_since_epoch();
+            return static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time).count());
+        }
+    };
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include "tickless.hpp"
+#include "board/board.hpp"
+#include "reg/read.hpp"
+#include "reg/write.hpp"
+#include "reg/set.hpp"
+#include "reg/clear.hpp"
+#include "reg/bit_is_set.hpp"
+#include <algorithm>
+#include <cstdint>
+
+namespace schedulers
+{
+    /**
+     * Tick source for tickless idle based on the SysTick timer. Expects
+     * SysTick to be clocked by the processor clock, as set up by
+     * Board::enableSysTickIRQ.
+     *
+     * The reload value is 24 bits, which limits how long the tick can
+     * be suspended (e.g. 99 ticks of 1 ms at 168 MHz).
+     *
+     * @tparam cyclesPerTick Number of processor cycles in one tick
+     */
+    template<std::uint32_t cyclesPerTick>
+    class SysTickSource
+    {
+        static_assert(cyclesPerTick > 1U, "Tick frequency is too high");
+        static_assert(cyclesPerTick <= 0x1000000U, "Tick frequency is too low");
+
+        using Stk = board::Stk;
+
+    public:
+        static constexpr std::uint32_t maxSuspendTicks = 0x1000000U / cyclesPerTick;
+
+        void suspendFor(std::uint32_t ticks)
+        {
+            ticks = std::clamp(ticks, 1U, maxSuspendTicks);
+
+            reg::clear(Stk{}, board::stk::CTRL::ENABLE);
+
+            // Keep the phase of the tick, the first tick ends when the
+            // current count reaches zero
+            firstTickCycles_ = reg::read(Stk{}, board::stk::VAL::CURRENT);
+            if (firstTickCycles_ == 0U)
+            {
+                firstTickCycles_ = cyclesPerTick;
+            }
+            suspendedTicks_ = ticks;
+            reload_ = firstTickCycles_ + (ticks - 1U) * cyclesPerTick - 1U;
+
+            reg::write(Stk{}, board::stk::LOAD::RELOAD, reload_);
+            reg::write(Stk{}, board::stk::VAL::CURRENT, uint32_c<0>);
+            reg::set(Stk{}, board::stk::CTRL::ENABLE);
+        }
+
+        std::uint32_t resume()
+        {
+            // COUNTFLAG is cleared when CTRL is read, so check it first
+            bool expired = reg::bitIsSet(Stk{}, board::stk::CTRL::COUNTFLAG);
+            reg::clear(Stk{}, board::stk::CTRL::ENABLE);
+
+            std::uint32_t elapsedTicks = 0U;
+            std::uint32_t cyclesLeftOfTick = cyclesPerTick;
+            if (expired)
+            {
+                // The last tick is signalled by the pending tick interrupt
+                elapsedTicks = suspendedTicks_ - 1U;
+            }
+            else
+            {
+                // Woken up by another interrupt
+                std::uint32_t elapsedCycles = reload_ - reg::read(Stk{}, board::stk::VAL::CURRENT);
+                if (elapsedCycles < firstTickCycles_)
+                {
+                    cyclesLeftOfTick = firstTickCycles_ - elapsedCycles;
+                }
+                else
+                {
+                    elapsedCycles -= firstTickCycles_;
+                    elapsedTicks = 1U + elapsedCycles / cyclesPerTick;
+                    cyclesLeftOfTick = cyclesPerTick - elapsedCycles % cyclesPerTick;
+                }
+            }
+
+            // Finish the current tick, the periodic reload value is
+            // used from the next reload on
+            reg::write(Stk{}, board::stk::LOAD::RELOAD, std::max(cyclesLeftOfTick, 2U) - 1U);
+            reg::write(Stk{}, board::stk::VAL::CURRENT, uint32_c<0>);
+            reg::set(Stk{}, board::stk::CTRL::ENABLE);
+            reg::write(Stk{}, board::stk::LOAD::RELOAD, uint32_c<cyclesPerTick - 1U>);
+
+            return elapsedTicks;
+        }
+
+    private:
+        std::uint32_t firstTickCycles_ = cyclesPerTick;
+        std::uint32_t suspendedTicks_ = 0U;
+        std::uint32_t reload_ = cyclesPerTick - 1U;
+    };
+
+    /**
+     * Create a SysTick tick source for the tick frequency used by
+     * makeCooperativeScheduler (1 kHz).
+     */
+    template<std::uint32_t tickFrequency = 1'000U, class Board>
+    constexpr auto makeSysTickSource(const Board &)
+        -> SysTickSource<round(Board{}.getSystemClockFrequency() / tickFrequency)>
+    {
+        return {};
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <concepts>
+#include <cstdint>
+
+namespace schedulers
+{
+    /**
+     * Tick source that can be suspended while the scheduler idles.
+     *
+     * suspendFor(ticks) reprograms the source so that the next tick
+     * interrupt occurs after `ticks` ticks (at most maxSuspendTicks),
+     * instead of after every tick. resume() restores the periodic tick and
+     * returns the number of ticks that elapsed while suspended and that
+     * will not be signalled by a tick interrupt. A tick interrupt that
+     * ended the suspension is thus not included.
+     */
+    template<class T>
+    concept TickSource = requires(T & tickSource, std::uint32_t ticks) {
+        { T::maxSuspendTicks } -> std::convertible_to<std::uint32_t>;
+        { tickSource.suspendFor(ticks) };
+        { tickSource.resume() } -> std::same_as<std::uint32_t>;
+    };
+
+    /**
+     * Idle hook that sleeps until the next interrupt. Does nothing
+     * when not built for an ARM target.
+     */
+    struct WaitForInterrupt
+    {
+        void operator()() const
+        {
+#if defined(__ARM_ARCH)
+            asm volatile ("wfi" : : : "memory");
+#endif
+        }
+    };
+}
@@ -0,0 +1,236 @@
+#pragma once
+#include "detail/timers.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace schedulers
+{
+    /**
+     * Timer backend based on a hierarchical timer wheel.
+     *
+     * Level n of the wheel has 64 slots, each covering 64^n ticks. A timer
+     * is placed in the level matching how far into the future it expires,
+     * and is moved down ("cascaded") to a lower level once the wheel gets
+     * close enough. Insertion is O(1), polling when nothing is due is O(1)
+     * and each elapsed tick costs O(1) amortized.
+     *
+     * The timers are stored in intrusive linked lists over a fixed pool of
+     * NTimers nodes, so no memory is allocated.
+     */
+    template<std::uint32_t NTimers>
+    class TimerWheel
+    {
+        static_assert(NTimers < 0xFFFFU, "Too many timers");
+
+        using Index = std::conditional_t<(NTimers < 0xFFU), std::uint8_t, std::uint16_t>;
+        static constexpr Index NIL = std::numeric_limits<Index>::max();
+
+        static constexpr std::uint32_t slotBits = 6U;
+        static constexpr std::uint32_t slotsPerLevel = 1U << slotBits;
+        static constexpr std::uint32_t slotMask = slotsPerLevel - 1U;
+        static constexpr std::uint32_t levels = (32U + slotBits - 1U) / slotBits;
+
+        struct Node
+        {
+            detail::TimedFunctionType func;
+            std::uint32_t executeAtTick;
+            Index next;
+        };
+
+    public:
+        TimerWheel()
+        {
+            for (auto & level : slots_)
+            {
+                level.fill(NIL);
+            }
+
+            for (std::uint32_t i = 0; i < NTimers; ++i)
+            {
+                nodes_[i].next = (i + 1U < NTimers) ? static_cast<Index>(i + 1U) : NIL;
+            }
+            freeList_ = NTimers > 0U ? 0U : NIL;
+        }
+
+        TimerWheel(const TimerWheel &) = delete;
+        TimerWheel(TimerWheel &&) = delete;
+        TimerWheel & operator=(const TimerWheel &) = delete;
+        TimerWheel & operator=(TimerWheel &&) = delete;
+
+        bool insert(std::uint32_t executeAtTick, detail::TimedFunctionType func)
+        {
+            if (freeList_ == NIL)
+            {
+                return false;
+            }
+
+            Index node = freeList_;
+            freeList_ = nodes_[node].next;
+            nodes_[node].func = func;
+            nodes_[node].executeAtTick = executeAtTick;
+            link(node);
+            ++activeTimers_;
+            return true;
+        }
+
+        /**
+         * Run the timers that are due at currentTick. onTimerRun is called
+         * with the lateness (in ticks) of each timer before it is run.
+         */
+        template<class F = detail::IgnoreTimerLateness>
+        void runDue(std::uint32_t currentTick, std::uint32_t ticksPerMs, F && onTimerRun = {})
+        {
+            if (activeTimers_ == 0U)
+            {
+                // Nothing can expire, just move the wheel forward
+                nextTick_ = currentTick + 1U;
+                return;
+            }
+
+            while (detail::tickIsDue(nextTick_, currentTick))
+            {
+                std::uint32_t index = nextTick_ & slotMask;
+                if (index == 0U)
+                {
+                    cascade();
+                }
+
+                if ((occupied_[0] & (std::uint64_t{1} << index)) == 0U)
+                {
+                    // Skip the empty slots, but stop at the end of the rotation
+                    // so that the upper levels are cascaded in time
+                    std::uint64_t pending = occupied_[0] >> index;
+                    std::uint32_t skip = pending != 0U
+                        ? static_cast<std::uint32_t>(std::countr_zero(pending))
+                        : slotsPerLevel - index;
+                    nextTick_ += std::min(skip, currentTick - nextTick_ + 1U);
+                    continue;
+                }
+
+                // Advance before running the timers, timers that are (re)inserted
+                // as already due will then expire on the next tick.
+                Index node = detach(0U, index);
+                ++nextTick_;
+                while (node != NIL)
+                {
+                    Index next = nodes_[node].next;
+                    onTimerRun(currentTick - nodes_[node].executeAtTick);
+                    int delayUntilNext = nodes_[node].func();
+                    if (delayUntilNext > 0)
+                    {
+                        nodes_[node].executeAtTick = currentTick + delayUntilNext * ticksPerMs;
+                        link(node);
+                    }
+                    else
+                    {
+                        release(node);
+                    }
+                    node = next;
+                }
+            }
+        }
+
+        /**
+         * Number of ticks from currentTick until the next timer is due, 
+         * or maxTicks if no timer is due within maxTicks ticks.
+         * 
+         * Timers in the upper levels are not looked up, the end of the 
+         * current rotation of the lowest level is used instead. The result
+         * may thus be earlier than the actual deadline (by less than 64 
+         * ticks), but never later.
+         */
+        std::uint32_t ticksUntilNextDeadline(std::uint32_t currentTick, std::uint32_t maxTicks) const
+        {
+            if (activeTimers_ == 0U)
+            {
+                return maxTicks;
+            }
+
+            std::uint32_t index = nextTick_ & slotMask;
+            std::uint64_t pending = occupied_[0] >> index;
+            std::uint32_t deadline = nextTick_ + (pending != 0U
+                ? static_cast<std::uint32_t>(std::countr_zero(pending))
+                : slotsPerLevel - index);
+
+            if (detail::tickIsDue(deadline, currentTick))
+            {
+                return 0U;
+            }
+            return std::min(deadline - currentTick, maxTicks);
+        }
+
+    private:
+        void link(Index node)
+        {
+            std::uint32_t executeAtTick = nodes_[node].executeAtTick;
+            std::uint32_t ticksLeft = executeAtTick - nextTick_;
+            std::uint32_t level = 0U;
+            std::uint32_t index = 0U;
+
+            if (static_cast<std::int32_t>(ticksLeft) < 0)
+            {
+                // Already due, expire on the next processed tick
+                index = nextTick_ & slotMask;
+            }
+            else
+            {
+                level = ticksLeft == 0U ? 0U : (static_cast<std::uint32_t>(std::bit_width(ticksLeft)) - 1U) / slotBits;
+                index = (executeAtTick >> (level * slotBits)) & slotMask;
+            }
+
+            nodes_[node].next = slots_[level][index];
+            slots_[level][index] = node;
+            occupied_[level] |= std::uint64_t{1} << index;
+        }
+
+        Index detach(std::uint32_t level, std::uint32_t index)
+        {
+            Index head = slots_[level][index];
+            slots_[level][index] = NIL;
+            occupied_[level] &= ~(std::uint64_t{1} << index);
+            return head;
+        }
+
+        void release(Index node)
+        {
+            nodes_[node].func.reset();
+            nodes_[node].next = freeList_;
+            freeList_ = node;
+            --activeTimers_;
+        }
+
+        // Called when level 0 wraps around. Moves the timers of the current
+        // slot in level 1 down to level 0, and continues to the next level
+        // as long as the current level has also wrapped around.
+        void cascade()
+        {
+            for (std::uint32_t level = 1U; level < levels; ++level)
+            {
+                std::uint32_t index = (nextTick_ >> (level * slotBits)) & slotMask;
+                Index node = detach(level, index);
+                while (node != NIL)
+                {
+                    Index next = nodes_[node].next;
+                    link(node);
+                    node = next;
+                }
+
+                if (index != 0U)
+                {
+                    break;
+                }
+            }
+        }
+
+        std::array<Node, NTimers> nodes_;
+        std::array<std::array<Index, slotsPerLevel>, levels> slots_;
+        std::array<std::uint64_t, levels> occupied_ = {};
+        std::uint32_t nextTick_ = 0U;
+        std::uint32_t activeTimers_ = 0U;
+        Index freeList_;
+    };
+}
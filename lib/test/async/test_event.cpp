@@ -30,4 +30,137 @@ TEST_CASE("Event")
         event.raise();
         REQUIRE(!handlerCalled);
     }
-}
\ No newline at end of file
+
+    SECTION("Unsubscribing a handler should only unsubscribe the subscribed handler")
+    {
+        auto other = async::makeEventHandler([]() { });
+        emitter.subscribe(&handler);
+
+        REQUIRE(emitter.unsubscribe(&other) == false);
+        event.raise();
+        REQUIRE(handlerCalled);
+
+        REQUIRE(emitter.unsubscribe(&handler));
+        REQUIRE(!event);
+    }
+}
+
+namespace
+{
+    struct CountingHandler : async::EventHandlerImpl<CountingHandler, async::MultipleSubscribers>
+    {
+        void handleEvent() 
+        { 
+            ++callCount; 
+            if (unsubscribeOnEvent)
+            {
+                emitter.unsubscribe(this);
+            }
+        }
+
+        async::MulticastEventEmitter emitter;
+        int callCount = 0;
+        bool unsubscribeOnEvent = false;
+    };
+}
+
+TEST_CASE("Multicast event")
+{
+    async::MulticastEvent event;
+    async::MulticastEventEmitter emitter{&event};
+    CountingHandler handler1{{}, emitter};
+    CountingHandler handler2{{}, emitter};
+    int lambdaCallCount = 0;
+    auto handler3 = async::makeMulticastEventHandler([&]() {
+        ++lambdaCallCount;
+    });
+
+    SECTION("Should call all subscribed handlers")
+    {
+        REQUIRE(emitter.subscribe(&handler1));
+        REQUIRE(emitter.subscribe(&handler2));
+        REQUIRE(emitter.subscribe(&handler3));
+        REQUIRE(event);
+
+        event.raise();
+        event.raise();
+
+        REQUIRE(handler1.callCount == 2);
+        REQUIRE(handler2.callCount == 2);
+        REQUIRE(lambdaCallCount == 2);
+    }
+
+    SECTION("Subscribing a handler twice should return false for the second call")
+    {
+        REQUIRE(emitter.subscribe(&handler1));
+        REQUIRE(emitter.subscribe(&handler1) == false);
+
+        event.raise();
+        REQUIRE(handler1.callCount == 1);
+    }
+
+    SECTION("Should only call the handlers that are still subscribed")
+    {
+        emitter.subscribe(&handler1);
+        emitter.subscribe(&handler2);
+        emitter.subscribe(&handler3);
+
+        REQUIRE(emitter.unsubscribe(&handler2));
+        REQUIRE(emitter.unsubscribe(&handler2) == false);
+        event.raise();
+        REQUIRE(handler1.callCount == 1);
+        REQUIRE(handler2.callCount == 0);
+        REQUIRE(lambdaCallCount == 1);
+
+        REQUIRE(emitter.unsubscribe(&handler1));
+        REQUIRE(emitter.unsubscribe(&handler3));
+        REQUIRE(!event);
+        event.raise();
+        REQUIRE(handler1.callCount == 1);
+        REQUIRE(lambdaCallCount == 1);
+    }
+
+    SECTION("Should allow handlers to unsubscribe themselves while the event is raised")
+    {
+        handler1.unsubscribeOnEvent = true;
+        handler2.unsubscribeOnEvent = true;
+        emitter.subscribe(&handler1);
+        emitter.subscribe(&handler2);
+        emitter.subscribe(&handler3);
+
+        event.raise();
+        event.raise();
+
+        REQUIRE(handler1.callCount == 1);
+        REQUIRE(handler2.callCount == 1);
+        REQUIRE(lambdaCallCount == 2);
+    }
+
+    SECTION("Should allow a handler to resubscribe after unsubscribing")
+    {
+        emitter.subscribe(&handler1);
+        emitter.unsubscribe(&handler1);
+        REQUIRE(emitter.subscribe(&handler1));
+
+        event.raise();
+        REQUIRE(handler1.callCount == 1);
+    }
+
+    SECTION("A handler destroyed while subscribed should unlink itself")
+    {
+        emitter.subscribe(&handler1);
+        {
+            CountingHandler temporary{{}, emitter};
+            emitter.subscribe(&temporary);
+        }
+        emitter.subscribe(&handler2);
+
+        event.raise();
+        REQUIRE(handler1.callCount == 1);
+        REQUIRE(handler2.callCount == 1);
+
+        emitter.unsubscribe(&handler1);
+        emitter.unsubscribe(&handler2);
+        REQUIRE(!event);
+    }
+}
@@ -0,0 +1,80 @@
+#include "../catch.hpp"
+#include "board/static_interrupts.hpp"
+#include "async/event.hpp"
+
+namespace
+{
+    int staticCallCount = 0;
+}
+
+template<>
+struct board::StaticInterruptHandler<board::Interrupts::DMA1_Stream5>
+{
+    static void handle() { ++staticCallCount; }
+};
+
+TEST_CASE("Static interrupt dispatch")
+{
+    staticCallCount = 0;
+    async::Event event;
+    async::EventEmitter emitter{&event};
+    int eventCallCount = 0;
+    auto handler = async::makeEventHandler([&]() { ++eventCallCount; });
+    emitter.subscribe(&handler);
+
+    SECTION("Should only report the bound interrupts as statically bound")
+    {
+        STATIC_REQUIRE(board::StaticallyBoundInterrupt<board::Interrupts::DMA1_Stream5>);
+        STATIC_REQUIRE(!board::StaticallyBoundInterrupt<board::Interrupts::DMA1_Stream6>);
+    }
+
+    SECTION("Should call the statically bound handler directly")
+    {
+        board::dispatchInterrupt(board::Interrupts::DMA1_Stream5, event);
+
+        REQUIRE(staticCallCount == 1);
+        REQUIRE(eventCallCount == 0);
+    }
+
+    SECTION("Should raise the event of interrupts without a static handler")
+    {
+        board::dispatchInterrupt(board::Interrupts::DMA1_Stream6, event);
+        board::dispatchInterrupt(board::Interrupts::SysTick, event);
+
+        REQUIRE(staticCallCount == 0);
+        REQUIRE(eventCallCount == 2);
+    }
+
+    SECTION("Subscribing to the event of a statically bound interrupt should fail")
+    {
+        async::Event boundEvent;
+        async::EventEmitter boundEmitter{&boundEvent};
+
+        REQUIRE(board::reserveStaticallyBoundEvent(board::Interrupts::DMA1_Stream5, boundEvent));
+        REQUIRE(!board::reserveStaticallyBoundEvent(board::Interrupts::DMA1_Stream6, event));
+
+        auto otherHandler = async::makeEventHandler([]() { });
+        REQUIRE(!boundEmitter.subscribe(&otherHandler));
+        REQUIRE(emitter.unsubscribe(&handler));
+        REQUIRE(emitter.subscribe(&otherHandler));
+    }
+
+    SECTION("Should raise the multicast event of multicast interrupts")
+    {
+        STATIC_REQUIRE(board::isMulticastInterrupt<board::Interrupts::ADC>);
+        STATIC_REQUIRE(!board::isMulticastInterrupt<board::Interrupts::DMA1_Stream6>);
+
+        async::MulticastEventEmitter multicastEmitter{
+            &board::detail::multicastInterruptEvent<hana::value(board::Interrupts::ADC)>};
+        int multicastCallCount = 0;
+        auto handler1 = async::makeMulticastEventHandler([&]() { ++multicastCallCount; });
+        auto handler2 = async::makeMulticastEventHandler([&]() { ++multicastCallCount; });
+        REQUIRE(multicastEmitter.subscribe(&handler1));
+        REQUIRE(multicastEmitter.subscribe(&handler2));
+
+        board::dispatchInterrupt(board::Interrupts::ADC, event);
+
+        REQUIRE(multicastCallCount == 2);
+        REQUIRE(eventCallCount == 0);
+    }
+}
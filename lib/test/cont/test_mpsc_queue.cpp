@@ -0,0 +1,106 @@
+#include "../catch.hpp"
+#include "cont/mpsc_queue.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST_CASE("MpscQueue")
+{
+    SECTION("Should pop values in the order they were pushed")
+    {
+        cont::MpscQueue<int, 4> queue;
+        REQUIRE(queue.push(1));
+        REQUIRE(queue.push(2));
+
+        int value = 0;
+        REQUIRE(queue.pop(value));
+        REQUIRE(value == 1);
+        REQUIRE(queue.pop(value));
+        REQUIRE(value == 2);
+        REQUIRE(!queue.pop(value));
+        REQUIRE(queue.isEmpty());
+    }
+
+    SECTION("Should use the full capacity")
+    {
+        cont::MpscQueue<int, 4> queue;
+        for (int i = 0; i < 4; ++i)
+        {
+            REQUIRE(queue.push(i));
+        }
+        REQUIRE(!queue.push(4));
+
+        int value = 0;
+        REQUIRE(queue.pop(value));
+        REQUIRE(queue.push(4));
+    }
+
+    SECTION("Should keep working when the indices wrap around the buffer")
+    {
+        cont::MpscQueue<int, 2> queue;
+        int value = 0;
+        for (int i = 0; i < 100; ++i)
+        {
+            REQUIRE(queue.push(i));
+            REQUIRE(queue.pop(value));
+            REQUIRE(value == i);
+        }
+    }
+
+    SECTION("Should not lose values with concurrent producers")
+    {
+        // The threads stand in for interrupt handlers that preempt each other
+        constexpr std::uint32_t producerCount = 4;
+        constexpr std::uint32_t valuesPerProducer = 50'000;
+
+        struct Item
+        {
+            std::uint32_t producer;
+            std::uint32_t sequence;
+        };
+
+        cont::MpscQueue<Item, 64> queue;
+        std::atomic<bool> go = false;
+        std::vector<std::thread> producers;
+        for (std::uint32_t p = 0; p < producerCount; ++p)
+        {
+            producers.emplace_back([&, p]() {
+                while (!go) { }
+                for (std::uint32_t i = 0; i < valuesPerProducer; ++i)
+                {
+                    while (!queue.push(Item{p, i}))
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        go = true;
+        std::vector<std::uint32_t> nextExpected(producerCount, 0);
+        std::uint32_t received = 0;
+        bool inOrder = true;
+        while (received < producerCount * valuesPerProducer)
+        {
+            Item item;
+            if (queue.pop(item))
+            {
+                inOrder = inOrder && (item.sequence == nextExpected[item.producer]);
+                nextExpected[item.producer] = item.sequence + 1;
+                ++received;
+            }
+        }
+
+        for (auto & producer : producers)
+        {
+            producer.join();
+        }
+
+        REQUIRE(inOrder);
+        REQUIRE(queue.isEmpty());
+        for (auto count : nextExpected)
+        {
+            REQUIRE(count == valuesPerProducer);
+        }
+    }
+}
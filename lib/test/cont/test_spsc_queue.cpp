@@ -0,0 +1,126 @@
+#include "../catch.hpp"
+#include "cont/spsc_queue.hpp"
+#include <atomic>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+TEST_CASE("SpscQueue")
+{
+    SECTION("Should pop values in the order they were pushed")
+    {
+        cont::SpscQueue<int, 4> queue;
+        REQUIRE(queue.push(1));
+        REQUIRE(queue.push(2));
+        REQUIRE(queue.size() == 2);
+
+        int value = 0;
+        REQUIRE(queue.pop(value));
+        REQUIRE(value == 1);
+        REQUIRE(queue.pop(value));
+        REQUIRE(value == 2);
+        REQUIRE(!queue.pop(value));
+        REQUIRE(queue.isEmpty());
+    }
+
+    SECTION("Should use the full capacity")
+    {
+        cont::SpscQueue<int, 4> queue;
+        for (int i = 0; i < 4; ++i)
+        {
+            REQUIRE(queue.push(i));
+        }
+        REQUIRE(!queue.push(4));
+
+        int value = 0;
+        REQUIRE(queue.pop(value));
+        REQUIRE(queue.push(4));
+    }
+
+    SECTION("Should push and pop in bulk across the end of the storage")
+    {
+        cont::SpscQueue<int, 8> queue;
+        int values[6] = {0, 1, 2, 3, 4, 5};
+        int result[8] = {};
+
+        REQUIRE(queue.pushN(values, 6) == 6);
+        REQUIRE(queue.popN(result, 4) == 4);
+
+        // Wraps around, only 6 of the values fit
+        REQUIRE(queue.pushN(values, 6) == 6);
+        REQUIRE(queue.pushN(values, 6) == 0);
+        REQUIRE(queue.size() == 8);
+
+        REQUIRE(queue.popN(result, 8) == 8);
+        REQUIRE(std::vector<int>(result, result + 8) == std::vector<int>{4, 5, 0, 1, 2, 3, 4, 5});
+        REQUIRE(queue.popN(result, 8) == 0);
+    }
+
+    SECTION("Should expose the free and filled regions as contiguous spans")
+    {
+        cont::SpscQueue<int, 8> queue;
+        int values[6] = {};
+        int result[8] = {};
+        queue.pushN(values, 6);
+        queue.popN(result, 6);
+
+        // The free region is split by the end of the storage
+        auto region = queue.acquireWrite();
+        REQUIRE(region.size() == 2);
+        region[0] = 10;
+        region[1] = 11;
+        queue.commitWrite(2);
+
+        region = queue.acquireWrite();
+        REQUIRE(region.size() == 6);
+        region[0] = 12;
+        queue.commitWrite(1);
+
+        auto readRegion = queue.acquireRead();
+        REQUIRE(std::vector<int>(readRegion.begin(), readRegion.end()) == std::vector<int>{10, 11});
+        queue.release(2);
+
+        readRegion = queue.acquireRead();
+        REQUIRE(std::vector<int>(readRegion.begin(), readRegion.end()) == std::vector<int>{12});
+        queue.release(1);
+
+        REQUIRE(queue.isEmpty());
+        REQUIRE(queue.acquireRead().empty());
+    }
+
+    SECTION("Should transfer values between concurrent producer and consumer")
+    {
+        // The producer thread stands in for an interrupt handler
+        constexpr std::uint32_t valueCount = 200'000;
+        cont::SpscQueue<std::uint32_t, 64> queue;
+
+        std::thread producer([&]() {
+            std::uint32_t next = 0;
+            while (next < valueCount)
+            {
+                auto region = queue.acquireWrite();
+                std::uint32_t count = std::min<std::uint32_t>(region.size(), valueCount - next);
+                std::iota(region.begin(), region.begin() + count, next);
+                queue.commitWrite(count);
+                next += count;
+            }
+        });
+
+        std::uint32_t expected = 0;
+        bool inOrder = true;
+        std::uint32_t buffer[16];
+        while (expected < valueCount)
+        {
+            std::uint32_t count = queue.popN(buffer, 16);
+            for (std::uint32_t i = 0; i < count; ++i)
+            {
+                inOrder = inOrder && (buffer[i] == expected);
+                ++expected;
+            }
+        }
+
+        producer.join();
+        REQUIRE(inOrder);
+        REQUIRE(queue.isEmpty());
+    }
+}
@@ -2,18 +2,31 @@
 #include "drivers/adc.hpp"
 #include "../mocks/mock_board.hpp"
 #include "../mocks/mock_peripheral.hpp"
+#include "drivers/dma.hpp"
+#include "async/inline_scheduler.hpp"
+#include "async/map.hpp"
+#include "async/receive.hpp"
+#include "async/use_scheduler.hpp"
+#include <cmath>
+#include <optional>
+#include <span>
+#include <vector>
 
 using MockAdc = MockPeripheral<board::adc::tag>;
 using MockGpio = MockPeripheral<board::gpio::tag>;
+using MockDma = MockPeripheral<board::dma::tag>;
+using MockCommonAdc = MockPeripheral<board::c_adc::tag>;
 
 namespace
 {
     async::Event adcInterruptEvent;
+    async::Event dmaInterruptEvent;
 
     struct MockPeripherals
     {
         constexpr MockGpio getPeripheral(PeripheralTypes::tags::Gpio<0>) const { return {}; }
         constexpr MockAdc getPeripheral(PeripheralTypes::tags::Adc<0>) const { return {}; }
+        constexpr MockCommonAdc getPeripheral(PeripheralTypes::tags::AdcCommon) const { return {}; }
 
         async::EventEmitter getInterruptEvent(decltype(board::Interrupts::ADC)) { return {&adcInterruptEvent}; }
     };
@@ -25,8 +38,580 @@ TEST_CASE("ADC")
 
     using namespace drivers::adc;
     
-    auto dev = makeAdc<AdcConfig<2> {
+    [[maybe_unused]] auto dev = makeAdc<AdcConfig<2> {
         .id = 0,
         .pins = { Pin(0, 0), Pin(0, 1) }
     }>(mockBoard);
-}
\ No newline at end of file
+}
+
+namespace
+{
+    // Runs the posted tasks inline, or rejects them like a full queue
+    struct RejectingScheduler
+    {
+        bool post(Delegate<void(void)> action)
+        {
+            return postFromISR(action);
+        }
+
+        bool postFromISR(Delegate<void(void)> action)
+        {
+            if (full)
+            {
+                return false;
+            }
+
+            action();
+            return true;
+        }
+
+        void poll() { }
+
+        bool full = false;
+    };
+
+    struct FrameReceiver
+    {
+        template<std::size_t N>
+        void setNext(std::span<const std::uint16_t, N> frame) &
+        {
+            frames.emplace_back(frame.begin(), frame.end());
+        }
+
+        void setError(drivers::adc::AdcError e) &&
+        {
+            error = e;
+        }
+
+        void setDone() &&
+        {
+            done = true;
+        }
+
+        friend RejectingScheduler & tag_invoke(async::getScheduler_t, const FrameReceiver & self)
+        {
+            return *self.scheduler;
+        }
+
+        RejectingScheduler * scheduler;
+        std::vector<std::vector<std::uint16_t>> & frames;
+        std::optional<drivers::adc::AdcError> & error;
+        bool & done;
+    };
+}
+
+TEST_CASE("ADC continuous read")
+{
+    using namespace drivers;
+    using namespace hana::literals;
+    resetPeripheral(MockAdc{});
+    resetPeripheral(MockDma{});
+
+    RejectingScheduler scheduler;
+    adc::Adc<MockAdc, 2, 4096> device{async::EventEmitter{&adcInterruptEvent}};
+    dma::Dma<MockDma, 0> dmaStream{async::EventEmitter{&dmaInterruptEvent}};
+    std::uint16_t buffer[4] = {10, 11, 20, 21};
+
+    std::vector<std::vector<std::uint16_t>> frames;
+    std::optional<adc::AdcError> error;
+    bool done = false;
+
+    auto op = async::subscribe(
+        device.readContinuous(dmaStream, buffer, adc::ExternalTrigger::TIMER3_TRGO),
+        FrameReceiver{&scheduler, frames, error, done});
+
+    auto raiseDmaFlag = [](auto flag) {
+        setRegisterBit(MockDma{}, flag);
+        dmaInterruptEvent.raise();
+        clearRegisterBit(MockDma{}, flag);
+    };
+
+    SECTION("ReadContinuous should return a stream")
+    {
+        using StreamType = decltype(device.readContinuous(dmaStream, buffer, adc::ExternalTrigger::TIMER3_TRGO));
+        STATIC_REQUIRE(async::Stream<StreamType, std::span<const std::uint16_t, 2>, adc::AdcError>);
+    }
+
+    SECTION("Should start timer triggered scans into a circular transfer")
+    {
+        op.start();
+        REQUIRE(reg::bitIsSet(MockDma{}, board::dma::CR::CIRC[0_c]));
+        REQUIRE(reg::bitIsSet(MockDma{}, board::dma::CR::HTIE[0_c]));
+        REQUIRE(reg::read(MockDma{}, board::dma::NDTR::NDT[0_c]) == 4);
+        REQUIRE(reg::bitIsSet(MockAdc{}, board::adc::CR2::DMA));
+        REQUIRE(reg::bitIsSet(MockAdc{}, board::adc::CR2::DDS));
+        REQUIRE(!reg::bitIsSet(MockAdc{}, board::adc::CR2::SWSTART));
+        REQUIRE(!reg::bitIsSet(MockAdc{}, board::adc::CR2::CONT));
+        // Compared by value, as the fields are enums
+        REQUIRE(reg::read(MockAdc{}, board::adc::CR2::EXTSEL) == 0x08);   // TIMER3_TRGO
+        REQUIRE(reg::read(MockAdc{}, board::adc::CR2::EXTEN) == 0x01);    // Rising edge
+
+        op.stop();
+        REQUIRE(done);
+        REQUIRE(reg::read(MockAdc{}, board::adc::CR2::EXTEN) == 0x00);
+        REQUIRE(!reg::bitIsSet(MockAdc{}, board::adc::CR2::DMA));
+        REQUIRE(!reg::bitIsSet(MockDma{}, board::dma::CR::TCIE[0_c]));
+    }
+
+    SECTION("Should emit each scan as a frame")
+    {
+        op.start();
+
+        raiseDmaFlag(board::dma::ISR::HTIF[0_c]);
+        REQUIRE(frames == std::vector<std::vector<std::uint16_t>>{{10, 11}});
+
+        async::next(op);
+        raiseDmaFlag(board::dma::ISR::TCIF[0_c]);
+        async::next(op);
+        raiseDmaFlag(board::dma::ISR::HTIF[0_c]);
+        REQUIRE(frames == std::vector<std::vector<std::uint16_t>>{{10, 11}, {20, 21}, {10, 11}});
+        REQUIRE(!error);
+
+        op.stop();
+    }
+
+    SECTION("Should hold back a frame until the next frame is requested")
+    {
+        op.start();
+
+        raiseDmaFlag(board::dma::ISR::HTIF[0_c]);
+        raiseDmaFlag(board::dma::ISR::TCIF[0_c]);
+        REQUIRE(frames.size() == 1);
+
+        async::next(op);
+        REQUIRE(frames.size() == 2);
+        REQUIRE(frames[1] == std::vector<std::uint16_t>{20, 21});
+
+        op.stop();
+    }
+
+    SECTION("Should report an overrun when a frame is lapped")
+    {
+        op.start();
+
+        raiseDmaFlag(board::dma::ISR::HTIF[0_c]);
+        raiseDmaFlag(board::dma::ISR::TCIF[0_c]);
+        raiseDmaFlag(board::dma::ISR::HTIF[0_c]);
+        REQUIRE(error == adc::AdcError::OVERRUN);
+        REQUIRE(reg::read(MockAdc{}, board::adc::CR2::EXTEN) == 0x00);
+    }
+
+    SECTION("A post rejected by the scheduler should not stall the stream")
+    {
+        op.start();
+
+        scheduler.full = true;
+        raiseDmaFlag(board::dma::ISR::HTIF[0_c]);
+        REQUIRE(frames.empty());
+
+        // Lapping the held back frame is an overrun, rather than a stall
+        scheduler.full = false;
+        raiseDmaFlag(board::dma::ISR::TCIF[0_c]);
+        REQUIRE(error == adc::AdcError::OVERRUN);
+    }
+
+    SECTION("Stopping after a failure should not complete the stream again")
+    {
+        op.start();
+
+        raiseDmaFlag(board::dma::ISR::HTIF[0_c]);
+        raiseDmaFlag(board::dma::ISR::TCIF[0_c]);
+        raiseDmaFlag(board::dma::ISR::HTIF[0_c]);
+        REQUIRE(error == adc::AdcError::OVERRUN);
+
+        op.stop();
+        REQUIRE(!done);
+    }
+}
+
+TEST_CASE("ADC decimation")
+{
+    using namespace drivers;
+
+    // Frame of scans of two channels: channel 0 is a DC level with
+    // alternating noise, channel 1 a full period of a sine
+    auto makeFrame = []<std::size_t ratio>(std::uint16_t level, std::array<std::uint16_t, 2 * ratio> & frame) {
+        for (std::size_t i = 0; i < ratio; ++i)
+        {
+            const double phase = 2.0 * 3.141592653589793 * static_cast<double>(i) / ratio;
+            frame[2 * i] = static_cast<std::uint16_t>(level + ((i % 2) ? 3 : -3));
+            frame[2 * i + 1] = static_cast<std::uint16_t>(2048 + std::lround(500.0 * std::sin(phase)));
+        }
+    };
+
+    SECTION("Averaging should add a bit of resolution per fourfold ratio")
+    {
+        STATIC_REQUIRE(adc::Decimator<2, 4>::outputBits == 13);
+        STATIC_REQUIRE(adc::Decimator<2, 16>::outputBits == 14);
+        STATIC_REQUIRE(adc::Decimator<2, 256, 1, 12>::outputBits == 16);
+        STATIC_REQUIRE(adc::Decimator<2, 64, 1, 10>::outputBits == 13);
+    }
+
+    SECTION("Averaging should remove noise and a tone at the frame rate")
+    {
+        adc::Decimator<2, 16> decimator;
+        std::array<std::uint16_t, 32> frame;
+        makeFrame.operator()<16>(1000, frame);
+
+        auto result = decimator(frame);
+        REQUIRE(result[0] == 1000 * 4);
+        REQUIRE(result[1] == 2048 * 4);
+    }
+
+    SECTION("Averaging should keep the fraction of a level between codes")
+    {
+        adc::Decimator<1, 16> decimator;
+        std::array<std::uint16_t, 16> frame;
+        for (std::size_t i = 0; i < frame.size(); ++i)
+        {
+            // 1000.25 on average
+            frame[i] = (i % 4 == 0) ? 1001 : 1000;
+        }
+
+        REQUIRE(decimator(frame)[0] == 4001);
+    }
+
+    SECTION("CIC filter should settle to the level after order frames")
+    {
+        adc::Decimator<2, 16, 3> decimator;
+        std::array<std::uint16_t, 32> frame;
+        makeFrame.operator()<16>(1000, frame);
+
+        std::vector<std::uint16_t> outputs;
+        for (int i = 0; i < 5; ++i)
+        {
+            outputs.push_back(decimator(frame)[0]);
+        }
+
+        REQUIRE(outputs[0] < outputs[1]);
+        REQUIRE(outputs[1] < outputs[2]);
+        REQUIRE(outputs[2] == 1000 * 4);
+        REQUIRE(outputs[4] == 1000 * 4);
+        REQUIRE(decimator(frame)[1] == 2048 * 4);
+    }
+
+    SECTION("CIC filter should not lose the level when its state wraps")
+    {
+        adc::Decimator<1, 256, 2> decimator;
+        std::array<std::uint16_t, 256> frame;
+        frame.fill(4095);
+
+        // The second integrator wraps after a few hundred frames
+        std::uint16_t result = 0;
+        for (int i = 0; i < 1000; ++i)
+        {
+            result = decimator(frame)[0];
+        }
+        REQUIRE(result == 4095 * 16);
+    }
+
+    SECTION("Reset should clear the filter state")
+    {
+        adc::Decimator<2, 4, 2> decimator;
+        std::array<std::uint16_t, 8> frame;
+        makeFrame.operator()<4>(1000, frame);
+        decimator(frame);
+        decimator(frame);
+        decimator.reset();
+
+        adc::Decimator<2, 4, 2> fresh;
+        REQUIRE(decimator(frame)[0] == fresh(frame)[0]);
+    }
+}
+
+TEST_CASE("ADC continuous read with decimation")
+{
+    using namespace drivers;
+    using namespace hana::literals;
+    resetPeripheral(MockAdc{});
+    resetPeripheral(MockDma{});
+
+    RejectingScheduler scheduler;
+    adc::Adc<MockAdc, 2, 4096> device{async::EventEmitter{&adcInterruptEvent}};
+    dma::Dma<MockDma, 0> dmaStream{async::EventEmitter{&dmaInterruptEvent}};
+    std::uint16_t buffer[16] = {
+        10, 11, 10, 11, 10, 11, 10, 11, 
+        20, 21, 20, 21, 20, 21, 20, 21};
+
+    std::vector<std::vector<std::uint16_t>> frames;
+    std::optional<adc::AdcError> error;
+    bool done = false;
+
+    auto op = async::subscribe(
+        device.readContinuous<4>(dmaStream, buffer, adc::ExternalTrigger::TIMER3_TRGO)
+            | async::map(adc::Decimator<2, 4>{}),
+        FrameReceiver{&scheduler, frames, error, done});
+
+    auto raiseDmaFlag = [](auto flag) {
+        setRegisterBit(MockDma{}, flag);
+        dmaInterruptEvent.raise();
+        clearRegisterBit(MockDma{}, flag);
+    };
+
+    SECTION("Should transfer two frames of scans")
+    {
+        op.start();
+        REQUIRE(reg::read(MockDma{}, board::dma::NDTR::NDT[0_c]) == 16);
+        op.stop();
+    }
+
+    SECTION("Should emit one decimated sample per channel and frame")
+    {
+        op.start();
+
+        raiseDmaFlag(board::dma::ISR::HTIF[0_c]);
+        async::next(op);
+        raiseDmaFlag(board::dma::ISR::TCIF[0_c]);
+        REQUIRE(frames == std::vector<std::vector<std::uint16_t>>{{20, 22}, {40, 42}});
+
+        op.stop();
+    }
+}
+
+TEST_CASE("ADC injected read")
+{
+    using namespace drivers;
+    using namespace hana::literals;
+    resetPeripheral(MockAdc{});
+    resetPeripheral(MockDma{});
+
+    RejectingScheduler scheduler;
+    adc::Adc<MockAdc, 2, 4096> device{async::EventEmitter{&adcInterruptEvent}};
+    std::uint16_t values[3] = {};
+    bool completed = false;
+
+    auto op = async::connect(
+        device.readInjected<Pin(0, 1), Pin(0, 2), Pin(2, 0)>(values),
+        async::addSchedulerToReceiver(scheduler, async::receiveValue([&]() { completed = true; })));
+
+    auto completeConversions = []() {
+        setDeviceMemory(MockAdc{}, 0x3C, 100);
+        setDeviceMemory(MockAdc{}, 0x40, 200);
+        setDeviceMemory(MockAdc{}, 0x44, 300);
+        setRegisterBit(MockAdc{}, board::adc::SR::JEOC);
+        adcInterruptEvent.raise();
+    };
+
+    SECTION("ReadInjected should return a future")
+    {
+        using FutureType = decltype(device.readInjected<Pin(0, 1)>(values));
+        STATIC_REQUIRE(async::Future<FutureType, void, adc::AdcError>);
+    }
+
+    SECTION("Should write the group to the end of the injected sequence")
+    {
+        op.start();
+        REQUIRE(reg::read(MockAdc{}, board::adc::JSQR::JL) == 2);
+        REQUIRE(reg::read(MockAdc{}, board::adc::JSQR::JSQ[1_c]) == 1);
+        REQUIRE(reg::read(MockAdc{}, board::adc::JSQR::JSQ[2_c]) == 2);
+        REQUIRE(reg::read(MockAdc{}, board::adc::JSQR::JSQ[3_c]) == 10);
+        REQUIRE(reg::bitIsSet(MockAdc{}, board::adc::CR1::JEOCIE));
+        REQUIRE(reg::bitIsSet(MockAdc{}, board::adc::CR2::JSWSTART));
+
+        op.stop();
+    }
+
+    SECTION("Should read the results when the group is converted")
+    {
+        op.start();
+        completeConversions();
+
+        REQUIRE(completed);
+        REQUIRE(values[0] == 100);
+        REQUIRE(values[1] == 200);
+        REQUIRE(values[2] == 300);
+        REQUIRE(!reg::bitIsSet(MockAdc{}, board::adc::SR::JEOC));
+        REQUIRE(!reg::bitIsSet(MockAdc{}, board::adc::CR1::JEOCIE));
+    }
+
+    SECTION("Should ignore the interrupts of regular conversions")
+    {
+        op.start();
+        setRegisterBit(MockAdc{}, board::adc::SR::EOC);
+        adcInterruptEvent.raise();
+        REQUIRE(!completed);
+
+        op.stop();
+    }
+
+    SECTION("Should fail while another injected read is waiting")
+    {
+        std::optional<adc::AdcError> error;
+        std::uint16_t other[1];
+        auto op2 = async::connect(
+            device.readInjected<Pin(0, 0)>(other),
+            async::addSchedulerToReceiver(scheduler, async::receiveError([&](adc::AdcError e) { error = e; })));
+
+        op.start();
+        op2.start();
+        REQUIRE(error == adc::AdcError::BUSY);
+
+        op.stop();
+    }
+
+    SECTION("Should not stop a continuous read")
+    {
+        dma::Dma<MockDma, 0> dmaStream{async::EventEmitter{&dmaInterruptEvent}};
+        std::uint16_t buffer[4];
+        std::vector<std::vector<std::uint16_t>> frames;
+        std::optional<adc::AdcError> error;
+        bool done = false;
+        auto streamOp = async::subscribe(
+            device.readContinuous(dmaStream, buffer, adc::ExternalTrigger::TIMER3_TRGO),
+            FrameReceiver{&scheduler, frames, error, done});
+
+        streamOp.start();
+        op.start();
+        completeConversions();
+
+        REQUIRE(completed);
+        REQUIRE(reg::bitIsSet(MockAdc{}, board::adc::CR2::DMA));
+        REQUIRE(reg::read(MockAdc{}, board::adc::CR2::EXTEN) == 0x01);
+
+        streamOp.stop();
+    }
+}
+
+namespace
+{
+    struct SecondAdcMemory;
+    using MockAdc2 = Peripheral<board::adc::tag, MockDeviceMemory<SecondAdcMemory>, MockPeripheralControl<SecondAdcMemory>>;
+}
+
+TEST_CASE("ADC injected reads on a shared interrupt")
+{
+    using namespace drivers;
+    resetPeripheral(MockAdc{});
+    MockDeviceMemory<SecondAdcMemory>::reset();
+
+    RejectingScheduler scheduler;
+    async::MulticastEvent sharedEvent;
+    adc::Adc<MockAdc, 1, 4096, async::MulticastEventEmitter> adc1{async::MulticastEventEmitter{&sharedEvent}};
+    adc::Adc<MockAdc2, 1, 4096, async::MulticastEventEmitter> adc2{async::MulticastEventEmitter{&sharedEvent}};
+    std::uint16_t values1[1] = {};
+    std::uint16_t values2[1] = {};
+    bool completed1 = false;
+    bool completed2 = false;
+
+    auto op1 = async::connect(
+        adc1.readInjected<Pin(0, 1)>(values1),
+        async::addSchedulerToReceiver(scheduler, async::receiveValue([&]() { completed1 = true; })));
+    auto op2 = async::connect(
+        adc2.readInjected<Pin(0, 2)>(values2),
+        async::addSchedulerToReceiver(scheduler, async::receiveValue([&]() { completed2 = true; })));
+
+    SECTION("Should wait for the injected reads of several ADCs at once")
+    {
+        op1.start();
+        op2.start();
+        REQUIRE(reg::bitIsSet(MockAdc{}, board::adc::CR1::JEOCIE));
+        REQUIRE(reg::bitIsSet(MockAdc2{}, board::adc::CR1::JEOCIE));
+
+        setDeviceMemory(MockAdc{}, 0x3C, 100);
+        setRegisterBit(MockAdc{}, board::adc::SR::JEOC);
+        sharedEvent.raise();
+        REQUIRE(completed1);
+        REQUIRE(!completed2);
+        REQUIRE(values1[0] == 100);
+
+        MockDeviceMemory<SecondAdcMemory>::getRef<0x3C>() = 200;
+        reg::set(MockAdc2{}, board::adc::SR::JEOC);
+        sharedEvent.raise();
+        REQUIRE(completed2);
+        REQUIRE(values2[0] == 200);
+        REQUIRE(!sharedEvent);
+    }
+
+    SECTION("Should fail while another injected read of the ADC is waiting")
+    {
+        std::optional<adc::AdcError> error;
+        std::uint16_t other[1];
+        auto op3 = async::connect(
+            adc1.readInjected<Pin(0, 0)>(other),
+            async::addSchedulerToReceiver(scheduler, async::receiveError([&](adc::AdcError e) { error = e; })));
+
+        op1.start();
+        op3.start();
+        REQUIRE(error == adc::AdcError::BUSY);
+
+        op1.stop();
+        REQUIRE(!sharedEvent);
+    }
+}
+
+TEST_CASE("Multi ADC continuous read")
+{
+    using namespace drivers;
+    using namespace hana::literals;
+    resetPeripheral(MockAdc{});
+    resetPeripheral(MockCommonAdc{});
+    resetPeripheral(MockDma{});
+
+    MockBoard<MockPeripherals> mockBoard;
+    RejectingScheduler scheduler;
+    adc::Adc<MockAdc, 1, 4096> adc1{async::EventEmitter{&adcInterruptEvent}};
+    adc::Adc<MockAdc, 1, 4096> adc2{async::EventEmitter{&adcInterruptEvent}};
+    dma::Dma<MockDma, 0> dmaStream{async::EventEmitter{&dmaInterruptEvent}};
+
+    auto device = adc::makeMultiAdc<adc::MultiAdcConfig{
+        .mode = adc::MultiMode::DUAL_INTERLEAVED,
+        .delay = 7
+    }>(mockBoard, adc1, adc2);
+
+    std::uint16_t buffer[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    std::vector<std::vector<std::uint16_t>> frames;
+    std::optional<adc::AdcError> error;
+    bool done = false;
+
+    auto op = async::subscribe(
+        device.readContinuous<2>(dmaStream, buffer, adc::ExternalTrigger::TIMER2_TRGO),
+        FrameReceiver{&scheduler, frames, error, done});
+
+    auto raiseDmaFlag = [](auto flag) {
+        setRegisterBit(MockDma{}, flag);
+        dmaInterruptEvent.raise();
+        clearRegisterBit(MockDma{}, flag);
+    };
+
+    SECTION("Should configure the mode")
+    {
+        STATIC_REQUIRE(decltype(device)::numberOfAdcs == 2);
+        REQUIRE(reg::read(MockCommonAdc{}, board::c_adc::CCR::MULT) == 0x07);
+        REQUIRE(reg::read(MockCommonAdc{}, board::c_adc::CCR::DELAY) == 2);
+    }
+
+    SECTION("ReadContinuous should return a stream of frames of all ADCs")
+    {
+        using StreamType = decltype(device.readContinuous<2>(dmaStream, buffer, adc::ExternalTrigger::TIMER2_TRGO));
+        STATIC_REQUIRE(async::Stream<StreamType, std::span<const std::uint16_t, 4>, adc::AdcError>);
+    }
+
+    SECTION("Should read the common data register in DMA mode 2")
+    {
+        op.start();
+        // Counted in words
+        REQUIRE(reg::read(MockDma{}, board::dma::NDTR::NDT[0_c]) == 4);
+        REQUIRE(reg::read(MockCommonAdc{}, board::c_adc::CCR::DMA) == 0x02);
+        REQUIRE(reg::bitIsSet(MockCommonAdc{}, board::c_adc::CCR::DDS));
+        REQUIRE(!reg::bitIsSet(MockAdc{}, board::adc::CR2::DMA));
+        REQUIRE(reg::read(MockAdc{}, board::adc::CR2::EXTSEL) == 0x06);   // TIMER2_TRGO
+        REQUIRE(reg::read(MockAdc{}, board::adc::CR2::EXTEN) == 0x01);
+
+        op.stop();
+        REQUIRE(done);
+        REQUIRE(reg::read(MockCommonAdc{}, board::c_adc::CCR::DMA) == 0x00);
+        REQUIRE(reg::read(MockAdc{}, board::adc::CR2::EXTEN) == 0x00);
+    }
+
+    SECTION("Should emit the conversions of both ADCs in order")
+    {
+        op.start();
+
+        raiseDmaFlag(board::dma::ISR::HTIF[0_c]);
+        async::next(op);
+        raiseDmaFlag(board::dma::ISR::TCIF[0_c]);
+        REQUIRE(frames == std::vector<std::vector<std::uint16_t>>{{1, 2, 3, 4}, {5, 6, 7, 8}});
+
+        op.stop();
+    }
+}
@@ -5,12 +5,21 @@
 #include "../mocks/mock_board.hpp"
 #include "async/event.hpp"
 #include "async/receive.hpp"
+#include "async/use_scheduler.hpp"
+#include "async/inline_scheduler.hpp"
 #include "reg/read.hpp"
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
 
 using MockDma = MockPeripheral<board::dma::tag>;
 
 namespace {
     async::Event interruptEvent;
+    async::Event chainInterruptEvent;
+    async::Event memoryInterruptEvent0;
+    async::Event memoryInterruptEvent1;
 }
 
 struct Peripherals
@@ -142,4 +151,331 @@ TEST_CASE("Dma")
 
         REQUIRE(receivedValue);*/
     }
-}
\ No newline at end of file
+}
+TEST_CASE("Dma chained transfer")
+{
+    MockDma mockDma;
+    resetPeripheral(mockDma);
+
+    using namespace drivers;
+    dma::Dma<MockDma, 2> dmaDev{async::EventEmitter{&chainInterruptEvent}};
+    std::vector<dma::DmaSignal> signals;
+    auto handler = [&](dma::DmaSignal s) { signals.push_back(s); };
+
+    const std::array<dma::MemorySegment, 4> segments = {{
+        {dma::MemoryAddress{0x1000}, 4},
+        {dma::MemoryAddress{0x2000}, 0},
+        {dma::MemoryAddress{0x3000}, 100},
+        {dma::MemoryAddress{0x4000}, 2}
+    }};
+
+    auto completeSegment = [&]() {
+        // The hardware disables the stream at the end of a segment
+        clearRegisterBit(mockDma, board::dma::CR::EN[2_c]);
+        setRegisterBit(mockDma, board::dma::ISR::TCIF[2_c]);
+        chainInterruptEvent.raise();
+        clearRegisterBit(mockDma, board::dma::ISR::TCIF[2_c]);
+    };
+
+    SECTION("Should start with the first segment")
+    {
+        auto op = dmaDev.transferChain(segments, dma::PeripheralAddress{0x5000})(handler);
+        REQUIRE(op.start());
+
+        REQUIRE(reg::read(mockDma, board::dma::CR::DIR[2_c]) == 1);    // Memory to peripheral
+        REQUIRE(reg::read(mockDma, board::dma::PAR::PA[2_c]) == 0x5000);
+        REQUIRE(reg::read(mockDma, board::dma::M0AR::M0A[2_c]) == 0x1000);
+        REQUIRE(reg::read(mockDma, board::dma::NDTR::NDT[2_c]) == 4);
+        REQUIRE(!reg::bitIsSet(mockDma, board::dma::CR::CIRC[2_c]));
+        REQUIRE(!reg::bitIsSet(mockDma, board::dma::CR::DBM[2_c]));
+        REQUIRE(reg::bitIsSet(mockDma, board::dma::CR::TCIE[2_c]));
+        REQUIRE(reg::bitIsSet(mockDma, board::dma::CR::EN[2_c]));
+
+        op.stop();
+    }
+
+    SECTION("Should re-arm the stream with the next segment, skipping empty ones")
+    {
+        auto op = dmaDev.transferChain(segments, dma::PeripheralAddress{0x5000})(handler);
+        op.start();
+
+        completeSegment();
+        REQUIRE(signals.empty());
+        REQUIRE(reg::read(mockDma, board::dma::M0AR::M0A[2_c]) == 0x3000);
+        REQUIRE(reg::read(mockDma, board::dma::NDTR::NDT[2_c]) == 100);
+        REQUIRE(reg::bitIsSet(mockDma, board::dma::CR::EN[2_c]));
+
+        completeSegment();
+        REQUIRE(reg::read(mockDma, board::dma::M0AR::M0A[2_c]) == 0x4000);
+        REQUIRE(reg::read(mockDma, board::dma::NDTR::NDT[2_c]) == 2);
+        REQUIRE(op.segmentsStarted() == 4);
+
+        completeSegment();
+        REQUIRE(signals == std::vector<dma::DmaSignal>{dma::DmaSignal::TRANSFER_COMPLETE});
+        REQUIRE(!reg::bitIsSet(mockDma, board::dma::CR::EN[2_c]));
+        REQUIRE(!reg::bitIsSet(mockDma, board::dma::CR::TCIE[2_c]));
+    }
+
+    SECTION("Should transfer from a peripheral into segments of a caller provided array")
+    {
+        dma::MemorySegment storage[2] = {
+            {dma::MemoryAddress{0x1000}, 8},
+            {dma::MemoryAddress{0x2000}, 16}
+        };
+
+        auto op = dmaDev.transferChain(dma::PeripheralAddress{0x5000}, std::span<const dma::MemorySegment>(storage))(handler);
+        op.start();
+        REQUIRE(reg::read(mockDma, board::dma::CR::DIR[2_c]) == 0);    // Peripheral to memory
+        REQUIRE(reg::read(mockDma, board::dma::PAR::PA[2_c]) == 0x5000);
+        REQUIRE(reg::read(mockDma, board::dma::M0AR::M0A[2_c]) == 0x1000);
+
+        completeSegment();
+        REQUIRE(reg::read(mockDma, board::dma::M0AR::M0A[2_c]) == 0x2000);
+        REQUIRE(reg::read(mockDma, board::dma::NDTR::NDT[2_c]) == 16);
+
+        completeSegment();
+        REQUIRE(signals == std::vector<dma::DmaSignal>{dma::DmaSignal::TRANSFER_COMPLETE});
+    }
+
+    SECTION("Should complete at once without segments")
+    {
+        auto op = dmaDev.transferChain(std::span<const dma::MemorySegment>(), dma::PeripheralAddress{0x5000})(handler);
+        REQUIRE(op.start());
+        REQUIRE(signals == std::vector<dma::DmaSignal>{dma::DmaSignal::TRANSFER_COMPLETE});
+        REQUIRE(!reg::bitIsSet(mockDma, board::dma::CR::EN[2_c]));
+    }
+
+    SECTION("Should stop the chain on a transfer error")
+    {
+        auto op = dmaDev.transferChain(segments, dma::PeripheralAddress{0x5000})(handler);
+        op.start();
+
+        clearRegisterBit(mockDma, board::dma::CR::EN[2_c]);
+        setRegisterBit(mockDma, board::dma::ISR::TEIF[2_c]);
+        chainInterruptEvent.raise();
+        clearRegisterBit(mockDma, board::dma::ISR::TEIF[2_c]);
+
+        REQUIRE(signals == std::vector<dma::DmaSignal>{dma::DmaSignal::TRANSFER_ERROR});
+        REQUIRE(reg::read(mockDma, board::dma::M0AR::M0A[2_c]) == 0x1000);
+        REQUIRE(!reg::bitIsSet(mockDma, board::dma::CR::EN[2_c]));
+    }
+}
+
+TEST_CASE("Dma memory engine")
+{
+    MockDma mockDma;
+    resetPeripheral(mockDma);
+    auto scheduler = async::InlineScheduler{};
+
+    using namespace drivers;
+    dma::MemoryEngine<MockDma, 0, 1> engine{
+        async::EventEmitter{&memoryInterruptEvent0},
+        async::EventEmitter{&memoryInterruptEvent1}};
+
+    // Only the registers are checked, the memory is never accessed
+    auto address = [](std::uintptr_t a) { return reinterpret_cast<void *>(a); };
+
+    auto completeChunk = [&](auto streamIndex, async::Event & event) {
+        clearRegisterBit(mockDma, board::dma::CR::EN[streamIndex]);
+        setRegisterBit(mockDma, board::dma::ISR::TCIF[streamIndex]);
+        event.raise();
+        clearRegisterBit(mockDma, board::dma::ISR::TCIF[streamIndex]);
+    };
+
+    SECTION("The data width and burst should follow the alignment")
+    {
+        using Plan = dma::detail::MemoryTransferPlan;
+        using Width = Plan::Width;
+
+        constexpr auto words = Plan::make(0x1000, 0x2000, 0x100, false);
+        STATIC_REQUIRE(words.width == Width::WORD);
+        STATIC_REQUIRE(words.burst);
+        STATIC_REQUIRE(words.itemsPerChunk == 65532);
+
+        constexpr auto halfWords = Plan::make(0x1002, 0x2000, 0x100, false);
+        STATIC_REQUIRE(halfWords.width == Width::HALF_WORD);
+        STATIC_REQUIRE(!halfWords.burst);
+        STATIC_REQUIRE(halfWords.itemsPerChunk == 65535);
+
+        constexpr auto bytes = Plan::make(0x1000, 0x2000, 0x101, false);
+        STATIC_REQUIRE(bytes.width == Width::BYTE);
+        STATIC_REQUIRE(bytes.itemsPerChunk == 65535);
+
+        // The source of a fill is not incremented, only the destination counts
+        constexpr auto fill = Plan::make(0x1000, 0x2001, 0x100, true);
+        STATIC_REQUIRE(fill.width == Width::WORD);
+        STATIC_REQUIRE(fill.burst);
+
+        REQUIRE(Plan::make(0x1010, 0x2000, 0x20, false).memoryBurst() == board::dma::CR::MburstVal::INCR4);
+        REQUIRE(Plan::make(0x1012, 0x2000, 0x20, false).memoryBurst() == board::dma::CR::MburstVal::SINGLE_TRANSFER);
+    }
+
+    SECTION("A copy should run memory to memory with the widest items")
+    {
+        bool completed = false;
+        auto op = async::connect(
+            engine.copy(address(0x20001000), address(0x20002000), 0x100),
+            async::addSchedulerToReceiver(scheduler, async::receiveValue([&]() { completed = true; })));
+        op.start();
+
+        REQUIRE(reg::read(mockDma, board::dma::CR::DIR[0_c]) == 2);    // Memory to memory
+        REQUIRE(reg::read(mockDma, board::dma::PAR::PA[0_c]) == 0x20002000);
+        REQUIRE(reg::read(mockDma, board::dma::M0AR::M0A[0_c]) == 0x20001000);
+        REQUIRE(reg::read(mockDma, board::dma::NDTR::NDT[0_c]) == 0x40);
+        REQUIRE(reg::bitIsSet(mockDma, board::dma::CR::PINC[0_c]));
+        REQUIRE(reg::bitIsSet(mockDma, board::dma::CR::MINC[0_c]));
+        REQUIRE(reg::read(mockDma, board::dma::CR::PSIZE[0_c]) == 2);
+        REQUIRE(reg::read(mockDma, board::dma::CR::MSIZE[0_c]) == 2);
+        REQUIRE(reg::read(mockDma, board::dma::CR::MBURST[0_c]) == 1);  // INCR4
+        REQUIRE(reg::read(mockDma, board::dma::CR::PBURST[0_c]) == 1);
+        REQUIRE(reg::bitIsSet(mockDma, board::dma::FCR::DMDIS[0_c]));
+        REQUIRE(reg::read(mockDma, board::dma::FCR::FTH[0_c]) == 3);
+        REQUIRE(reg::bitIsSet(mockDma, board::dma::CR::EN[0_c]));
+        REQUIRE(!completed);
+
+        completeChunk(0_c, memoryInterruptEvent0);
+        REQUIRE(completed);
+        REQUIRE(!reg::bitIsSet(mockDma, board::dma::CR::TCIE[0_c]));
+    }
+
+    SECTION("A copy of more than 65535 items should be split into chunks")
+    {
+        bool completed = false;
+        auto op = async::connect(
+            engine.copy(address(0x20000000), address(0x20040000), 0x40000),
+            async::addSchedulerToReceiver(scheduler, async::receiveValue([&]() { completed = true; })));
+        op.start();
+
+        REQUIRE(reg::read(mockDma, board::dma::NDTR::NDT[0_c]) == 65532);
+
+        completeChunk(0_c, memoryInterruptEvent0);
+        REQUIRE(!completed);
+        REQUIRE(reg::read(mockDma, board::dma::PAR::PA[0_c]) == 0x20040000 + 65532 * 4);
+        REQUIRE(reg::read(mockDma, board::dma::M0AR::M0A[0_c]) == 0x20000000 + 65532 * 4);
+        REQUIRE(reg::read(mockDma, board::dma::NDTR::NDT[0_c]) == 4);
+        REQUIRE(reg::bitIsSet(mockDma, board::dma::CR::EN[0_c]));
+
+        completeChunk(0_c, memoryInterruptEvent0);
+        REQUIRE(completed);
+    }
+
+    SECTION("A fill should read the pattern from a fixed address")
+    {
+        bool completed = false;
+        auto op = async::connect(
+            engine.fill(address(0x20001001), 0xAB, 0x80001),
+            async::addSchedulerToReceiver(scheduler, async::receiveValue([&]() { completed = true; })));
+        op.start();
+
+        REQUIRE(!reg::bitIsSet(mockDma, board::dma::CR::PINC[0_c]));
+        REQUIRE(reg::read(mockDma, board::dma::CR::PSIZE[0_c]) == 0);
+        REQUIRE(reg::read(mockDma, board::dma::NDTR::NDT[0_c]) == 65535);
+
+        const auto pattern = reg::read(mockDma, board::dma::PAR::PA[0_c]);
+        completeChunk(0_c, memoryInterruptEvent0);
+        REQUIRE(reg::read(mockDma, board::dma::PAR::PA[0_c]) == pattern);
+        REQUIRE(reg::read(mockDma, board::dma::M0AR::M0A[0_c]) == 0x20001001 + 65535);
+
+        // 0x80001 = 8 * 65535 + 9
+        for (int i = 0; i < 7; ++i)
+        {
+            completeChunk(0_c, memoryInterruptEvent0);
+        }
+        REQUIRE(reg::read(mockDma, board::dma::NDTR::NDT[0_c]) == 9);
+
+        completeChunk(0_c, memoryInterruptEvent0);
+        REQUIRE(completed);
+    }
+
+    SECTION("An empty request should complete at once")
+    {
+        bool completed = false;
+        auto op = async::connect(
+            engine.copy(address(0x20001000), address(0x20002000), 0),
+            async::addSchedulerToReceiver(scheduler, async::receiveValue([&]() { completed = true; })));
+        op.start();
+
+        REQUIRE(completed);
+        REQUIRE(!reg::bitIsSet(mockDma, board::dma::CR::EN[0_c]));
+    }
+
+    SECTION("A transfer error should fail the request")
+    {
+        bool failed = false;
+        auto op = async::connect(
+            engine.copy(address(0x20001000), address(0x20002000), 0x100),
+            async::addSchedulerToReceiver(scheduler, async::receiveError([&](dma::DmaError error) {
+                failed = (error == dma::DmaError::TRANSFER_ERROR);
+            })));
+        op.start();
+
+        clearRegisterBit(mockDma, board::dma::CR::EN[0_c]);
+        setRegisterBit(mockDma, board::dma::ISR::TEIF[0_c]);
+        memoryInterruptEvent0.raise();
+        clearRegisterBit(mockDma, board::dma::ISR::TEIF[0_c]);
+
+        REQUIRE(failed);
+        REQUIRE(!reg::bitIsSet(mockDma, board::dma::CR::TEIE[0_c]));
+    }
+
+    SECTION("Requests should be queued until a stream is free")
+    {
+        std::vector<int> completed;
+        auto op1 = async::connect(
+            engine.copy(address(0x20001000), address(0x20002000), 0x100),
+            async::addSchedulerToReceiver(scheduler, async::receiveValue([&]() { completed.push_back(1); })));
+        auto op2 = async::connect(
+            engine.copy(address(0x20003000), address(0x20004000), 0x100),
+            async::addSchedulerToReceiver(scheduler, async::receiveValue([&]() { completed.push_back(2); })));
+        auto op3 = async::connect(
+            engine.fill(address(0x20005000), 0, 0x100),
+            async::addSchedulerToReceiver(scheduler, async::receiveValue([&]() { completed.push_back(3); })));
+
+        op1.start();
+        op2.start();
+        op3.start();
+        REQUIRE(reg::read(mockDma, board::dma::M0AR::M0A[0_c]) == 0x20001000);
+        REQUIRE(reg::read(mockDma, board::dma::M0AR::M0A[1_c]) == 0x20003000);
+
+        // The third request takes the first stream that is free
+        completeChunk(1_c, memoryInterruptEvent1);
+        REQUIRE(completed == std::vector<int>{2});
+        REQUIRE(reg::read(mockDma, board::dma::M0AR::M0A[1_c]) == 0x20005000);
+
+        completeChunk(0_c, memoryInterruptEvent0);
+        completeChunk(1_c, memoryInterruptEvent1);
+        REQUIRE(completed == std::vector<int>{2, 1, 3});
+    }
+
+    SECTION("Stopping a queued request should remove it from the queue")
+    {
+        std::vector<int> completed;
+        bool done = false;
+        auto op1 = async::connect(
+            engine.copy(address(0x20001000), address(0x20002000), 0x100),
+            async::addSchedulerToReceiver(scheduler, async::receiveValue([&]() { completed.push_back(1); })));
+        auto op2 = async::connect(
+            engine.copy(address(0x20003000), address(0x20004000), 0x100),
+            async::addSchedulerToReceiver(scheduler, async::receiveValue([&]() { completed.push_back(2); })));
+        auto op3 = async::connect(
+            engine.copy(address(0x20005000), address(0x20006000), 0x100),
+            async::addSchedulerToReceiver(scheduler, async::receiveDone([&]() { done = true; })));
+        auto op4 = async::connect(
+            engine.copy(address(0x20007000), address(0x20008000), 0x100),
+            async::addSchedulerToReceiver(scheduler, async::receiveValue([&]() { completed.push_back(4); })));
+
+        op1.start();
+        op2.start();
+        op3.start();
+        op4.start();
+        op3.stop();
+        REQUIRE(done);
+
+        completeChunk(0_c, memoryInterruptEvent0);
+        REQUIRE(reg::read(mockDma, board::dma::M0AR::M0A[0_c]) == 0x20007000);
+
+        completeChunk(1_c, memoryInterruptEvent1);
+        completeChunk(0_c, memoryInterruptEvent0);
+        REQUIRE(completed == std::vector<int>{1, 2, 4});
+    }
+}
@@ -1,6 +1,9 @@
 #include "../catch.hpp"
-#include "drivers/i2c.hpp"
-#include "drivers/i2c/i2c_like.hpp"
+#include "platform/stm32f4/i2c.hpp"
+#include "platform/stm32f4/i2c/i2c_like.hpp"
+#include "drivers/dma.hpp"
+#include "platform/stm32f4/i2c/i2c_dma_master.hpp"
+#include "platform/stm32f4/i2c/i2c_bus.hpp"
 #include "../mocks/mock_board.hpp"
 #include "../mocks/mock_peripheral.hpp"
 #include "async/receive.hpp"
@@ -9,10 +12,13 @@
 
 using MockI2C = MockPeripheral<board::i2c::tag>;
 using MockGpio = MockPeripheral<board::gpio::tag>;
+using MockDma = MockPeripheral<board::dma::tag>;
 
 namespace {
     async::Event eventInterrupt;
     async::Event errorInterrupt;
+    async::Event dmaTxInterrupt;
+    async::Event dmaRxInterrupt;
 }
 
 struct MockPeripherals
@@ -154,6 +160,9 @@ TEST_CASE("I2C")
         REQUIRE(reg::read(mockI2C, board::i2c::DR::DR) == 0x21);
 
         doAddressPhase();
+
+        // The transaction is not completed, release the interrupts
+        op.stop();
     }
 
     SECTION("Write and read single byte")
@@ -193,6 +202,9 @@ TEST_CASE("I2C")
         REQUIRE(reg::read(mockI2C, board::i2c::DR::DR) == 0x21);
 
         doAddressPhase();
+
+        // The transaction is not completed, release the interrupts
+        op.stop();
     }
 
     /*SECTION("Write single byte (interrupt)")
@@ -263,4 +275,346 @@ TEST_CASE("I2C")
         REQUIRE(simulator.isWrite());
         REQUIRE(std::equal(simulator.data.begin(), simulator.data.end(), data.begin()));
     }*/
-}
\ No newline at end of file
+}
+
+TEST_CASE("I2C DMA")
+{
+    using namespace drivers;
+    using namespace hana::literals;
+    auto mockI2C = MockI2C{};
+    auto mockDma = MockDma{};
+    resetPeripheral(mockI2C);
+    resetPeripheral(mockDma);
+    auto scheduler = async::InlineScheduler{};
+
+    // I2C1 requests on DMA1, TX on stream 6 and RX on stream 0
+    dma::Dma<MockDma, 6> dmaTx{async::EventEmitter{&dmaTxInterrupt}};
+    dma::Dma<MockDma, 0> dmaRx{async::EventEmitter{&dmaRxInterrupt}};
+    i2c::I2cDmaMaster<MockI2C, decltype(dmaTx), decltype(dmaRx)> dev{
+        async::EventEmitter{&eventInterrupt}, 
+        async::EventEmitter{&errorInterrupt},
+        dmaTx,
+        dmaRx};
+
+    auto completeTransfer = [&](auto streamIndex, async::Event & interrupt) {
+        setFieldValue(mockDma, board::dma::NDTR::NDT[streamIndex], 0U);
+        setRegisterBit(mockDma, board::dma::ISR::TCIF[streamIndex]);
+        interrupt.raise();
+        clearRegisterBit(mockDma, board::dma::ISR::TCIF[streamIndex]);
+    };
+
+    SECTION("Should fullfill the I2cLike concept")
+    {
+        STATIC_REQUIRE(i2c::I2cLike<decltype(dev)>);
+    }
+
+    SECTION("Write should move the data by DMA and stop after the last byte transfer")
+    {
+        bool valueReceived = false;
+        const std::uint8_t data[3] = {0xF1, 0xF2, 0xF3};
+
+        auto op = async::connect(
+            dev.write(0x10, data, 3),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveValue([&]() { valueReceived = true; })));
+        async::start(op);
+
+        REQUIRE(reg::bitIsSet(mockI2C, board::i2c::CR1::START));
+        REQUIRE(reg::bitIsSet(mockI2C, board::i2c::CR2::DMAEN));
+        REQUIRE(reg::bitIsSet(mockI2C, board::i2c::CR2::ITEVTEN));
+        REQUIRE(reg::bitIsSet(mockI2C, board::i2c::CR2::ITERREN));
+        REQUIRE(!reg::bitIsSet(mockI2C, board::i2c::CR2::ITBUFEN));
+        REQUIRE(reg::bitIsSet(mockDma, board::dma::CR::EN[6_c]));
+        REQUIRE(reg::read(mockDma, board::dma::NDTR::NDT[6_c]) == 3);
+
+        generateStartCondition();
+        REQUIRE(reg::read(mockI2C, board::i2c::DR::DR) == 0x20);
+        doAddressPhase();
+
+        // BTF before the DMA has written the last byte is ignored
+        byteTransferFinished();
+        REQUIRE(!reg::bitIsSet(mockI2C, board::i2c::CR1::STOP));
+
+        // The DMA transfer complete is not the end of the transaction
+        completeTransfer(6_c, dmaTxInterrupt);
+        REQUIRE(!valueReceived);
+
+        byteTransferFinished();
+        REQUIRE(reg::bitIsSet(mockI2C, board::i2c::CR1::STOP));
+        REQUIRE(valueReceived);
+        REQUIRE(!reg::bitIsSet(mockI2C, board::i2c::CR2::DMAEN));
+        REQUIRE(!reg::bitIsSet(mockI2C, board::i2c::CR2::ITEVTEN));
+    }
+
+    SECTION("A read of two or more bytes should set LAST and stop on the DMA transfer complete")
+    {
+        bool valueReceived = false;
+        std::uint8_t data[4] = {};
+
+        auto op = async::connect(
+            dev.read(0x10, data, 4),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveValue([&]() { valueReceived = true; })));
+        async::start(op);
+
+        REQUIRE(reg::bitIsSet(mockI2C, board::i2c::CR2::LAST));
+        REQUIRE(reg::bitIsSet(mockI2C, board::i2c::CR1::ACK));
+        REQUIRE(reg::bitIsSet(mockDma, board::dma::CR::EN[0_c]));
+        REQUIRE(!reg::bitIsSet(mockDma, board::dma::CR::EN[6_c]));
+
+        generateStartCondition();
+        REQUIRE(reg::read(mockI2C, board::i2c::DR::DR) == 0x21);
+        doAddressPhase();
+        REQUIRE(!reg::bitIsSet(mockI2C, board::i2c::CR1::STOP));
+
+        completeTransfer(0_c, dmaRxInterrupt);
+        REQUIRE(reg::bitIsSet(mockI2C, board::i2c::CR1::STOP));
+        REQUIRE(valueReceived);
+        REQUIRE(!reg::bitIsSet(mockI2C, board::i2c::CR2::LAST));
+    }
+
+    SECTION("A single byte read should NACK and stop in the address phase")
+    {
+        bool valueReceived = false;
+        std::uint8_t data = 0;
+        setRegisterBit(mockI2C, board::i2c::CR1::ACK);
+
+        auto op = async::connect(
+            dev.read(0x10, &data, 1),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveValue([&]() { valueReceived = true; })));
+        async::start(op);
+
+        REQUIRE(!reg::bitIsSet(mockI2C, board::i2c::CR2::LAST));
+
+        generateStartCondition();
+        doAddressPhase();
+        REQUIRE(!reg::bitIsSet(mockI2C, board::i2c::CR1::ACK));
+        REQUIRE(reg::bitIsSet(mockI2C, board::i2c::CR1::STOP));
+        REQUIRE(!valueReceived);
+
+        completeTransfer(0_c, dmaRxInterrupt);
+        REQUIRE(valueReceived);
+    }
+
+    SECTION("Write and read should restart after the write phase")
+    {
+        bool valueReceived = false;
+        const std::uint8_t address = 0x2A;
+        std::uint8_t data[2] = {};
+
+        auto op = async::connect(
+            dev.writeAndRead(0x10, &address, 1, data, 2),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveValue([&]() { valueReceived = true; })));
+        async::start(op);
+
+        REQUIRE(!reg::bitIsSet(mockI2C, board::i2c::CR2::LAST));
+        generateStartCondition();
+        REQUIRE(reg::read(mockI2C, board::i2c::DR::DR) == 0x20);
+        doAddressPhase();
+        clearRegisterBit(mockI2C, board::i2c::CR1::START);
+
+        completeTransfer(6_c, dmaTxInterrupt);
+        byteTransferFinished();
+        REQUIRE(reg::bitIsSet(mockI2C, board::i2c::CR1::START));
+        REQUIRE(!reg::bitIsSet(mockI2C, board::i2c::CR1::STOP));
+        REQUIRE(reg::bitIsSet(mockI2C, board::i2c::CR2::LAST));
+
+        generateStartCondition();
+        REQUIRE(reg::read(mockI2C, board::i2c::DR::DR) == 0x21);
+        doAddressPhase();
+
+        completeTransfer(0_c, dmaRxInterrupt);
+        REQUIRE(reg::bitIsSet(mockI2C, board::i2c::CR1::STOP));
+        REQUIRE(valueReceived);
+    }
+
+    SECTION("An acknowledge failure should complete the transaction with an error")
+    {
+        bool errorReceived = false;
+        const std::uint8_t data[2] = {1, 2};
+
+        auto op = async::connect(
+            dev.write(0x10, data, 2),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveError([&](i2c::I2cError error) { errorReceived = (error == i2c::I2cError::ACKNOWLEDGE_FAILURE); })));
+        async::start(op);
+
+        generateStartCondition();
+        setRegisterBit(mockI2C, board::i2c::SR1::AF);
+        errorInterrupt.raise();
+        clearRegisterBit(mockI2C, board::i2c::SR1::AF);
+
+        REQUIRE(errorReceived);
+        REQUIRE(reg::bitIsSet(mockI2C, board::i2c::CR1::STOP));
+        REQUIRE(!reg::bitIsSet(mockI2C, board::i2c::CR2::DMAEN));
+        REQUIRE(!reg::bitIsSet(mockDma, board::dma::CR::TCIE[6_c]));
+    }
+
+    SECTION("A DMA error should complete the transaction with an error")
+    {
+        bool errorReceived = false;
+        std::uint8_t data[2] = {};
+
+        auto op = async::connect(
+            dev.read(0x10, data, 2),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveError([&](i2c::I2cError error) { errorReceived = (error == i2c::I2cError::DMA_ERROR); })));
+        async::start(op);
+
+        generateStartCondition();
+        doAddressPhase();
+        setRegisterBit(mockDma, board::dma::ISR::TEIF[0_c]);
+        dmaRxInterrupt.raise();
+        clearRegisterBit(mockDma, board::dma::ISR::TEIF[0_c]);
+
+        REQUIRE(errorReceived);
+        REQUIRE(reg::bitIsSet(mockI2C, board::i2c::CR1::STOP));
+    }
+
+    SECTION("A second transaction should fail with BUSY while the first one runs")
+    {
+        bool busy = false;
+        const std::uint8_t data[2] = {1, 2};
+
+        auto op1 = async::connect(
+            dev.write(0x10, data, 2),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveValue([]() { })));
+        auto op2 = async::connect(
+            dev.write(0x11, data, 2),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveError([&](i2c::I2cError error) { busy = (error == i2c::I2cError::BUSY); })));
+
+        async::start(op1);
+        async::start(op2);
+        REQUIRE(busy);
+        op1.stop();
+    }
+}
+TEST_CASE("I2C bus")
+{
+    using namespace drivers;
+    using namespace hana::literals;
+    auto mockI2C = MockI2C{};
+    auto mockDma = MockDma{};
+    resetPeripheral(mockI2C);
+    resetPeripheral(mockDma);
+    auto scheduler = async::InlineScheduler{};
+
+    dma::Dma<MockDma, 6> dmaTx{async::EventEmitter{&dmaTxInterrupt}};
+    dma::Dma<MockDma, 0> dmaRx{async::EventEmitter{&dmaRxInterrupt}};
+    i2c::I2cDmaMaster<MockI2C, decltype(dmaTx), decltype(dmaRx)> master{
+        async::EventEmitter{&eventInterrupt}, 
+        async::EventEmitter{&errorInterrupt},
+        dmaTx,
+        dmaRx};
+
+    i2c::I2cBus bus{master};
+    i2c::I2cBusDevice sensor{bus};
+    i2c::I2cBusDevice codec{bus};
+    i2c::I2cBusDevice touch{bus, async::highestPriority};
+    const std::uint8_t data[2] = {0xF1, 0xF2};
+
+    // Runs the write on the bus to completion, returns the address byte sent
+    auto completeWrite = [&]() {
+        generateStartCondition();
+        std::uint8_t address = reg::read(mockI2C, board::i2c::DR::DR);
+        doAddressPhase();
+        setFieldValue(mockDma, board::dma::NDTR::NDT[6_c], 0U);
+        setRegisterBit(mockDma, board::dma::ISR::TCIF[6_c]);
+        dmaTxInterrupt.raise();
+        clearRegisterBit(mockDma, board::dma::ISR::TCIF[6_c]);
+        byteTransferFinished();
+        return address >> 1;
+    };
+
+    SECTION("A device on the bus should fullfill the I2cLike concept")
+    {
+        STATIC_REQUIRE(i2c::I2cLike<decltype(sensor)>);
+    }
+
+    SECTION("Transactions should be run back-to-back, by priority and then in order")
+    {
+        std::vector<int> completed;
+        auto op1 = async::connect(
+            sensor.write(0x10, data, 2),
+            async::addSchedulerToReceiver(scheduler, async::receiveValue([&]() { completed.push_back(1); })));
+        auto op2 = async::connect(
+            codec.write(0x11, data, 2),
+            async::addSchedulerToReceiver(scheduler, async::receiveValue([&]() { completed.push_back(2); })));
+        auto op3 = async::connect(
+            touch.write(0x12, data, 2),
+            async::addSchedulerToReceiver(scheduler, async::receiveValue([&]() { completed.push_back(3); })));
+
+        // Without the bus, the second transaction would fail with BUSY
+        op1.start();
+        op2.start();
+        op3.start();
+
+        REQUIRE(completeWrite() == 0x10);
+        REQUIRE(completed == std::vector<int>{1});
+
+        // The transaction of the higher priority device overtakes the queued one
+        REQUIRE(completeWrite() == 0x12);
+        REQUIRE(completed == std::vector<int>{1, 3});
+
+        REQUIRE(completeWrite() == 0x11);
+        REQUIRE(completed == std::vector<int>{1, 3, 2});
+    }
+
+    SECTION("Stopping a queued transaction should remove it from the queue")
+    {
+        std::vector<int> completed;
+        bool done = false;
+        auto op1 = async::connect(
+            sensor.write(0x10, data, 2),
+            async::addSchedulerToReceiver(scheduler, async::receiveValue([&]() { completed.push_back(1); })));
+        auto op2 = async::connect(
+            codec.write(0x11, data, 2),
+            async::addSchedulerToReceiver(scheduler, async::receiveDone([&]() { done = true; })));
+        auto op3 = async::connect(
+            codec.write(0x13, data, 2),
+            async::addSchedulerToReceiver(scheduler, async::receiveValue([&]() { completed.push_back(3); })));
+
+        op1.start();
+        op2.start();
+        op3.start();
+        op2.stop();
+        REQUIRE(done);
+
+        REQUIRE(completeWrite() == 0x10);
+        REQUIRE(completeWrite() == 0x13);
+        REQUIRE(completed == std::vector<int>{1, 3});
+    }
+
+    SECTION("Stopping the running transaction should hand the bus to the next one")
+    {
+        bool done = false;
+        bool completed = false;
+        auto op1 = async::connect(
+            sensor.write(0x10, data, 2),
+            async::addSchedulerToReceiver(scheduler, async::receiveDone([&]() { done = true; })));
+        auto op2 = async::connect(
+            codec.write(0x11, data, 2),
+            async::addSchedulerToReceiver(scheduler, async::receiveValue([&]() { completed = true; })));
+
+        op1.start();
+        op2.start();
+        generateStartCondition();
+        op1.stop();
+        REQUIRE(done);
+
+        REQUIRE(completeWrite() == 0x11);
+        REQUIRE(completed);
+    }
+}
@@ -1,8 +1,12 @@
 #include "../catch.hpp"
-#include <drivers/i2c/i2c_memory.hpp>
+#include "platform/stm32f4/i2c/i2c_memory.hpp"
 #include "../mocks/mock_i2c.hpp"
 #include "reg/write.hpp"
+#include "reg/read.hpp"
 #include "reg/field.hpp"
+#include <tuple>
+#include "async/just.hpp"
+#include "async/make_future.hpp"
 #include "async/receive.hpp"
 
 namespace 
@@ -13,6 +17,78 @@ namespace
 
     template<std::uint8_t offset, std::uint8_t bit, std::uint8_t size>
     constexpr auto field = reg::RWField<Location<offset>, reg::BitMask8<bit, size>>{};   
+
+    template<std::uint8_t offset>
+    using Location16 = reg::FieldLocation<std::uint16_t, mock_tag, reg::FieldOffset<std::uint8_t, offset>>;
+
+    template<std::uint8_t offset, std::uint8_t bit, std::uint8_t size>
+    constexpr auto field16 = reg::RWField<Location16<offset>, reg::BitMask16<bit, size>>{};
+
+    // Register 0x25 is a status register, bursts set the auto-increment flag
+    struct MockCachePolicy
+    {
+        static constexpr bool isVolatile(std::uint8_t offset)
+        {
+            return offset == 0x25;
+        }
+
+        static constexpr std::uint8_t burstOffset(std::uint8_t offset)
+        {
+            return offset | 0x80;
+        }
+    };
+
+    using MockCache = drivers::i2c::RegisterCache<std::uint8_t, 0x20, 8, MockCachePolicy>;
+
+    struct FailingI2c
+    {
+        auto read(std::uint8_t, std::uint8_t *, std::uint16_t) { return async::just(); }
+        auto write(std::uint8_t, const std::uint8_t *, std::uint16_t) { return async::justError(drivers::i2c::I2cError::ACKNOWLEDGE_FAILURE); }
+        auto writeAndRead(std::uint8_t, const std::uint8_t *, std::uint16_t, std::uint8_t *, std::uint16_t) { return async::just(); }
+    };
+
+    // Completes the writes while they are started, and counts the write
+    // operations that are destroyed before their start has returned
+    struct SynchronousI2c
+    {
+        template<class R>
+        struct WriteOperation
+        {
+            ~WriteOperation()
+            {
+                if (starting)
+                {
+                    ++i2c->destroyedWhileStarting;
+                }
+            }
+
+            void start()
+            {
+                starting = true;
+                ++i2c->writes;
+                async::setValue(std::move(receiver));
+                starting = false;
+            }
+
+            R receiver;
+            SynchronousI2c * i2c;
+            bool starting = false;
+        };
+
+        auto read(std::uint8_t, std::uint8_t *, std::uint16_t) { return async::just(); }
+        auto writeAndRead(std::uint8_t, const std::uint8_t *, std::uint16_t, std::uint8_t *, std::uint16_t) { return async::just(); }
+
+        auto write(std::uint8_t, const std::uint8_t *, std::uint16_t)
+        {
+            return async::makeFuture<void, drivers::i2c::I2cError>(
+                [this]<class R>(R && receiver) -> WriteOperation<std::remove_cvref_t<R>> {
+                    return {static_cast<R&&>(receiver), this};
+                });
+        }
+
+        int writes = 0;
+        int destroyedWhileStarting = 0;
+    };
 }
 
 TEST_CASE("I2c memory")
@@ -33,4 +109,148 @@ TEST_CASE("I2c memory")
         REQUIRE(mockI2c.readSlaveAddress == SLAVE_ADDRESS);
         REQUIRE(mockI2c.writeSlaveAddress == SLAVE_ADDRESS);
     }
-}
\ No newline at end of file
+
+    SECTION("cached read-modify-write only reads the register once")
+    {
+        i2c::I2cMemory<MockI2c, mock_tag, i2c::detail::DefaultAddressSerializer, MockCache> memory{mockI2c, SLAVE_ADDRESS};
+        mockI2c.readBuffer = {0xF0};
+
+        auto op1 = async::connect(reg::write(memory, field<0x21, 0, 2>, 0x1), async::receiveValue([]() { }));
+        async::start(op1);
+        auto op2 = async::connect(reg::write(memory, field<0x21, 2, 2>, 0x2), async::receiveValue([]() { }));
+        async::start(op2);
+
+        std::uint8_t value = 0;
+        auto op3 = async::connect(reg::read(memory, field<0x21, 0, 8>), async::receiveValue([&](std::uint8_t v) { value = v; }));
+        async::start(op3);
+
+        REQUIRE(mockI2c.writeAndReadCount == 1);
+        REQUIRE(value == 0xF9);
+
+        // Writes are deferred until flush
+        REQUIRE(mockI2c.writes.empty());
+
+        bool flushed = false;
+        auto flushOp = async::connect(memory.flush(), async::receiveValue([&]() { flushed = true; }));
+        async::start(flushOp);
+
+        REQUIRE(flushed);
+        REQUIRE(mockI2c.writes == std::vector<std::vector<std::uint8_t>>{{0xA1, 0xF9}});
+    }
+
+    SECTION("flush writes contiguous dirty registers in one burst")
+    {
+        i2c::I2cMemory<MockI2c, mock_tag, i2c::detail::DefaultAddressSerializer, MockCache> memory{mockI2c, SLAVE_ADDRESS};
+
+        auto op1 = async::connect(reg::write(memory, field<0x23, 0, 8>, 0x33), async::receiveValue([]() { }));
+        async::start(op1);
+        auto op2 = async::connect(reg::write(memory, field<0x22, 0, 8>, 0x22), async::receiveValue([]() { }));
+        async::start(op2);
+        auto op3 = async::connect(reg::write(memory, field<0x27, 0, 8>, 0x77), async::receiveValue([]() { }));
+        async::start(op3);
+
+        auto flushOp = async::connect(memory.flush(), async::receiveValue([]() { }));
+        async::start(flushOp);
+
+        REQUIRE(mockI2c.writes == std::vector<std::vector<std::uint8_t>>{{0xA2, 0x22, 0x33}, {0xA7, 0x77}});
+
+        // Nothing left to write
+        mockI2c.writes.clear();
+        auto flushOp2 = async::connect(memory.flush(), async::receiveValue([]() { }));
+        async::start(flushOp2);
+        REQUIRE(mockI2c.writes.empty());
+    }
+
+    SECTION("flush starts the next write once a synchronous write has returned")
+    {
+        SynchronousI2c synchronousI2c;
+        i2c::I2cMemory<SynchronousI2c, mock_tag, i2c::detail::DefaultAddressSerializer, MockCache> memory{synchronousI2c, SLAVE_ADDRESS};
+
+        auto op1 = async::connect(reg::write(memory, field<0x20, 0, 8>, 0x11), async::receiveValue([]() { }));
+        async::start(op1);
+        auto op2 = async::connect(reg::write(memory, field<0x22, 0, 8>, 0x22), async::receiveValue([]() { }));
+        async::start(op2);
+        auto op3 = async::connect(reg::write(memory, field<0x24, 0, 8>, 0x44), async::receiveValue([]() { }));
+        async::start(op3);
+
+        bool flushed = false;
+        auto flushOp = async::connect(memory.flush(), async::receiveValue([&]() { flushed = true; }));
+        async::start(flushOp);
+
+        REQUIRE(flushed);
+        REQUIRE(synchronousI2c.writes == 3);
+        REQUIRE(synchronousI2c.destroyedWhileStarting == 0);
+    }
+
+    SECTION("volatile and uncached registers are accessed on the device")
+    {
+        i2c::I2cMemory<MockI2c, mock_tag, i2c::detail::DefaultAddressSerializer, MockCache> memory{mockI2c, SLAVE_ADDRESS};
+
+        auto op1 = async::connect(reg::write(memory, field<0x25, 0, 8>, 0x55), async::receiveValue([]() { }));
+        async::start(op1);
+        auto op2 = async::connect(reg::write(memory, field<0x10, 0, 8>, 0x10), async::receiveValue([]() { }));
+        async::start(op2);
+        auto op3 = async::connect(reg::read(memory, field<0x25, 0, 8>), async::receiveValue([](std::uint8_t) { }));
+        async::start(op3);
+        auto op4 = async::connect(reg::read(memory, field<0x25, 0, 8>), async::receiveValue([](std::uint8_t) { }));
+        async::start(op4);
+
+        REQUIRE(mockI2c.writes.size() == 2);
+        REQUIRE(mockI2c.writeAndReadCount == 4);
+    }
+
+    SECTION("failed flush keeps the registers dirty")
+    {
+        FailingI2c failingI2c;
+        i2c::I2cMemory<FailingI2c, mock_tag, i2c::detail::DefaultAddressSerializer, MockCache> memory{failingI2c, SLAVE_ADDRESS};
+
+        auto op1 = async::connect(reg::write(memory, field<0x20, 0, 8>, 0x11), async::receiveValue([]() { }));
+        async::start(op1);
+
+        int errors = 0;
+        auto flushOp1 = async::connect(memory.flush(), async::receiveError([&](i2c::I2cError) { ++errors; }));
+        async::start(flushOp1);
+        auto flushOp2 = async::connect(memory.flush(), async::receiveError([&](i2c::I2cError) { ++errors; }));
+        async::start(flushOp2);
+
+        REQUIRE(errors == 2);
+    }
+
+    SECTION("read block")
+    {
+        i2c::I2cMemory<MockI2c, mock_tag> memory{mockI2c, SLAVE_ADDRESS};
+        mockI2c.readBuffer = {0xB4, 0x01, 0x02, 0x00, 0x03};
+
+        std::tuple<std::uint8_t, std::uint16_t, std::uint16_t, std::uint8_t> values;
+        auto op = async::connect(
+            memory.readBlock(
+                reg::read(field<0x10, 0, 8>),
+                reg::read(field16<0x11, 0, 4>),
+                reg::read(field16<0x11, 8, 4>),
+                reg::read(field<0x14, 0, 2>)),
+            async::receiveValue([&](auto v) { values = v; }));
+        async::start(op);
+
+        // One transaction for the whole block
+        REQUIRE(mockI2c.writeAndReadCount == 1);
+        REQUIRE(values == std::make_tuple(std::uint8_t{0xB4}, std::uint16_t{0x1}, std::uint16_t{0x2}, std::uint8_t{0x3}));
+    }
+
+    SECTION("write block")
+    {
+        i2c::I2cMemory<MockI2c, mock_tag> memory{mockI2c, SLAVE_ADDRESS};
+
+        bool written = false;
+        auto op = async::connect(
+            memory.writeBlock(
+                reg::write(field<0x12, 0, 4>, 0x5),
+                reg::write(field<0x12, 4, 4>, 0xA),
+                reg::write(field<0x13, 0, 8>, 0x42)),
+            async::receiveValue([&]() { written = true; }));
+        async::start(op);
+
+        REQUIRE(written);
+        REQUIRE(mockI2c.writeAndReadCount == 0);
+        REQUIRE(mockI2c.writes == std::vector<std::vector<std::uint8_t>>{{0x12, 0xA5, 0x42}});
+    }
+}
@@ -3,13 +3,21 @@
 #include "drivers/gpio.hpp"
 #include "../mocks/mock_peripheral.hpp"
 #include "../mocks/mock_board.hpp"
+#include "drivers/dma.hpp"
+#include "schedulers/cooperative_scheduler.hpp"
+#include "async/receive.hpp"
+#include "async/use_scheduler.hpp"
 #include <ratio>
+#include <vector>
 
 using MockSpi = MockPeripheral<board::spi::tag>;
 using MockGpio = MockPeripheral<board::gpio::tag>;
+using MockDma = MockPeripheral<board::dma::tag>;
 
 namespace {
     async::Event spiInterrupt;
+    async::Event dmaInterrupt;
+    async::Event sysTickInterrupt;
 
     struct MockPeripherals
     {
@@ -17,6 +25,7 @@ namespace {
         constexpr MockGpio getPeripheral(PeripheralTypes::tags::Gpio<0>) const { return {}; }
 
         async::EventEmitter getInterruptEvent(decltype(board::Interrupts::SPI1)) { return {&spiInterrupt}; }
+        async::EventEmitter getInterruptEvent(decltype(board::Interrupts::SysTick)) { return {&sysTickInterrupt}; }
     };
 }
 
@@ -87,4 +96,129 @@ TEST_CASE("I2S")
 
         REQUIRE(reg::read(mockSpi, board::spi::DR::DR) == value);
     }*/
-}
\ No newline at end of file
+}
+
+TEST_CASE("I2S continuous write")
+{
+    using namespace drivers;
+    using namespace hana::literals;
+    auto mockSpi = MockSpi{};
+    auto mockDma = MockDma{};
+    resetPeripheral(mockSpi);
+    resetPeripheral(mockDma);
+    MockBoard<MockPeripherals> mockBoard;
+    auto scheduler = schedulers::makeCooperativeScheduler(mockBoard);
+
+    i2s::I2S<MockSpi> i2sDevice{async::EventEmitter{&spiInterrupt}};
+    dma::Dma<MockDma, 4> dmaStream{async::EventEmitter{&dmaInterrupt}};
+
+    std::uint16_t buffer0[4] = {};
+    std::uint16_t buffer1[4] = {};
+    std::uint16_t * buffers[2] = {buffer0, buffer1};
+    std::vector<std::uint16_t *> filled;
+    auto fill = [&](std::uint16_t * buffer, std::uint32_t size) {
+        REQUIRE(size == 4);
+        filled.push_back(buffer);
+    };
+
+    // The DMA raises the transfer complete interrupt when it switches to the other memory target
+    auto completeTransfer = [&](std::uint32_t nextTarget) {
+        setFieldValue(mockDma, board::dma::CR::CT[4_c], nextTarget);
+        setRegisterBit(mockDma, board::dma::ISR::TCIF[4_c]);
+        dmaInterrupt.raise();
+        clearRegisterBit(mockDma, board::dma::ISR::TCIF[4_c]);
+    };
+
+    SECTION("Both buffers should be filled before the double buffered transfer starts")
+    {
+        auto op = async::connect(
+            i2sDevice.writeContinuous(dmaStream, buffers, 4, fill),
+            async::addSchedulerToReceiver(scheduler, async::receiveValue([]() { })));
+        async::start(op);
+
+        REQUIRE(filled == std::vector<std::uint16_t *>{buffer0, buffer1});
+        REQUIRE(reg::bitIsSet(mockSpi, board::spi::CR2::TXDMAEN));
+        REQUIRE(reg::bitIsSet(mockDma, board::dma::CR::DBM[4_c]));
+        REQUIRE(reg::bitIsSet(mockDma, board::dma::CR::EN[4_c]));
+        op.stop();
+    }
+
+    SECTION("The buffer the DMA is done with should be posted to the callback")
+    {
+        auto op = async::connect(
+            i2sDevice.writeContinuous(dmaStream, buffers, 4, fill),
+            async::addSchedulerToReceiver(scheduler, async::receiveValue([]() { })));
+        async::start(op);
+        filled.clear();
+
+        completeTransfer(1);
+        REQUIRE(filled.empty());
+        scheduler.poll();
+        REQUIRE(filled == std::vector<std::uint16_t *>{buffer0});
+
+        completeTransfer(0);
+        scheduler.poll();
+        REQUIRE(filled == std::vector<std::uint16_t *>{buffer0, buffer1});
+        REQUIRE(i2sDevice.getUnderrunCount() == 0);
+        op.stop();
+    }
+
+    SECTION("A buffer that is not refilled in time should count as an underrun")
+    {
+        auto op = async::connect(
+            i2sDevice.writeContinuous(dmaStream, buffers, 4, fill),
+            async::addSchedulerToReceiver(scheduler, async::receiveValue([]() { })));
+        async::start(op);
+
+        // The DMA moves on to buffer 0 before it has been refilled
+        completeTransfer(1);
+        completeTransfer(0);
+        REQUIRE(i2sDevice.getUnderrunCount() == 1);
+
+        scheduler.pollBatch(2);
+        completeTransfer(1);
+        REQUIRE(i2sDevice.getUnderrunCount() == 1);
+        op.stop();
+        scheduler.pollBatch(2);
+    }
+
+    SECTION("A circular transfer should refill the halves of the buffer")
+    {
+        std::uint16_t buffer[8] = {};
+        auto op = async::connect(
+            i2sDevice.writeContinuous(dmaStream, buffer, 8, fill),
+            async::addSchedulerToReceiver(scheduler, async::receiveValue([]() { })));
+        async::start(op);
+        REQUIRE(filled == std::vector<std::uint16_t *>{buffer, buffer + 4});
+        REQUIRE(reg::bitIsSet(mockDma, board::dma::CR::CIRC[4_c]));
+        REQUIRE(reg::bitIsSet(mockDma, board::dma::CR::HTIE[4_c]));
+        filled.clear();
+
+        setRegisterBit(mockDma, board::dma::ISR::HTIF[4_c]);
+        dmaInterrupt.raise();
+        clearRegisterBit(mockDma, board::dma::ISR::HTIF[4_c]);
+        scheduler.poll();
+        REQUIRE(filled == std::vector<std::uint16_t *>{buffer});
+
+        setRegisterBit(mockDma, board::dma::ISR::TCIF[4_c]);
+        dmaInterrupt.raise();
+        clearRegisterBit(mockDma, board::dma::ISR::TCIF[4_c]);
+        scheduler.poll();
+        REQUIRE(filled == std::vector<std::uint16_t *>{buffer, buffer + 4});
+        op.stop();
+    }
+
+    SECTION("Stopping should disable the DMA request")
+    {
+        bool done = false;
+        auto op = async::connect(
+            i2sDevice.writeContinuous(dmaStream, buffers, 4, fill),
+            async::addSchedulerToReceiver(scheduler, async::receiveDone([&]() { done = true; })));
+        async::start(op);
+        op.stop();
+
+        REQUIRE(done);
+        REQUIRE(!reg::bitIsSet(mockSpi, board::spi::CR2::TXDMAEN));
+        REQUIRE(!reg::bitIsSet(mockDma, board::dma::CR::TCIE[4_c]));
+    }
+}
@@ -3,17 +3,21 @@
 #include "../mocks/mock_board.hpp"
 #include "async/future.hpp"
 #include "async/receive.hpp"
-#include "async/execute_sync.hpp"
 #include "async/use_scheduler.hpp"
 #include "async/inline_scheduler.hpp"
 #include "board/regmap/spi.hpp"
 #include "drivers/spi.hpp"
+#include "drivers/dma.hpp"
+#include <vector>
 
 using MockSpi = MockPeripheral<board::spi::tag>;
+using MockDma = MockPeripheral<board::dma::tag>;
 template<class ... Ts> struct TypeList;
 
 namespace {
     async::Event spiInterruptEvent;
+    async::Event dmaTxInterruptEvent;
+    async::Event dmaRxInterruptEvent;
     struct MockPeripherals
     {
         constexpr MockSpi getPeripheral(PeripheralTypes::tags::Spi<0>) const { return {}; }
@@ -22,6 +26,15 @@ namespace {
 
         async::EventEmitter getInterruptEvent(decltype(board::Interrupts::SPI1)) { return {&spiInterruptEvent}; }
     };
+
+    // Chip select pin, active low
+    struct MockCsPin
+    {
+        void set() { *selected = false; }
+        void clear() { *selected = true; }
+
+        bool * selected;
+    };
 }
 
 TEST_CASE("Spi make")
@@ -254,11 +267,17 @@ TEST_CASE("Spi read and write")
 
     SECTION("The read operation should finish instantaneously when the input is empty")
     {
+        bool valueReceived = false;
         std::uint8_t readBuffer[1] = {0};
 
-        auto outcome = async::executeSync(scheduler, spi.read(readBuffer, 0));
+        auto op = async::connect(
+            spi.read(readBuffer, 0),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveValue([&]() { valueReceived = true; })));
 
-        REQUIRE(outcome == async::makeSuccess<SpiError>());
+        op.start();
+        REQUIRE(valueReceived);
         REQUIRE(!reg::bitIsSet(mockSpi, board::spi::CR2::RXNEIE));
     }
 
@@ -283,4 +302,404 @@ TEST_CASE("Spi read and write")
         REQUIRE(valueReceived);
         REQUIRE(!reg::bitIsSet(mockSpi, board::spi::CR2::RXNEIE));
     }
+}
+
+TEST_CASE("Spi DMA transfer")
+{
+    using namespace drivers;
+    using namespace hana::literals;
+    MockSpi mockSpi{};
+    MockDma mockDma{};
+    resetPeripheral(mockSpi);
+    resetPeripheral(mockDma);
+    auto scheduler = async::InlineScheduler{};
+    // Idle, the transmit buffer is empty and the last frame has been sent
+    setRegisterBit(mockSpi, board::spi::SR::TXE);
+
+    spi::Spi<MockSpi, std::uint8_t, spi::BusConfig::FULL_DUPLEX> spiDevice{async::EventEmitter{&spiInterruptEvent}};
+    dma::Dma<MockDma, 3> dmaTx{async::EventEmitter{&dmaTxInterruptEvent}};
+    dma::Dma<MockDma, 2> dmaRx{async::EventEmitter{&dmaRxInterruptEvent}};
+    const std::uint8_t txData[4] = {1, 2, 3, 4};
+    std::uint8_t rxData[4] = {};
+
+    SECTION("The transfer future should fullfill the Future concept")
+    {
+        STATIC_REQUIRE(async::Future<decltype(spiDevice.transfer(dmaTx, dmaRx, txData, rxData, 4)), void, spi::SpiError>);
+    }
+
+    SECTION("The transfer should finish instantaneously when the input is empty")
+    {
+        bool valueReceived = false;
+        auto op = async::connect(
+            spiDevice.transfer(dmaTx, dmaRx, txData, rxData, 0),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveValue([&]() { valueReceived = true; })));
+
+        op.start();
+        REQUIRE(valueReceived);
+        REQUIRE(!reg::bitIsSet(mockSpi, board::spi::CR2::TXDMAEN));
+    }
+
+    SECTION("The transfer should start both streams and enable the DMA requests")
+    {
+        auto op = async::connect(
+            spiDevice.transfer(dmaTx, dmaRx, txData, rxData, 4),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveValue([]() { })));
+
+        op.start();
+        REQUIRE(reg::bitIsSet(mockSpi, board::spi::CR2::TXDMAEN));
+        REQUIRE(reg::bitIsSet(mockSpi, board::spi::CR2::RXDMAEN));
+        REQUIRE(!reg::bitIsSet(mockSpi, board::spi::CR2::TXEIE));
+        REQUIRE(!reg::bitIsSet(mockSpi, board::spi::CR2::RXNEIE));
+        REQUIRE(reg::bitIsSet(mockDma, board::dma::CR::EN[3_c]));
+        REQUIRE(reg::bitIsSet(mockDma, board::dma::CR::EN[2_c]));
+        REQUIRE(reg::read(mockDma, board::dma::CR::DIR[3_c]) == 1); // Memory to peripheral
+        REQUIRE(reg::read(mockDma, board::dma::CR::DIR[2_c]) == 0); // Peripheral to memory
+        REQUIRE(reg::read(mockDma, board::dma::NDTR::NDT[3_c]) == 4);
+        REQUIRE(reg::read(mockDma, board::dma::NDTR::NDT[2_c]) == 4);
+
+        op.stop();
+        REQUIRE(!reg::bitIsSet(mockSpi, board::spi::CR2::TXDMAEN));
+        REQUIRE(!reg::bitIsSet(mockSpi, board::spi::CR2::RXDMAEN));
+    }
+
+    SECTION("The transfer should complete on the RX transfer complete only")
+    {
+        bool valueReceived = false;
+        auto op = async::connect(
+            spiDevice.transfer(dmaTx, dmaRx, txData, rxData, 4),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveValue([&]() { valueReceived = true; })));
+
+        op.start();
+        setRegisterBit(mockDma, board::dma::ISR::TCIF[3_c]);
+        dmaTxInterruptEvent.raise();
+        clearRegisterBit(mockDma, board::dma::ISR::TCIF[3_c]);
+        REQUIRE(!valueReceived);
+
+        setRegisterBit(mockDma, board::dma::ISR::TCIF[2_c]);
+        dmaRxInterruptEvent.raise();
+        REQUIRE(valueReceived);
+        REQUIRE(!reg::bitIsSet(mockSpi, board::spi::CR2::TXDMAEN));
+        REQUIRE(!reg::bitIsSet(mockSpi, board::spi::CR2::RXDMAEN));
+    }
+
+    SECTION("A transfer error on either stream should complete the transfer with an error")
+    {
+        int errors = 0;
+        auto op = async::connect(
+            spiDevice.transfer(dmaTx, dmaRx, txData, rxData, 4),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveError([&](spi::SpiError error) { 
+                    REQUIRE(error == spi::SpiError::DMA_ERROR);
+                    ++errors; 
+                })));
+
+        op.start();
+        setRegisterBit(mockDma, board::dma::ISR::TEIF[3_c]);
+        dmaTxInterruptEvent.raise();
+        REQUIRE(errors == 1);
+        REQUIRE(!reg::bitIsSet(mockDma, board::dma::CR::TCIE[2_c]));
+    }
+
+    SECTION("The transfer should fail with BUSY if a stream is in use")
+    {
+        auto op1 = async::connect(
+            spiDevice.transfer(dmaTx, dmaRx, txData, rxData, 4),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveValue([]() { })));
+
+        bool busy = false;
+        auto op2 = async::connect(
+            spiDevice.transfer(dmaTx, dmaRx, txData, rxData, 4),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveError([&](spi::SpiError error) { busy = (error == spi::SpiError::BUSY); })));
+
+        op1.start();
+        op2.start();
+        REQUIRE(busy);
+        op1.stop();
+    }
+}
+
+TEST_CASE("Spi bus")
+{
+    using namespace drivers;
+    using namespace hana::literals;
+    MockSpi mockSpi{};
+    MockDma mockDma{};
+    resetPeripheral(mockSpi);
+    resetPeripheral(mockDma);
+    auto scheduler = async::InlineScheduler{};
+    // Idle, the transmit buffer is empty and the last frame has been sent
+    setRegisterBit(mockSpi, board::spi::SR::TXE);
+
+    spi::Spi<MockSpi, std::uint8_t, spi::BusConfig::FULL_DUPLEX> spiDevice{async::EventEmitter{&spiInterruptEvent}};
+    dma::Dma<MockDma, 3> dmaTx{async::EventEmitter{&dmaTxInterruptEvent}};
+    dma::Dma<MockDma, 2> dmaRx{async::EventEmitter{&dmaRxInterruptEvent}};
+    const std::uint8_t txData[4] = {1, 2, 3, 4};
+    std::uint8_t rxData[4] = {};
+
+    bool flashSelected = true;
+    bool displaySelected = true;
+    spi::SpiBus bus{spiDevice};
+    spi::SpiDevice flash{bus, MockCsPin{&flashSelected}, spi::DeviceConfig{
+        .baudRateDivider = spi::BaudRateDivider::PCKL_DIV4
+    }};
+    spi::SpiDevice display{bus, MockCsPin{&displaySelected}, spi::DeviceConfig{
+        .clockPolarity = spi::ClockPolarity::HIGH,
+        .clockPhase = spi::ClockPhase::HIGH,
+        .dataFrameFormat = spi::DataFrameFormat::HALF_WORD,
+        .bitOrder = spi::BitOrder::MSB_FIRST
+    }};
+
+    auto completeTransfer = [&]() {
+        setRegisterBit(mockDma, board::dma::ISR::TCIF[2_c]);
+        dmaRxInterruptEvent.raise();
+        clearRegisterBit(mockDma, board::dma::ISR::TCIF[2_c]);
+    };
+
+    SECTION("Registering a device should deselect it")
+    {
+        REQUIRE(!flashSelected);
+        REQUIRE(!displaySelected);
+    }
+
+    SECTION("A transaction should fullfill the Future concept of the wrapped future")
+    {
+        STATIC_REQUIRE(async::Future<
+            decltype(flash.transaction(spiDevice.transfer(dmaTx, dmaRx, txData, rxData, 4))), 
+            void, 
+            spi::SpiError>);
+    }
+
+    SECTION("A transaction should configure the bus and select the device while it runs")
+    {
+        bool valueReceived = false;
+        auto op = async::connect(
+            display.transaction(spiDevice.transfer(dmaTx, dmaRx, txData, rxData, 4)),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveValue([&]() { valueReceived = true; })));
+
+        op.start();
+        REQUIRE(reg::bitIsSet(mockSpi, board::spi::CR1::SPE));
+        REQUIRE(reg::bitIsSet(mockSpi, board::spi::CR1::CPOL));
+        REQUIRE(reg::bitIsSet(mockSpi, board::spi::CR1::CPHA));
+        REQUIRE(reg::bitIsSet(mockSpi, board::spi::CR1::DFF));
+        REQUIRE(!reg::bitIsSet(mockSpi, board::spi::CR1::LSBFIRST));
+        REQUIRE(reg::bitIsSet(mockSpi, board::spi::CR2::RXDMAEN));
+        REQUIRE(displaySelected);
+        REQUIRE(!flashSelected);
+
+        completeTransfer();
+        REQUIRE(valueReceived);
+        REQUIRE(!displaySelected);
+    }
+
+    SECTION("Transactions should be queued and run back-to-back")
+    {
+        std::vector<int> completed;
+        auto op1 = async::connect(
+            flash.transaction(spiDevice.transfer(dmaTx, dmaRx, txData, rxData, 4)),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveValue([&]() { completed.push_back(1); })));
+        auto op2 = async::connect(
+            display.transaction(spiDevice.transfer(dmaTx, dmaRx, txData, rxData, 4)),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveValue([&]() { completed.push_back(2); })));
+
+        op1.start();
+        op2.start();
+        REQUIRE(flashSelected);
+        REQUIRE(!displaySelected);
+        REQUIRE(reg::bitIsSet(mockSpi, board::spi::CR1::LSBFIRST));
+        REQUIRE(reg::read(mockSpi, board::spi::CR1::BR) == 1); // PCKL_DIV4
+
+        completeTransfer();
+        REQUIRE(completed == std::vector<int>{1});
+        REQUIRE(!flashSelected);
+        REQUIRE(displaySelected);
+        REQUIRE(!reg::bitIsSet(mockSpi, board::spi::CR1::LSBFIRST));
+        REQUIRE(reg::bitIsSet(mockDma, board::dma::CR::EN[2_c]));
+
+        completeTransfer();
+        REQUIRE(completed == std::vector<int>{1, 2});
+        REQUIRE(!displaySelected);
+    }
+
+    SECTION("The configuration should not be rewritten for consecutive transactions of the same device")
+    {
+        int completed = 0;
+        auto op1 = async::connect(
+            flash.transaction(spiDevice.transfer(dmaTx, dmaRx, txData, rxData, 4)),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveValue([&]() { ++completed; })));
+        auto op2 = async::connect(
+            flash.transaction(spiDevice.transfer(dmaTx, dmaRx, txData, rxData, 4)),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveValue([&]() { ++completed; })));
+
+        op1.start();
+        op2.start();
+        // Only visible if the bus writes the configuration again
+        reg::write(mockSpi, board::spi::CR1::BR, spi::BaudRateDivider::PCKL_DIV8);
+
+        completeTransfer();
+        REQUIRE(flashSelected);
+        REQUIRE(reg::read(mockSpi, board::spi::CR1::BR) == 2); // PCKL_DIV8
+
+        completeTransfer();
+        REQUIRE(completed == 2);
+    }
+
+    SECTION("An error should complete only the failing transaction")
+    {
+        bool errorReceived = false;
+        bool valueReceived = false;
+        auto op1 = async::connect(
+            flash.transaction(spiDevice.transfer(dmaTx, dmaRx, txData, rxData, 4)),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveError([&](spi::SpiError error) { errorReceived = (error == spi::SpiError::DMA_ERROR); })));
+        auto op2 = async::connect(
+            display.transaction(spiDevice.transfer(dmaTx, dmaRx, txData, rxData, 4)),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveValue([&]() { valueReceived = true; })));
+
+        op1.start();
+        op2.start();
+        setRegisterBit(mockDma, board::dma::ISR::TEIF[2_c]);
+        dmaRxInterruptEvent.raise();
+        clearRegisterBit(mockDma, board::dma::ISR::TEIF[2_c]);
+        REQUIRE(errorReceived);
+        REQUIRE(!flashSelected);
+        REQUIRE(displaySelected);
+
+        completeTransfer();
+        REQUIRE(valueReceived);
+    }
+
+    SECTION("Stopping a queued transaction should remove it from the queue")
+    {
+        bool doneReceived = false;
+        int completed = 0;
+        auto op1 = async::connect(
+            flash.transaction(spiDevice.transfer(dmaTx, dmaRx, txData, rxData, 4)),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveValue([&]() { ++completed; })));
+        auto op2 = async::connect(
+            display.transaction(spiDevice.transfer(dmaTx, dmaRx, txData, rxData, 4)),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveDone([&]() { doneReceived = true; })));
+        auto op3 = async::connect(
+            flash.transaction(spiDevice.transfer(dmaTx, dmaRx, txData, rxData, 4)),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveValue([&]() { ++completed; })));
+
+        op1.start();
+        op2.start();
+        op3.start();
+        op2.stop();
+        REQUIRE(doneReceived);
+
+        completeTransfer();
+        REQUIRE(!displaySelected);
+        REQUIRE(flashSelected);
+
+        completeTransfer();
+        REQUIRE(completed == 2);
+    }
+
+    SECTION("Stopping the running transaction should deselect the device and run the next one")
+    {
+        bool doneReceived = false;
+        bool valueReceived = false;
+        auto op1 = async::connect(
+            flash.transaction(spiDevice.transfer(dmaTx, dmaRx, txData, rxData, 4)),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveDone([&]() { doneReceived = true; })));
+        auto op2 = async::connect(
+            display.transaction(spiDevice.transfer(dmaTx, dmaRx, txData, rxData, 4)),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveValue([&]() { valueReceived = true; })));
+
+        op1.start();
+        op2.start();
+        op1.stop();
+        REQUIRE(doneReceived);
+        REQUIRE(!flashSelected);
+        REQUIRE(displaySelected);
+
+        completeTransfer();
+        REQUIRE(valueReceived);
+    }
+    SECTION("The device should be deselected and SPE cleared only once the last frame has been sent")
+    {
+        // The last frame is still in the shift register when the future completes
+        constexpr std::uint32_t srOffset = hana::value(board::spi::SR::_Offset::Offset{});
+        constexpr std::uint32_t cr1Offset = hana::value(board::spi::CR1::_Offset::Offset{});
+        constexpr std::uint32_t speMask = 1U << 6;
+        int statusReads = 0;
+        bool flashSelectedWhenSent = false;
+        bool disabledWhileBusy = false;
+        setOnRead(mockSpi, [&](std::uint32_t offset) {
+            if (offset == srOffset && ++statusReads == 3)
+            {
+                setRegisterBit(mockSpi, board::spi::SR::TXE);
+                clearRegisterBit(mockSpi, board::spi::SR::BSY);
+                flashSelectedWhenSent = flashSelected;
+            }
+        });
+        setOnWrite(mockSpi, [&](std::uint32_t offset, std::uint32_t value) {
+            if (offset == cr1Offset && (value & speMask) == 0U && registerBitIsSet(mockSpi, board::spi::SR::BSY))
+            {
+                disabledWhileBusy = true;
+            }
+        });
+
+        int completed = 0;
+        auto op1 = async::connect(
+            flash.transaction(spiDevice.transfer(dmaTx, dmaRx, txData, rxData, 4)),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveValue([&]() { ++completed; })));
+        auto op2 = async::connect(
+            display.transaction(spiDevice.transfer(dmaTx, dmaRx, txData, rxData, 4)),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveValue([&]() { ++completed; })));
+
+        op1.start();
+        op2.start();
+        statusReads = 0;
+        clearRegisterBit(mockSpi, board::spi::SR::TXE);
+        setRegisterBit(mockSpi, board::spi::SR::BSY);
+
+        completeTransfer();
+        REQUIRE(flashSelectedWhenSent);
+        REQUIRE(!flashSelected);
+        REQUIRE(displaySelected);
+        REQUIRE(!disabledWhileBusy);
+
+        completeTransfer();
+        REQUIRE(completed == 2);
+    }
 }
\ No newline at end of file
@@ -3,15 +3,24 @@
 #include "../mocks/mock_peripheral.hpp"
 #include "../mocks/mock_board.hpp"
 #include "drivers/uart.hpp"
+#include "drivers/dma.hpp"
 #include <async/future.hpp>
+#include "async/receive.hpp"
+#include "async/use_scheduler.hpp"
+#include "async/inline_scheduler.hpp"
+#include <optional>
+#include <span>
+#include <vector>
 
 using MockUart = MockPeripheral<board::uart::tag>;
+using MockDma = MockPeripheral<board::dma::tag>;
 using MockGpio = MockPeripheral<board::gpio::tag>;
 using MockExti = MockPeripheral<board::exti::tag>;
 using MockSysCfg = MockPeripheral<board::syscfg::tag>;
 
 namespace {
     async::Event interruptEvent;
+    async::Event dmaInterruptEvent;
 }
 
 struct MockPeripherals
@@ -127,4 +136,353 @@ TEST_CASE("Uart")
         STATIC_REQUIRE(async::detail::has_future_types<FutureType>);
         STATIC_REQUIRE(async::Future<FutureType, void, uart::UartError>);
     }
+}
+
+TEST_CASE("Uart DMA write")
+{
+    using namespace drivers;
+    using namespace hana::literals;
+    resetPeripheral(MockUart{});
+    resetPeripheral(MockDma{});
+
+    async::InlineScheduler scheduler;
+    uart::Uart<MockUart> device{async::EventEmitter{&interruptEvent}};
+    dma::Dma<MockDma, 1> dmaStream{async::EventEmitter{&dmaInterruptEvent}};
+    const std::uint8_t data[] = {1, 2, 3, 4};
+
+    SECTION("WriteDma should return a future")
+    {
+        using FutureType = decltype(device.writeDma(dmaStream, data, 4));
+        STATIC_REQUIRE(async::Future<FutureType, void, uart::UartError>);
+    }
+
+    SECTION("WriteDma should finish instantaneously when the input is empty")
+    {
+        bool valueReceived = false;
+        auto op = async::connect(
+            device.writeDma(dmaStream, data, 0),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveValue([&]() { valueReceived = true; })));
+
+        op.start();
+        REQUIRE(valueReceived);
+        REQUIRE(!reg::bitIsSet(MockDma{}, board::dma::CR::EN[1_c]));
+    }
+
+    SECTION("WriteDma should start the stream and enable DMA transmission")
+    {
+        auto op = async::connect(
+            device.writeDma(dmaStream, data, 4),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveValue([]() { })));
+
+        op.start();
+        REQUIRE(reg::bitIsSet(MockUart{}, board::uart::CR3::DMAT));
+        REQUIRE(!reg::bitIsSet(MockUart{}, board::uart::CR1::TXEIE));
+        REQUIRE(reg::bitIsSet(MockDma{}, board::dma::CR::EN[1_c]));
+        REQUIRE(reg::bitIsSet(MockDma{}, board::dma::CR::TCIE[1_c]));
+        REQUIRE(reg::read(MockDma{}, board::dma::NDTR::NDT[1_c]) == 4);
+        REQUIRE(reg::read(MockDma{}, board::dma::PAR::PA[1_c]) == MockUart{}.getAddress(board::uart::DR::_Offset{}));
+
+        op.stop();
+        REQUIRE(!reg::bitIsSet(MockUart{}, board::uart::CR3::DMAT));
+    }
+
+    SECTION("WriteDma should set the value on transfer complete")
+    {
+        bool valueReceived = false;
+        auto op = async::connect(
+            device.writeDma(dmaStream, data, 4),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveValue([&]() { valueReceived = true; })));
+
+        op.start();
+        dmaInterruptEvent.raise();
+        REQUIRE(!valueReceived);
+
+        setRegisterBit(MockDma{}, board::dma::ISR::TCIF[1_c]);
+        dmaInterruptEvent.raise();
+        REQUIRE(valueReceived);
+        REQUIRE(!reg::bitIsSet(MockUart{}, board::uart::CR3::DMAT));
+    }
+
+    SECTION("WriteDma should report a transfer error")
+    {
+        bool errorReceived = false;
+        auto op = async::connect(
+            device.writeDma(dmaStream, data, 4),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveError([&](uart::UartError error) { errorReceived = (error == uart::UartError::DMA_ERROR); })));
+
+        op.start();
+        setRegisterBit(MockDma{}, board::dma::ISR::TEIF[1_c]);
+        dmaInterruptEvent.raise();
+        REQUIRE(errorReceived);
+        REQUIRE(!reg::bitIsSet(MockUart{}, board::uart::CR3::DMAT));
+    }
+
+    SECTION("WriteDma should fail with BUSY when the stream is in use")
+    {
+        auto op1 = async::connect(
+            device.writeDma(dmaStream, data, 4),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveValue([]() { })));
+
+        bool busy = false;
+        auto op2 = async::connect(
+            device.writeDma(dmaStream, data, 4),
+            async::addSchedulerToReceiver(
+                scheduler,
+                async::receiveError([&](uart::UartError error) { busy = (error == uart::UartError::BUSY); })));
+
+        op1.start();
+        op2.start();
+        REQUIRE(busy);
+        op1.stop();
+    }
+}
+
+namespace
+{
+    // Runs the posted tasks inline, or rejects them like a full queue
+    struct RejectingScheduler
+    {
+        bool post(Delegate<void(void)> action)
+        {
+            return postFromISR(action);
+        }
+
+        bool postFromISR(Delegate<void(void)> action)
+        {
+            if (full)
+            {
+                return false;
+            }
+
+            action();
+            return true;
+        }
+
+        void poll() { }
+
+        bool full = false;
+    };
+
+    struct ChunkReceiver
+    {
+        void setNext(std::span<const std::uint8_t> chunk) &
+        {
+            chunks.emplace_back(chunk.begin(), chunk.end());
+        }
+
+        void setError(drivers::uart::UartError e) &&
+        {
+            error = e;
+        }
+
+        void setDone() &&
+        {
+            done = true;
+        }
+
+        friend RejectingScheduler & tag_invoke(async::getScheduler_t, const ChunkReceiver & self)
+        {
+            return *self.scheduler;
+        }
+
+        RejectingScheduler * scheduler;
+        std::vector<std::vector<std::uint8_t>> & chunks;
+        std::optional<drivers::uart::UartError> & error;
+        bool & done;
+    };
+}
+
+TEST_CASE("Uart continuous DMA read")
+{
+    using namespace drivers;
+    using namespace hana::literals;
+    resetPeripheral(MockUart{});
+    resetPeripheral(MockDma{});
+
+    RejectingScheduler scheduler;
+    uart::Uart<MockUart> device{async::EventEmitter{&interruptEvent}};
+    dma::Dma<MockDma, 1> dmaStream{async::EventEmitter{&dmaInterruptEvent}};
+    std::uint8_t buffer[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+
+    std::vector<std::vector<std::uint8_t>> chunks;
+    std::optional<uart::UartError> error;
+    bool done = false;
+
+    auto op = async::subscribe(
+        device.readContinuous(dmaStream, buffer, 8),
+        ChunkReceiver{&scheduler, chunks, error, done});
+
+    // Simulates the DMA stream having received a total of n bytes into the current lap
+    auto receive = [](std::uint16_t n) {
+        setFieldValue(MockDma{}, board::dma::NDTR::NDT[1_c], static_cast<std::uint32_t>(8U - n));
+    };
+    auto raiseDmaFlag = [](auto flag) {
+        setRegisterBit(MockDma{}, flag);
+        dmaInterruptEvent.raise();
+        clearRegisterBit(MockDma{}, flag);
+    };
+    auto raiseIdle = []() {
+        setRegisterBit(MockUart{}, board::uart::SR::IDLE);
+        interruptEvent.raise();
+        clearRegisterBit(MockUart{}, board::uart::SR::IDLE);
+    };
+
+    SECTION("ReadContinuous should return a stream")
+    {
+        using StreamType = decltype(device.readContinuous(dmaStream, buffer, 8));
+        STATIC_REQUIRE(async::Stream<StreamType, std::span<const std::uint8_t>, uart::UartError>);
+    }
+
+    SECTION("Should start a circular transfer and enable idle line detection")
+    {
+        op.start();
+        REQUIRE(reg::bitIsSet(MockDma{}, board::dma::CR::CIRC[1_c]));
+        REQUIRE(reg::bitIsSet(MockDma{}, board::dma::CR::HTIE[1_c]));
+        REQUIRE(reg::bitIsSet(MockDma{}, board::dma::CR::EN[1_c]));
+        REQUIRE(reg::bitIsSet(MockUart{}, board::uart::CR3::DMAR));
+        REQUIRE(reg::bitIsSet(MockUart{}, board::uart::CR1::IDLEIE));
+        REQUIRE(reg::bitIsSet(MockUart{}, board::uart::CR1::RE));
+        REQUIRE(!reg::bitIsSet(MockUart{}, board::uart::CR1::RXNEIE));
+
+        op.stop();
+        REQUIRE(done);
+        REQUIRE(!reg::bitIsSet(MockUart{}, board::uart::CR3::DMAR));
+        REQUIRE(!reg::bitIsSet(MockUart{}, board::uart::CR1::IDLEIE));
+    }
+
+    SECTION("Should emit the received bytes on half transfer, transfer complete and idle line")
+    {
+        op.start();
+
+        receive(3);
+        raiseIdle();
+        REQUIRE(chunks.size() == 1);
+        REQUIRE(chunks[0] == std::vector<std::uint8_t>{0, 1, 2});
+
+        async::next(op);
+        receive(4);
+        raiseDmaFlag(board::dma::ISR::HTIF[1_c]);
+        REQUIRE(chunks.size() == 2);
+        REQUIRE(chunks[1] == std::vector<std::uint8_t>{3});
+
+        async::next(op);
+        receive(8);
+        raiseDmaFlag(board::dma::ISR::TCIF[1_c]);
+        REQUIRE(chunks.size() == 3);
+        REQUIRE(chunks[2] == std::vector<std::uint8_t>{4, 5, 6, 7});
+
+        // Wrapped around
+        async::next(op);
+        receive(2);
+        raiseIdle();
+        REQUIRE(chunks.size() == 4);
+        REQUIRE(chunks[3] == std::vector<std::uint8_t>{0, 1});
+        REQUIRE(!error);
+
+        op.stop();
+    }
+
+    SECTION("Should hold back data until the next chunk is requested")
+    {
+        op.start();
+
+        receive(2);
+        raiseIdle();
+        receive(4);
+        raiseDmaFlag(board::dma::ISR::HTIF[1_c]);
+        REQUIRE(chunks.size() == 1);
+
+        async::next(op);
+        REQUIRE(chunks.size() == 2);
+        REQUIRE(chunks[1] == std::vector<std::uint8_t>{2, 3});
+
+        op.stop();
+    }
+
+    SECTION("Should split a chunk at the end of the ring buffer")
+    {
+        op.start();
+
+        receive(6);
+        raiseIdle();
+        async::next(op);
+        receive(8);
+        raiseDmaFlag(board::dma::ISR::TCIF[1_c]);
+        receive(2);
+        raiseIdle();
+        REQUIRE(chunks.size() == 2);
+
+        async::next(op);
+        REQUIRE(chunks.size() == 3);
+        REQUIRE(chunks[1] == std::vector<std::uint8_t>{6, 7});
+        REQUIRE(chunks[2] == std::vector<std::uint8_t>{0, 1});
+
+        op.stop();
+    }
+
+    SECTION("Should report an overrun when unreleased data is overwritten")
+    {
+        op.start();
+
+        receive(4);
+        raiseDmaFlag(board::dma::ISR::HTIF[1_c]);
+        receive(8);
+        raiseDmaFlag(board::dma::ISR::TCIF[1_c]);
+        REQUIRE(!error);
+
+        receive(4);
+        raiseDmaFlag(board::dma::ISR::HTIF[1_c]);
+        REQUIRE(error == uart::UartError::OVERRUN);
+        REQUIRE(!reg::bitIsSet(MockUart{}, board::uart::CR3::DMAR));
+        REQUIRE(!reg::bitIsSet(MockDma{}, board::dma::CR::TCIE[1_c]));
+    }
+
+    SECTION("Should report an overrun of the USART")
+    {
+        op.start();
+
+        setRegisterBit(MockUart{}, board::uart::SR::ORE);
+        interruptEvent.raise();
+        REQUIRE(error == uart::UartError::OVERRUN);
+        REQUIRE(!reg::bitIsSet(MockUart{}, board::uart::CR1::IDLEIE));
+    }
+    SECTION("Should emit the received data after the scheduler rejected a post")
+    {
+        op.start();
+
+        scheduler.full = true;
+        receive(3);
+        raiseIdle();
+        REQUIRE(chunks.empty());
+
+        scheduler.full = false;
+        receive(4);
+        raiseDmaFlag(board::dma::ISR::HTIF[1_c]);
+        REQUIRE(chunks.size() == 1);
+        REQUIRE(chunks[0] == std::vector<std::uint8_t>{0, 1, 2, 3});
+
+        op.stop();
+    }
+
+    SECTION("Stopping after a failure should not complete the stream again")
+    {
+        op.start();
+
+        setRegisterBit(MockUart{}, board::uart::SR::ORE);
+        interruptEvent.raise();
+        REQUIRE(error == uart::UartError::OVERRUN);
+
+        op.stop();
+        REQUIRE(!done);
+    }
 }
\ No newline at end of file
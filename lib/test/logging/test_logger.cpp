@@ -0,0 +1,283 @@
+#include "../catch.hpp"
+#include "logging/logger.hpp"
+#include "logging/decoder.hpp"
+#include "async/make_future.hpp"
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Scheduler that runs the posted tasks when polled
+    struct QueueingScheduler
+    {
+        bool post(Delegate<void(void)> task)
+        {
+            if (full)
+            {
+                return false;
+            }
+
+            tasks.push_back(task);
+            return true;
+        }
+
+        bool postFromISR(Delegate<void(void)> task)
+        {
+            return post(task);
+        }
+
+        void poll()
+        {
+            while (!tasks.empty())
+            {
+                auto task = tasks.front();
+                tasks.pop_front();
+                task();
+            }
+        }
+
+        std::deque<Delegate<void(void)>> tasks;
+        bool full = false;
+    };
+
+    // Captures the written bytes, the write is completed by the test
+    struct MockWriter
+    {
+        template<class R>
+        struct Operation
+        {
+            void start()
+            {
+                writer->output.insert(writer->output.end(), data, data + size);
+                ++writer->writes;
+                writer->completeWrite = {memFn<&Operation::complete>, *this};
+            }
+
+            void stop() { }
+
+            void complete()
+            {
+                if (writer->failWrites)
+                {
+                    async::setError(std::move(receiver), 1);
+                }
+                else
+                {
+                    async::setValue(std::move(receiver));
+                }
+            }
+
+            R receiver;
+            MockWriter * writer;
+            const std::uint8_t * data;
+            std::uint16_t size;
+        };
+
+        auto operator()(const std::uint8_t * data, std::uint16_t size)
+        {
+            return async::makeFuture<void, int>(
+                [this, data, size]<class R>(R && receiver) -> Operation<std::remove_cvref_t<R>> {
+                    return {static_cast<R&&>(receiver), this, data, size};
+                });
+        }
+
+        std::vector<std::uint8_t> output;
+        std::uint32_t writes = 0;
+        bool failWrites = false;
+        Delegate<void(void)> completeWrite;
+    };
+
+    enum class State : std::uint8_t
+    {
+        IDLE = 2
+    };
+}
+
+TEST_CASE("Logger")
+{
+    QueueingScheduler scheduler;
+    MockWriter writer;
+    logging::Logger<QueueingScheduler, MockWriter &, 4, 32> logger{scheduler, writer};
+    logging::LogDecoder decoder{
+        "boot",
+        "adc %u, %d",
+        "state %x",
+        "gain %.2f",
+        "percent %u%%"
+    };
+
+    auto decoded = [&]() {
+        std::string text;
+        REQUIRE(decoder.decode(writer.output, text) == writer.output.size());
+        return text;
+    };
+
+    SECTION("Logging should not write until the scheduler runs the write task")
+    {
+        REQUIRE(logger.log<"boot">());
+        REQUIRE(writer.writes == 0);
+        REQUIRE(scheduler.tasks.size() == 1);
+
+        scheduler.poll();
+        REQUIRE(writer.writes == 1);
+        REQUIRE(decoded() == "boot\n");
+    }
+
+    SECTION("Only one write task should be posted for multiple records")
+    {
+        logger.log<"boot">();
+        logger.log<"adc %u, %d">(1023U, -5);
+        logger.log<"state %x">(State::IDLE);
+        REQUIRE(scheduler.tasks.size() == 1);
+
+        scheduler.poll();
+        REQUIRE(writer.writes == 1);
+        REQUIRE(decoded() == "boot\nadc 1023, -5\nstate 2\n");
+    }
+
+    SECTION("Records should be encoded as format id, number of arguments and arguments")
+    {
+        logger.log<"adc %u, %d">(0x01020304U, -1);
+        scheduler.poll();
+
+        constexpr std::uint32_t id = logging::formatId("adc %u, %d");
+        REQUIRE(writer.output == std::vector<std::uint8_t>{
+            id & 0xFF, (id >> 8) & 0xFF, (id >> 16) & 0xFF, id >> 24, 2,
+            0x04, 0x03, 0x02, 0x01,
+            0xFF, 0xFF, 0xFF, 0xFF
+        });
+    }
+
+    SECTION("Floats and escaped percent signs should be decoded")
+    {
+        logger.log<"gain %.2f">(0.5f);
+        logger.log<"percent %u%%">(42U);
+        scheduler.poll();
+        REQUIRE(decoded() == "gain 0.50\npercent 42%\n");
+    }
+
+    SECTION("Records logged during a write should be written when it completes")
+    {
+        logger.log<"boot">();
+        scheduler.poll();
+        logger.log<"state %x">(255U);
+        scheduler.poll();
+        REQUIRE(writer.writes == 1);
+
+        writer.completeWrite();
+        scheduler.poll();
+        REQUIRE(writer.writes == 2);
+        REQUIRE(decoded() == "boot\nstate ff\n");
+    }
+
+    SECTION("Records that do not fit the transmit buffer should be written in the next batch")
+    {
+        // 13 bytes each, two fit into the 32 byte buffer
+        logger.log<"adc %u, %d">(1U, 2);
+        logger.log<"adc %u, %d">(3U, 4);
+        logger.log<"adc %u, %d">(5U, 6);
+        scheduler.poll();
+        REQUIRE(writer.output.size() == 26);
+
+        writer.completeWrite();
+        scheduler.poll();
+        REQUIRE(writer.writes == 2);
+        REQUIRE(decoded() == "adc 1, 2\nadc 3, 4\nadc 5, 6\n");
+    }
+
+    SECTION("Dropped records should be reported")
+    {
+        for (std::uint32_t i = 0; i < 4; ++i)
+        {
+            REQUIRE(logger.log<"state %x">(i));
+        }
+        REQUIRE(!logger.log<"boot">());
+        REQUIRE(!logger.log<"boot">());
+
+        scheduler.poll();
+        writer.completeWrite();
+        scheduler.poll();
+        REQUIRE(decoded() == "<2 log records dropped>\nstate 0\nstate 1\nstate 2\nstate 3\n");
+    }
+
+    SECTION("Failed writes should be counted")
+    {
+        writer.failWrites = true;
+        logger.log<"boot">();
+        scheduler.poll();
+        writer.completeWrite();
+        REQUIRE(logger.getWriteErrors() == 1);
+
+        writer.failWrites = false;
+        logger.log<"boot">();
+        scheduler.poll();
+        REQUIRE(writer.writes == 2);
+    }
+
+    SECTION("Records queued during a failed write should still be written")
+    {
+        writer.failWrites = true;
+        logger.log<"boot">();
+        scheduler.poll();
+        logger.log<"state %x">(255U);
+        scheduler.poll();
+        writer.completeWrite();
+        REQUIRE(logger.getWriteErrors() == 1);
+
+        // Without another record being logged
+        scheduler.poll();
+        REQUIRE(writer.writes == 2);
+    }
+
+    SECTION("A write rejected by a full scheduler should be posted by the next record")
+    {
+        scheduler.full = true;
+        REQUIRE(logger.log<"boot">());
+        REQUIRE(scheduler.tasks.empty());
+
+        scheduler.full = false;
+        logger.log<"state %x">(255U);
+        scheduler.poll();
+        REQUIRE(writer.writes == 1);
+        REQUIRE(decoded() == "boot\nstate ff\n");
+    }
+
+    SECTION("The decoder should not consume incomplete records")
+    {
+        logger.log<"adc %u, %d">(1U, 2);
+        scheduler.poll();
+
+        std::string text;
+        auto partial = std::span<const std::uint8_t>(writer.output).first(writer.output.size() - 1);
+        REQUIRE(decoder.decode(partial, text) == 0);
+        REQUIRE(text.empty());
+    }
+
+    SECTION("The decoder should skip records with unknown format strings")
+    {
+        logging::LogDecoder otherDecoder{"boot"};
+        logger.log<"adc %u, %d">(1U, 2);
+        logger.log<"boot">();
+        scheduler.poll();
+
+        std::string text;
+        REQUIRE(otherDecoder.decode(writer.output, text) == writer.output.size());
+        REQUIRE(text.starts_with("<unknown format 0x"));
+        REQUIRE(text.ends_with(">\nboot\n"));
+    }
+}
+
+TEST_CASE("Log format strings")
+{
+    using logging::detail::countArguments;
+    STATIC_REQUIRE(countArguments("no arguments") == 0);
+    STATIC_REQUIRE(countArguments("%u %d %i %x %X %o %c %f") == 8);
+    STATIC_REQUIRE(countArguments("%-08.3f %+d %#x") == 3);
+    STATIC_REQUIRE(countArguments("100%%") == 0);
+    STATIC_REQUIRE(countArguments("%s") == -1);
+    STATIC_REQUIRE(countArguments("%lu") == -1);
+    STATIC_REQUIRE(countArguments("trailing %") == -1);
+    STATIC_REQUIRE(logging::formatId("a") != logging::formatId("b"));
+}
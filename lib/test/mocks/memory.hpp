@@ -31,6 +31,13 @@ struct MockDeviceMemory
             reinterpret_cast<std::uint8_t *>(data.data()) + offset);
     }
 
+    // Truncated to 32 bits, like the addresses handed to the (mock) DMA
+    template<std::uint32_t offset>
+    static std::uint32_t getAddress()
+    {
+        return static_cast<std::uint32_t>(reinterpret_cast<std::uintptr_t>(getPtr<offset>()));
+    }
+
     template<std::uint32_t offset>
     static std::uint32_t & getRef()
     {
@@ -1,5 +1,8 @@
 #pragma once
 #include "async/just.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
 
 struct MockI2c
 {
@@ -13,18 +16,23 @@ struct MockI2c
     {
         writeSlaveAddress = slaveAddress;
         bytesWritten.insert(bytesWritten.end(), bytesToWrite, bytesToWrite+size);
+        writes.emplace_back(bytesToWrite, bytesToWrite+size);
         return async::just();
     }
 
-    auto writeAndRead(std::uint8_t slaveAddress, const std::uint8_t *, std::uint16_t, std::uint8_t *, std::uint16_t)
+    auto writeAndRead(std::uint8_t slaveAddress, const std::uint8_t *, std::uint16_t, std::uint8_t * buffer, std::uint16_t size)
     {
         readSlaveAddress = slaveAddress;
         writeSlaveAddress = slaveAddress;
+        ++writeAndReadCount;
+        std::copy_n(readBuffer.begin(), std::min<std::size_t>(size, readBuffer.size()), buffer);
         return async::just();
     }
 
     std::uint8_t readSlaveAddress = 0x00;
     std::uint8_t writeSlaveAddress = 0x00;
     std::vector<std::uint8_t> bytesWritten = {};
+    std::vector<std::vector<std::uint8_t>> writes = {};
     std::vector<std::uint8_t> readBuffer = {};
-};
\ No newline at end of file
+    int writeAndReadCount = 0;
+};
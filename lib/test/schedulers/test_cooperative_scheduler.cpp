@@ -1,11 +1,40 @@
 #include "../catch.hpp"
 #include "async/scheduler.hpp"
 #include "schedulers/cooperative_scheduler.hpp"
+#include "schedulers/timer_wheel.hpp"
 #include "../mocks/mock_board.hpp"
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
 
 namespace {
     async::Event interruptEvent;
 
+    struct MockTickSource
+    {
+        static constexpr std::uint32_t maxSuspendTicks = 1000;
+
+        void suspendFor(std::uint32_t ticks) 
+        { 
+            suspendedFor.push_back(ticks); 
+        }
+
+        std::uint32_t resume() 
+        { 
+            return elapsedTicks; 
+        }
+
+        std::vector<std::uint32_t> suspendedFor;
+        std::uint32_t elapsedTicks = 0;
+    };
+
+    struct MockCycleCounter
+    {
+        static std::uint32_t now() { return cycles; }
+        static inline std::uint32_t cycles = 0;
+    };
+
     struct Peripherals
     {
         async::EventEmitter getInterruptEvent(decltype(board::Interrupts::SysTick)) { return {&interruptEvent}; }
@@ -51,4 +80,361 @@ TEST_CASE("Cooperative scheduler")
         scheduler.poll();
         REQUIRE(wasCalled == true);
     }
-}
\ No newline at end of file
+
+    SECTION("Should be able to run delayed jobs with the timer wheel backend")
+    {
+        auto scheduler = makeCooperativeScheduler<16, 4, TimerWheel>(mockBoard);
+        int callCount = 0;
+        auto act = [&]() -> int { ++callCount; return callCount < 2 ? 2 : -1; };
+
+        scheduler.postAfter(1, {&act});
+
+        scheduler.poll();
+        REQUIRE(callCount == 0);
+
+        interruptEvent.raise();
+        scheduler.poll();
+        REQUIRE(callCount == 1);
+
+        // Rescheduled 2 ms later
+        interruptEvent.raise();
+        scheduler.poll();
+        REQUIRE(callCount == 1);
+
+        interruptEvent.raise();
+        scheduler.poll();
+        REQUIRE(callCount == 2);
+    }
+
+    SECTION("Should run all jobs posted from concurrent interrupts")
+    {
+        // Threads stand in for nested interrupt handlers
+        auto scheduler = makeCooperativeScheduler<32, 1>(mockBoard);
+        constexpr int postsPerThread = 10'000;
+        std::atomic<int> callCount = 0;
+        auto act = [&]() { ++callCount; };
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 3; ++t)
+        {
+            threads.emplace_back([&]() {
+                for (int i = 0; i < postsPerThread; ++i)
+                {
+                    while (!scheduler.postFromISR({&act}))
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        while (callCount < 3 * postsPerThread)
+        {
+            scheduler.poll();
+        }
+
+        for (auto & thread : threads)
+        {
+            thread.join();
+        }
+
+        REQUIRE(callCount == 3 * postsPerThread);
+    }
+
+    SECTION("Should drain a burst of jobs with a single batch poll")
+    {
+        auto scheduler = makeCooperativeScheduler<16, 1>(mockBoard);
+        int callCount = 0;
+        auto act = [&]() { ++callCount; };
+
+        for (int i = 0; i < 10; ++i)
+        {
+            scheduler.postFromISR({&act});
+        }
+
+        REQUIRE(scheduler.pollBatch(4) == 4);
+        REQUIRE(callCount == 4);
+        REQUIRE(scheduler.pollBatch(16) == 6);
+        REQUIRE(callCount == 10);
+        REQUIRE(scheduler.pollBatch(16) == 0);
+
+        auto & statistics = scheduler.getStatistics();
+        REQUIRE(statistics.polls == 3);
+        REQUIRE(statistics.idlePolls == 1);
+        REQUIRE(statistics.tasksRun == 10);
+        REQUIRE(statistics.maxTasksPerPoll == 6);
+    }
+
+    SECTION("Should run jobs posted while running until idle")
+    {
+        auto scheduler = makeCooperativeScheduler<4, 1>(mockBoard);
+        int callCount = 0;
+        std::function<void()> act;
+        act = [&]() { 
+            if (++callCount < 20) 
+            {
+                scheduler.post({&act});
+            }
+        };
+
+        scheduler.post({&act});
+
+        REQUIRE(scheduler.runUntilIdle() == 20);
+        REQUIRE(callCount == 20);
+    }
+
+    SECTION("Should check the timers during a batch when requested")
+    {
+        auto scheduler = makeCooperativeScheduler<16, 1>(mockBoard);
+        std::vector<int> order;
+        int taskIndex = 0;
+        auto task = [&]() { 
+            order.push_back(taskIndex++); 
+            if (taskIndex == 2)
+            {
+                interruptEvent.raise(); // Tick
+            }
+        };
+        auto timer = [&]() -> int { order.push_back(-1); return -1; };
+
+        scheduler.postAfter(1, {&timer});
+        for (int i = 0; i < 6; ++i)
+        {
+            scheduler.post({&task});
+        }
+
+        scheduler.pollBatch(6, 3);
+
+        REQUIRE(order == std::vector<int>{0, 1, 2, -1, 3, 4, 5});
+    }
+
+    SECTION("Should fullfill the priority scheduler concept when it has priority lanes")
+    {
+        using InterruptController = typename decltype(mockBoard)::InterruptController;
+        STATIC_REQUIRE(async::PriorityScheduler<
+            CooperativeScheduler<1, 1, InterruptController, 1U, ArrayTimerQueue, 2>>);
+    }
+
+    SECTION("Should run high priority jobs first")
+    {
+        auto scheduler = makeCooperativeScheduler<16, 1, ArrayTimerQueue, 3>(mockBoard);
+        std::vector<int> order;
+        auto low = [&]() { order.push_back(2); };
+        auto normal = [&]() { order.push_back(1); };
+        auto high = [&]() { order.push_back(0); };
+
+        scheduler.post({&low});
+        scheduler.post({&normal}, 1);
+        scheduler.postFromISR({&high}, async::highestPriority);
+        // Out of range priorities end up in the lowest priority lane
+        scheduler.post({&low}, 10);
+
+        REQUIRE(scheduler.runUntilIdle() == 4);
+        REQUIRE(order == std::vector<int>{0, 1, 2, 2});
+    }
+
+    SECTION("Should bound the latency of high priority jobs under a flood of low priority jobs")
+    {
+        auto scheduler = makeCooperativeScheduler<64, 1, ArrayTimerQueue, 2>(mockBoard);
+        constexpr int floodSize = 64;
+        int tasksRun = 0;
+        int postedAt = -1;
+        int highPosts = 0;
+        std::vector<int> latencies;
+
+        auto high = [&]() { 
+            latencies.push_back(tasksRun - postedAt); 
+            ++tasksRun;
+        };
+        auto low = [&]() {
+            // Every 10th low priority job is interrupted by a high priority post
+            if (tasksRun % 10 == 0)
+            {
+                postedAt = tasksRun;
+                ++highPosts;
+                async::postFromISRWithPriority(scheduler, {&high}, async::highestPriority);
+            }
+            ++tasksRun;
+        };
+
+        for (int i = 0; i < floodSize; ++i)
+        {
+            REQUIRE(scheduler.postFromISR({&low}));
+        }
+        REQUIRE(!scheduler.postFromISR({&low}));
+
+        scheduler.runUntilIdle();
+
+        // The high priority job only waits for the low priority job it preempted
+        REQUIRE(highPosts > 1);
+        REQUIRE(latencies.size() == static_cast<std::size_t>(highPosts));
+        for (int latency : latencies)
+        {
+            REQUIRE(latency == 1);
+        }
+    }
+
+    SECTION("Should ignore the priority on schedulers without priority lanes")
+    {
+        auto scheduler = makeCooperativeScheduler(mockBoard);
+        bool wasCalled = false;
+        auto act = [&]() { wasCalled = true; };
+
+        STATIC_REQUIRE(!async::PriorityScheduler<decltype(scheduler)>);
+        REQUIRE(async::postFromISRWithPriority(scheduler, {&act}, async::highestPriority));
+        scheduler.poll();
+
+        REQUIRE(wasCalled);
+    }
+
+    SECTION("Should suspend the tick until the next timer deadline when idle")
+    {
+        auto scheduler = makeCooperativeScheduler<16, 2, TimerWheel>(mockBoard);
+        MockTickSource tickSource;
+        int callCount = 0;
+        auto act = [&]() -> int { ++callCount; return -1; };
+
+        scheduler.postAfter(40, {&act});
+        scheduler.poll();
+
+        // Sleep until the tick interrupt that ends the suspension
+        int sleepCount = 0;
+        scheduler.idle(tickSource, [&]() {
+            ++sleepCount;
+            tickSource.elapsedTicks = tickSource.suspendedFor.back() - 1;
+            interruptEvent.raise();
+        });
+
+        REQUIRE(sleepCount == 1);
+        REQUIRE(tickSource.suspendedFor == std::vector<std::uint32_t>{40});
+
+        scheduler.poll();
+        REQUIRE(callCount == 1);
+    }
+
+    SECTION("Should compensate the tick count when woken up early")
+    {
+        auto scheduler = makeCooperativeScheduler<16, 2>(mockBoard);
+        MockTickSource tickSource;
+        int callCount = 0;
+        auto timer = [&]() -> int { ++callCount; return -1; };
+        bool taskWasRun = false;
+        auto task = [&]() { taskWasRun = true; };
+
+        scheduler.postAfter(100, {&timer});
+        scheduler.poll();
+
+        // Another interrupt posts a task after 30 ticks
+        scheduler.idle(tickSource, [&]() {
+            tickSource.elapsedTicks = 30;
+            scheduler.postFromISR({&task});
+        });
+        scheduler.poll();
+        REQUIRE(taskWasRun);
+        REQUIRE(callCount == 0);
+
+        // Should only sleep for the remaining ticks
+        scheduler.idle(tickSource, [&]() {
+            tickSource.elapsedTicks = 69;
+            interruptEvent.raise();
+        });
+        scheduler.poll();
+        REQUIRE(callCount == 1);
+        REQUIRE(tickSource.suspendedFor == std::vector<std::uint32_t>{100, 70});
+    }
+
+    SECTION("Should not sleep when there are queued tasks or due timers")
+    {
+        auto scheduler = makeCooperativeScheduler<16, 2>(mockBoard);
+        MockTickSource tickSource;
+        int sleepCount = 0;
+        auto sleep = [&]() { ++sleepCount; };
+        auto task = [&]() { };
+        auto timer = [&]() -> int { return -1; };
+
+        scheduler.post({&task});
+        scheduler.idle(tickSource, sleep);
+        REQUIRE(sleepCount == 0);
+        scheduler.poll();
+
+        scheduler.postAfter(0, {&timer});
+        scheduler.idle(tickSource, sleep);
+        REQUIRE(sleepCount == 0);
+        REQUIRE(tickSource.suspendedFor.empty());
+    }
+
+    SECTION("Should suspend the tick for as long as possible without timers")
+    {
+        auto scheduler = makeCooperativeScheduler(mockBoard);
+        MockTickSource tickSource;
+
+        scheduler.idle(tickSource, []() { });
+
+        REQUIRE(tickSource.suspendedFor == std::vector<std::uint32_t>{MockTickSource::maxSuspendTicks});
+    }
+
+    SECTION("Should record load, latencies and timer lateness when instrumented")
+    {
+        using Instrumentation = SchedulerInstrumentation<MockCycleCounter, 8>;
+        MockCycleCounter::cycles = 0;
+        auto scheduler = makeCooperativeScheduler<16, 1, ArrayTimerQueue, 1, Instrumentation>(mockBoard);
+        auto task = [&]() { MockCycleCounter::cycles += 10; };
+        auto timer = [&]() -> int { return -1; };
+
+        MockCycleCounter::cycles = 100;
+        for (int i = 0; i < 3; ++i)
+        {
+            scheduler.postFromISR({&task});
+        }
+
+        MockCycleCounter::cycles = 150;
+        scheduler.runUntilIdle();
+
+        // Timer is run 2 ticks late
+        scheduler.postAfter(1, {&timer});
+        for (int i = 0; i < 3; ++i)
+        {
+            interruptEvent.raise();
+        }
+        MockCycleCounter::cycles = 200;
+        scheduler.poll();
+
+        auto snapshot = scheduler.getInstrumentation().snapshot();
+        REQUIRE(snapshot.busyCycles == 30);
+        REQUIRE(snapshot.idleCycles == 170);
+        REQUIRE(snapshot.queueHighWaterMark == 3);
+        REQUIRE(snapshot.maxLatency == 70);
+        // Latencies of 50, 60 and 70 cycles
+        REQUIRE(snapshot.latencyHistogram == std::array<std::uint32_t, 8>{0, 0, 0, 0, 0, 0, 2, 1});
+        REQUIRE(snapshot.lateTimers == 1);
+        REQUIRE(snapshot.maxTimerLateness == 2);
+
+        scheduler.resetInstrumentation();
+        REQUIRE(scheduler.getInstrumentation().snapshot().busyCycles == 0);
+    }
+
+    SECTION("Should sum the load beyond the range of the cycle counter")
+    {
+        MockCycleCounter::cycles = 0;
+        SchedulerInstrumentation<MockCycleCounter, 8> instrumentation;
+
+        // Each poll follows 3/4 of a counter period without work
+        for (int i = 0; i < 4; ++i)
+        {
+            MockCycleCounter::cycles += 0xC0000000U;
+            instrumentation.pollStarted(0);
+            instrumentation.pollEnded(false);
+        }
+
+        REQUIRE(instrumentation.snapshot().idleCycles == 4 * 0xC0000000ULL);
+    }
+
+    SECTION("Should not store timestamps when not instrumented")
+    {
+        using InterruptController = typename decltype(mockBoard)::InterruptController;
+        STATIC_REQUIRE(
+            sizeof(CooperativeScheduler<16, 1, InterruptController>) <
+            sizeof(CooperativeScheduler<16, 1, InterruptController, 1U, ArrayTimerQueue, 1, 
+                SchedulerInstrumentation<MockCycleCounter>>));
+    }
+}
@@ -0,0 +1,150 @@
+#include "../catch.hpp"
+#include "schedulers/timer_wheel.hpp"
+#include "schedulers/array_timer_queue.hpp"
+#include <vector>
+
+namespace
+{
+    struct RecordingTimer
+    {
+        int operator()()
+        {
+            firedAt.push_back(*currentTick);
+            return firedAt.size() < repetitions ? period : -1;
+        }
+
+        const std::uint32_t * currentTick;
+        std::uint32_t repetitions = 1;
+        int period = 0;
+        std::vector<std::uint32_t> firedAt = {};
+    };
+}
+
+TEMPLATE_TEST_CASE("Timer queues", "", schedulers::TimerWheel<8>, schedulers::ArrayTimerQueue<8>)
+{
+    TestType timers;
+    std::uint32_t tick = 0;
+
+    auto runUntil = [&](std::uint32_t endTick) {
+        while (tick != endTick)
+        {
+            timers.runDue(tick, 1);
+            ++tick;
+        }
+        timers.runDue(tick, 1);
+    };
+
+    SECTION("Should not fire before the deadline")
+    {
+        RecordingTimer timer{&tick};
+        REQUIRE(timers.insert(10, {&timer}));
+
+        runUntil(9);
+        REQUIRE(timer.firedAt.empty());
+
+        runUntil(10);
+        REQUIRE(timer.firedAt == std::vector<std::uint32_t>{10});
+    }
+
+    SECTION("Should fire due timers when the poll is late")
+    {
+        RecordingTimer timer{&tick};
+        REQUIRE(timers.insert(10, {&timer}));
+
+        tick = 1000;
+        timers.runDue(tick, 1);
+        REQUIRE(timer.firedAt == std::vector<std::uint32_t>{1000});
+    }
+
+    SECTION("Should fire timers far into the future")
+    {
+        RecordingTimer timer1{&tick};
+        RecordingTimer timer2{&tick};
+        RecordingTimer timer3{&tick};
+        REQUIRE(timers.insert(63, {&timer1}));
+        REQUIRE(timers.insert(4097, {&timer2}));
+        REQUIRE(timers.insert(300'000, {&timer3}));
+
+        runUntil(300'000);
+
+        REQUIRE(timer1.firedAt == std::vector<std::uint32_t>{63});
+        REQUIRE(timer2.firedAt == std::vector<std::uint32_t>{4097});
+        REQUIRE(timer3.firedAt == std::vector<std::uint32_t>{300'000});
+    }
+
+    SECTION("Should reschedule periodic timers")
+    {
+        RecordingTimer timer{&tick, 3, 100};
+        REQUIRE(timers.insert(5, {&timer}));
+
+        runUntil(1000);
+
+        REQUIRE(timer.firedAt == std::vector<std::uint32_t>{5, 105, 205});
+    }
+
+    SECTION("Should handle tick counter wraparound")
+    {
+        tick = 0xFFFF'FF00U;
+        timers.runDue(tick, 1);
+
+        RecordingTimer timer1{&tick};
+        RecordingTimer timer2{&tick};
+        REQUIRE(timers.insert(0xFFFF'FFF0U, {&timer1}));
+        REQUIRE(timers.insert(0x0000'0100U, {&timer2}));
+
+        runUntil(0x0000'0000U);
+        REQUIRE(timer1.firedAt == std::vector<std::uint32_t>{0xFFFF'FFF0U});
+        REQUIRE(timer2.firedAt.empty());
+
+        runUntil(0x0000'0200U);
+        REQUIRE(timer2.firedAt == std::vector<std::uint32_t>{0x0000'0100U});
+    }
+
+    SECTION("Should fail when all timers are in use")
+    {
+        std::vector<RecordingTimer> recorders(9, RecordingTimer{&tick});
+        for (std::size_t i = 0; i < 8; ++i)
+        {
+            REQUIRE(timers.insert(10, {&recorders[i]}));
+        }
+        REQUIRE(!timers.insert(10, {&recorders[8]}));
+
+        // Expired timers should be released
+        runUntil(10);
+        REQUIRE(timers.insert(20, {&recorders[8]}));
+    }
+
+    SECTION("Should allow timers to be inserted from a timer callback")
+    {
+        RecordingTimer inner{&tick};
+        auto outer = [&]() -> int {
+            timers.insert(tick + 10, {&inner});
+            return -1;
+        };
+        REQUIRE(timers.insert(5, {&outer}));
+
+        runUntil(100);
+        REQUIRE(inner.firedAt == std::vector<std::uint32_t>{15});
+    }
+
+    SECTION("Should report the ticks until the next deadline")
+    {
+        REQUIRE(timers.ticksUntilNextDeadline(tick, 500) == 500);
+
+        RecordingTimer timer1{&tick};
+        RecordingTimer timer2{&tick};
+        REQUIRE(timers.insert(20, {&timer1}));
+        REQUIRE(timers.insert(10'000, {&timer2}));
+        REQUIRE(timers.ticksUntilNextDeadline(tick, 500) == 20);
+
+        runUntil(20);
+        std::uint32_t ticks = timers.ticksUntilNextDeadline(tick, 20'000);
+        // May be earlier than the deadline, but never later
+        REQUIRE(ticks > 0);
+        REQUIRE(ticks <= 10'000 - 20);
+        REQUIRE(timers.ticksUntilNextDeadline(10'000, 500) == 0);
+
+        runUntil(tick + ticks);
+        REQUIRE(timer2.firedAt.empty() == (tick != 10'000));
+    }
+}
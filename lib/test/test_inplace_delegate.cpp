@@ -0,0 +1,100 @@
+#include "catch.hpp"
+#include "inplace_delegate.hpp"
+#include <cstdint>
+
+namespace
+{
+    int freeFunction(char, int b)
+    {
+        return b;
+    }
+
+    struct Counter
+    {
+        void increment() { ++count; }
+        int get() const { return count; }
+
+        int count = 0;
+    };
+}
+
+TEST_CASE("InplaceDelegate")
+{
+    SECTION("Bool conversion operator should return false for a default constructed delegate")
+    {
+        InplaceDelegate<void()> d;
+        REQUIRE(!bool(d));
+    }
+
+    SECTION("Should be trivially copyable")
+    {
+        STATIC_REQUIRE(std::is_trivially_copyable_v<InplaceDelegate<void(), 32>>);
+    }
+
+    SECTION("Free function")
+    {
+        InplaceDelegate d{fn<&freeFunction>};
+
+        REQUIRE(d('a', 10) == 10);
+    }
+
+    SECTION("Member function pointers")
+    {
+        Counter counter;
+        InplaceDelegate increment{memFn<&Counter::increment>, counter};
+        InplaceDelegate get{memFn<&Counter::get>, counter};
+
+        increment();
+        increment();
+
+        REQUIRE(get() == 2);
+    }
+
+    SECTION("Should store lambdas with captures in place")
+    {
+        std::uint32_t a = 1, b = 2, c = 3;
+        InplaceDelegate<std::uint32_t(std::uint32_t), 16> d;
+        {
+            // The lambda goes out of scope before the delegate is called
+            auto f = [a, b, c](std::uint32_t x) { return a + b + c + x; };
+            d = f;
+        }
+
+        REQUIRE(d(4) == 10);
+    }
+
+    SECTION("Should keep the captured state of a mutable lambda between calls")
+    {
+        InplaceDelegate<int()> d{[count = 0]() mutable { return ++count; }};
+
+        d();
+        REQUIRE(d() == 2);
+
+        // Copies have their own state
+        auto d2 = d;
+        REQUIRE(d2() == 3);
+        REQUIRE(d() == 3);
+    }
+
+    SECTION("Should call function objects through pointers")
+    {
+        int count = 0;
+        auto f = [&count]() { ++count; };
+        InplaceDelegate<void()> d{&f};
+
+        d();
+
+        REQUIRE(count == 1);
+    }
+
+    SECTION("Should store a Delegate in place")
+    {
+        Counter counter;
+        Delegate<void()> inner{memFn<&Counter::increment>, counter};
+        InplaceDelegate<void()> d{inner};
+
+        d();
+
+        REQUIRE(counter.count == 1);
+    }
+}
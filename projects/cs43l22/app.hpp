@@ -28,7 +28,7 @@ public:
     async::Future<void, void> auto run()
     {
         return async::whenAll(
-            dacI2S.writeContinuous(i2sDma, audioBuffers_, 2*bufferSize, [this](std::uint16_t * buffer) {
+            dacI2S.writeContinuous(i2sDma, audioBuffers_, 2*bufferSize, [this](std::uint16_t * buffer, std::uint32_t) {
                 fillBuffer(buffer);
             }),
 
@@ -138,7 +138,7 @@ int main()
 
     status = async::executeSync(scheduler, 
         async::whenAll(
-            dacI2S.writeContinuous(i2sDma, audioBuffers, 2*BUFFER_SIZE, [&app](std::uint16_t * buffer) 
+            dacI2S.writeContinuous(i2sDma, audioBuffers, 2*BUFFER_SIZE, [&app](std::uint16_t * buffer, std::uint32_t) 
             {
                 app.fillBuffer(buffer);
             }),
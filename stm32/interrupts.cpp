@@ -1,8 +1,14 @@
 #include <types.hpp>
 #include <async/event.hpp>
 #include <board/interrupts.hpp>
+#include <board/static_interrupts.hpp>
 #include <array>
 
+// Statically bound interrupt handlers of the application, see board/static_interrupts.hpp
+#if __has_include(<interrupt_bindings.hpp>)
+#include <interrupt_bindings.hpp>
+#endif
+
 std::array<async::Event, 128> events = {};
 
 async::EventEmitter board::detail::getInterruptEvent(int irqNo)
@@ -13,12 +19,17 @@ async::EventEmitter board::detail::getInterruptEvent(int irqNo)
 extern "C" void Default_Handler(void);
 
 #define MAKE_IRQ_HANDLER(NAME) \
+    [[maybe_unused]] static const bool NAME##_isStaticallyBound = \
+        board::reserveStaticallyBoundEvent(board::Interrupts::NAME, events[hana::value(board::Interrupts::NAME)+1]); \
     extern "C" void NAME##_IRQHandler(void) \
-    { events[hana::value(board::Interrupts::NAME)+1].raise(); }
+    { board::dispatchInterrupt(board::Interrupts::NAME, events[hana::value(board::Interrupts::NAME)+1]); }
+
+[[maybe_unused]] static const bool SysTick_isStaticallyBound = 
+    board::reserveStaticallyBoundEvent(board::Interrupts::SysTick, events[0]);
 
 extern "C" void SysTick_Handler()
 {
-    events[0].raise();
+    board::dispatchInterrupt(board::Interrupts::SysTick, events[0]);
 }
 
 MAKE_IRQ_HANDLER(WWDG);